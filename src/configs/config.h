@@ -6,6 +6,12 @@
 
 #define IMG_MAX_SIZE 384
 
+// Inference backend of the perception models:
+// kInferenceBackendAuto (TensorRT, CPU if no GPU or the engine fails),
+// kInferenceBackendTensorRT or kInferenceBackendCPU.
+// Can be changed with --inference_backend
+#define INFERENCE_BACKEND kInferenceBackendAuto
+
 // #define DISABLE_LANE_DETECTOR
 #define DISABLE_GPS_READER
 
@@ -30,6 +36,37 @@
 #define MIN_SPEED_FOR_LANE_DEPARTURE_WARNING 20
 #define LANE_DEPARTURE_WARNING_INTERVAL 1 * 1000
 
+// Max time (ms) the warning monitor sleeps when no new frame arrives
+#define WARNING_MONITOR_MAX_INTERVAL 100
+// Max time (ms) the video grabber waits for a new frame before
+// processing UI events
+#define VIDEO_GRABBER_MAX_FRAME_WAIT 15
+// Max time (ms) headless processing threads wait for a new frame
+// before checking whether the runner is stopped
+#define HEADLESS_MAX_FRAME_WAIT 100
+// Max time (ms) a lockstep replay waits for processing threads
+// before checking whether it was stopped
+#define LOCKSTEP_REPLAY_MAX_WAIT 100
+
+// Object detection pipeline (see pipeline/object_detection_pipeline.h).
+// Queue policies: kQueueLatestWins, kQueueDropOldest, kQueueBlock.
+// Only the freshest frame is preprocessed; frames which went through
+// the network are never dropped
+#define OD_PIPELINE_PREPROCESS_WORKERS 1
+#define OD_PIPELINE_PREPROCESS_QUEUE_SIZE 1
+#define OD_PIPELINE_PREPROCESS_QUEUE_POLICY kQueueLatestWins
+#define OD_PIPELINE_DETECTION_QUEUE_SIZE 1
+#define OD_PIPELINE_DETECTION_QUEUE_POLICY kQueueLatestWins
+#define OD_PIPELINE_POSTPROCESS_QUEUE_SIZE 2
+#define OD_PIPELINE_POSTPROCESS_QUEUE_POLICY kQueueBlock
+// Max time (ms) the capture stage waits for a new frame
+// before checking whether the pipeline is stopped
+#define OD_PIPELINE_MAX_FRAME_WAIT 100
+
+// Number of latest frames whose resized images and network inputs
+// are kept by the preprocessing cache (see sensors/preprocess_cache.h)
+#define PREPROCESS_CACHE_MAX_FRAMES 4
+
 #define SMARTCAM_SIMULATION_LIST "data/sim_list.txt"
 #define SMARTCAM_CAMERA_CALIB_FILE "data/camera_calib.txt"
 
@@ -8,10 +8,40 @@
     "models/lane_detection/lane_segmentation_384x384.uff"
 #define LANE_DETECTION_TENSORRT_PLAN \
     "models/lane_detection/lane_segmentation_384x384.engine"
+// Model for CPU inference (OpenCV DNN): frozen TensorFlow graph.
+// Exported by tools/export_cpu_models.py
+#define LANE_DETECTION_CPU_MODEL \
+    "models/lane_detection/lane_segmentation_384x384.pb"
 #define LANE_DETECTION_USE_FP_16 true
 #define LANE_DETECTION_INPUT_WIDTH 384
 #define LANE_DETECTION_INPUT_HEIGHT 384
 #define LANE_DETECTION_INPUT_NODE "data"
 #define LANE_DETECTION_OUTPUT_NODE "sigmoid/Sigmoid"
+// Lane probability above which a pixel of the output is a lane
+#define LANE_DETECTION_MASK_THRESHOLD 0.5f
+
+// Lane tracking: once the lines of the ego lane are locked, lines are only
+// searched around them, and lane departure is decided on tracked lines
+#define LANE_DETECTION_USE_TRACKER true
+// Row of the frame (fraction of its height) where lines are described
+// with the bottom row
+#define LANE_TRACKER_TOP_ROW 0.6f
+// Half width of the band around a tracked line where lines are searched
+// and associated (fraction of the width of the frame)
+#define LANE_TRACKER_SEARCH_BAND 0.06f
+// Frames with a detection before a line is locked
+#define LANE_TRACKER_MIN_HITS 3
+// Frames without detection before a line is lost
+#define LANE_TRACKER_MAX_MISSES 5
+// Time without update (ms) after which lines are lost
+#define LANE_TRACKER_MAX_GAP 1000
+// Noise of the Kalman filter: measured x (px), initial velocity (px/s)
+// and acceleration (px/s^2)
+#define LANE_TRACKER_MEASUREMENT_NOISE 8.0f
+#define LANE_TRACKER_INITIAL_VELOCITY_NOISE 200.0f
+#define LANE_TRACKER_ACCELERATION_NOISE 400.0f
+// Frames between two checks of the whole mask for clutter (crosswalks,
+// stop lines, many lines) while lines are only searched in the bands
+#define LANE_TRACKER_SCENE_CHECK_INTERVAL 3
 
 #endif // CONFIG_LANE_DETECTION_H
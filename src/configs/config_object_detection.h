@@ -5,10 +5,25 @@
     "models/object_detection/ctdet_bdd_resnet18_384.onnx"
 #define SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN \
     "models/object_detection/ctdet_bdd_resnet18_384.engine"
+// Model for CPU inference (OpenCV DNN). It must not use the DCNv2
+// TensorRT plugin. Exported by tools/export_cpu_models.py
+#define SMARTCAM_OBJECT_DETECTION_CPU_MODEL \
+    "models/object_detection/ctdet_bdd_resnet18_384_cpu.onnx"
+// Output names of the CPU model, in the order of the decoder: heatmap
+// (hm), offset (reg), size (wh). The order of unconnected outputs of a
+// graph is not guaranteed, so they are fetched by name
+#define SMARTCAM_OBJECT_DETECTION_CPU_OUTPUTS {"hm", "reg", "wh"}
 // Mode: FLOAT32, FLOAT16. INT in the future
 #define SMARTCAM_OBJECT_DETECTION_MODE "FLOAT16"
 #define MIN_OBJECT_SIZE 10
 
+// Object tracker: min IoU between a predicted track box and a detection
+// to associate them, number of frames a track is kept without detection,
+// and weight of the last measured velocity in the velocity estimate
+#define OBJECT_TRACKER_IOU_THRESHOLD 0.3
+#define OBJECT_TRACKER_MAX_MISSES 5
+#define OBJECT_TRACKER_VELOCITY_SMOOTHING 0.5
+
 #include <vector>
 
 namespace ctdet {
@@ -20,6 +35,9 @@ namespace ctdet {
     constexpr static int input_h = 384;
     constexpr static int channel = 3;
     constexpr static int classNum = 10;
+    // Max number of detections per frame. Sizes the detection output
+    // buffers of both the GPU and the CPU decoders
+    constexpr static int maxDetections = 512;
     constexpr static float mean[]= {0.408, 0.447, 0.470};
     constexpr static float std[] = {0.289, 0.274, 0.278};
     static std::vector<std::string> className = {"person", "rider", "car", "bus", "truck", "bike", "motor", "traffic_light", "traffic_sign", "train"};
@@ -4,12 +4,19 @@
 #define DEBUG_WRITE_SIGN_CROPS false
 
 #define SIGN_CLASSIFICATION_BATCH_SIZE 4
+// Maximum time (ms) a crop waits for other crops (of the next frames or
+// other cameras) to fill a batch
+#define SIGN_CLASSIFICATION_MAX_BATCH_DELAY 30
 #define SIGN_CLASSIFICATION_N_CLASSES 15
 #define SIGN_CLASSIFICATION_FORCE_REBUILD_ENGINE false
 #define SIGN_CLASSIFICATION_MODEL \
     "models/traffic_sign/traffic_sign_classification_resnet18_64.uff"
 #define SIGN_CLASSIFICATION_TENSORRT_PLAN \
     "models/traffic_sign/traffic_sign_classification_resnet18_64.engine"
+// Model for CPU inference (OpenCV DNN): frozen TensorFlow graph.
+// Exported by tools/export_cpu_models.py
+#define SIGN_CLASSIFICATION_CPU_MODEL \
+    "models/traffic_sign/traffic_sign_classification_resnet18_64.pb"
 #define SIGN_CLASSIFICATION_CLASS_LIST \
     "models/traffic_sign/classes.txt"
 #define SIGN_CLASSIFICATION_USE_FP_16 true
@@ -21,4 +28,15 @@
 #define MIN_TRAFFIC_SIGN_SIZE 60
 #define SIGN_CLASSIFICATION_THRESH 0.8
 
+// Classification cache of tracked signs: classify a sign again when its box
+// area grows by this factor, or while its vote is not confident and has
+// less than SIGN_CACHE_MAX_VOTES votes. Forget a track not seen for
+// SIGN_CACHE_MAX_FRAMES_UNSEEN frames. A track is not classified again
+// while its crop is being classified, for at most
+// SIGN_CACHE_MAX_FRAMES_IN_FLIGHT frames
+#define SIGN_CACHE_RECLASSIFY_GROWTH 1.5
+#define SIGN_CACHE_MAX_VOTES 5
+#define SIGN_CACHE_MAX_FRAMES_UNSEEN 30
+#define SIGN_CACHE_MAX_FRAMES_IN_FLIGHT 10
+
 #endif // CONFIG_SIGN_CLASSIFICATION_H
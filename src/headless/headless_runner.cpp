@@ -0,0 +1,287 @@
+#include "headless_runner.h"
+
+#include <sstream>
+
+using namespace std;
+
+HeadlessRunner::HeadlessRunner(StructuredLog *log) : log(log) {
+    car_status = std::make_shared<CarStatus>();
+    camera_model = std::make_shared<CameraModel>();
+
+    // Models load in the background while the source is opened
+    model_loader = std::make_shared<ModelLoader>();
+    collision_warning = std::make_shared<CollisionWarningController>(camera_model, car_status);
+    object_detection_pipeline = std::make_shared<ObjectDetectionPipeline>(
+        model_loader, car_status, collision_warning.get());
+    object_detection_pipeline->setResultCallback([this](const FrameTask &task) {
+        this->log->logDetections(task.frame->frame_id, task.objects,
+            Timer::calcWallTimePassed(task.begin_time));
+        ++n_object_detection_frames;
+    });
+}
+
+bool HeadlessRunner::open(const std::string &source, const std::string &data_file_path, ReplayMode replay_mode) {
+    this->replay_mode = replay_mode;
+
+    if (!data_file_path.empty()) {
+        return readSimulationData(source, data_file_path, sim_data, camera_model) == 0;
+    }
+
+    sim_data = SimulationData();
+    sim_data.source = createFrameSource(source);
+    if (!sim_data.source->open()) {
+        cerr << "Could not open frame source: " << source << endl;
+        return false;
+    }
+    sim_data.begin_frame = 0;
+    sim_data.end_frame = sim_data.source->getFrameCount() - 1;
+    sim_data.playing_fps = sim_data.source->getFPS();
+    return true;
+}
+
+void HeadlessRunner::run(int max_frames) {
+
+    std::shared_ptr<FrameSource> source = sim_data.source;
+    if (!source) return;
+
+    std::ostringstream start_fields;
+    start_fields << "\"source\":\"" << StructuredLog::escape(source->getName()) << "\""
+                 << ",\"fps\":" << source->getFPS()
+                 << ",\"n_frames\":" << source->getFrameCount();
+    log->logEvent("start", start_fields.str());
+
+    model_loader->waitObjectDetector();
+    #ifndef DISABLE_LANE_DETECTOR
+    lane_detector = model_loader->waitLaneDetector();
+    #endif
+
+    // Register consumers before publishing any frame, so that lockstep
+    // replay never publishes a frame before they are ready.
+    // The object detection pipeline registers itself when created
+    #ifndef DISABLE_LANE_DETECTOR
+    if (lane_detection_consumer_id < 0) {
+        lane_detection_consumer_id = car_status->registerFrameConsumer();
+    }
+    #endif
+    if (warning_monitor_consumer_id < 0) {
+        warning_monitor_consumer_id = car_status->registerFrameConsumer();
+    }
+
+    running = true;
+    object_detection_pipeline->start();
+    #ifndef DISABLE_LANE_DETECTOR
+    std::thread ld_thread(&HeadlessRunner::laneDetectionThread, this);
+    #endif
+    std::thread warning_thread(&HeadlessRunner::warningMonitorThread, this);
+
+    size_t current_frame_id = 0;
+    if (sim_data.begin_frame > 0) {
+        current_frame_id = sim_data.begin_frame;
+        source->seek(sim_data.begin_frame);
+    }
+
+    bool need_pacing = replay_mode == kReplayRealtime && !source->isLive() && sim_data.playing_fps > 0;
+    bool lockstep = replay_mode == kReplayLockstep && !source->isLive();
+    car_status->setLockstepReplay(lockstep);
+    Timer::time_point_t begin_time = Timer::getWallTime();
+    Timer::time_point_t next_frame_time = begin_time;
+    uint64_t n_frames = 0;
+
+    // Time based decisions follow the replayed frames, not the replay speed
+    std::unique_ptr<ReplayClock> replay_clock;
+    if (!source->isLive()) {
+        replay_clock.reset(new ReplayClock(sim_data.playing_fps));
+    }
+
+    while (max_frames < 0 || n_frames < static_cast<uint64_t>(max_frames)) {
+
+        // end_frame is -1 when the number of frames is unknown (camera)
+        if (sim_data.end_frame >= 0 && current_frame_id > static_cast<size_t>(sim_data.end_frame)) {
+            break;
+        }
+
+        // Read into a new buffer each time, as the published frame
+        // keeps referencing this one
+        cv::Mat frame;
+        if (!source->read(frame)) {
+            break;
+        }
+        if (replay_clock) {
+            replay_clock->setFrameTimestamp(source->getTimestamp());
+        }
+
+        if (current_frame_id < sim_data.sim_frames.size()) {
+            car_status->setCarStatus(sim_data.sim_frames[current_frame_id].car_speed,
+                sim_data.sim_frames[current_frame_id].turning_left,
+                sim_data.sim_frames[current_frame_id].turning_right);
+        }
+
+        FramePtr published_frame = car_status->setCurrentImage(frame);
+        ++n_frames;
+        ++current_frame_id;
+
+        if (lockstep) {
+            car_status->waitForFrameConsumers(published_frame->frame_id);
+        } else if (need_pacing) {
+            next_frame_time += std::chrono::microseconds(static_cast<long long>(1e6 / sim_data.playing_fps));
+            std::this_thread::sleep_until(next_frame_time);
+        }
+    }
+
+    Timer::time_duration_t elapsed = Timer::calcWallTimePassed(begin_time);
+
+    running = false;
+    car_status->setLockstepReplay(false);
+    object_detection_pipeline->stop();
+    #ifndef DISABLE_LANE_DETECTOR
+    ld_thread.join();
+    #endif
+    warning_thread.join();
+    source->close();
+
+    double seconds = std::max<double>(elapsed, 1) / 1000.0;
+    std::ostringstream end_fields;
+    end_fields << "\"mode\":\"" << (lockstep ? "lockstep" : need_pacing ? "realtime" : "fast") << "\""
+               << ",\"n_frames\":" << n_frames
+               << ",\"duration\":" << elapsed
+               << ",\"source_fps\":" << n_frames / seconds
+               << ",\"object_detection_frames\":" << n_object_detection_frames
+               << ",\"object_detection_fps\":" << n_object_detection_frames / seconds
+               << ",\"lane_detection_frames\":" << n_lane_detection_frames
+               << ",\"lane_detection_fps\":" << n_lane_detection_frames / seconds;
+    log->logEvent("end", end_fields.str());
+
+    // Startup metrics (ms since the models started loading)
+    std::ostringstream startup_fields;
+    startup_fields << "\"object_detector_load_time\":" << model_loader->getObjectDetectorLoadTime()
+                   << ",\"lane_detector_load_time\":" << model_loader->getLaneDetectorLoadTime()
+                   << ",\"time_to_first_detection\":" << model_loader->getTimeToFirstDetection();
+    log->logEvent("startup", startup_fields.str());
+
+    // Where frames were dropped and how long each stage took
+    std::ostringstream stats_fields;
+    stats_fields << "\"stages\":[";
+    std::vector<PipelineStageStats> stats = object_detection_pipeline->getStats();
+    for (size_t i = 0; i < stats.size(); ++i) {
+        if (i > 0) stats_fields << ",";
+        stats_fields << "{\"name\":\"" << stats[i].name << "\""
+                     << ",\"workers\":" << stats[i].n_workers
+                     << ",\"processed\":" << stats[i].n_processed
+                     << ",\"dropped\":" << stats[i].n_dropped
+                     << ",\"failed\":" << stats[i].n_failed
+                     << ",\"avg_processing_time\":" << stats[i].avg_processing_time
+                     << ",\"max_queue_size\":" << stats[i].max_queue_size << "}";
+    }
+    stats_fields << "]";
+    log->logEvent("pipeline_stats", stats_fields.str());
+
+    // How many signs reused the classification of their track
+    SignClassificationStats sign_stats = object_detection_pipeline->getSignClassificationStats();
+    std::ostringstream sign_fields;
+    sign_fields << "\"requests\":" << sign_stats.n_requests
+                << ",\"classifications\":" << sign_stats.n_classifications
+                << ",\"classification_ratio\":"
+                << (sign_stats.n_requests ? static_cast<double>(sign_stats.n_classifications) / sign_stats.n_requests : 0)
+                << ",\"batches\":" << sign_stats.batcher.n_batches
+                << ",\"full_batches\":" << sign_stats.batcher.n_full_batches;
+    log->logEvent("sign_classification_stats", sign_fields.str());
+}
+
+void HeadlessRunner::laneDetectionThread(HeadlessRunner *runner) {
+    #ifndef DISABLE_LANE_DETECTOR
+    std::shared_ptr<CarStatus> car_status = runner->car_status;
+    uint64_t processed_frame_id = 0;
+    bool lane_departure = false;
+    std::vector<LaneLine> detected_lines;
+
+    while (runner->running) {
+
+        FramePtr frame = car_status->waitForFrame(processed_frame_id, HEADLESS_MAX_FRAME_WAIT);
+        if (!frame) continue;
+        processed_frame_id = frame->frame_id;
+
+        // Don't analyze lane when turning signal is activated
+        if (Timer::calcDiff(car_status->getLastActivatedTurningSignalTime(), frame->capture_time) <= 5000) {
+            runner->is_lane_departure_warning = false;
+            runner->lane_detector->resetTracking();
+            car_status->setDetectedLaneLines(std::vector<LaneLine>());
+            car_status->setFrameProcessed(runner->lane_detection_consumer_id, processed_frame_id);
+            continue;
+        }
+
+        Timer::time_point_t begin_time = Timer::getWallTime();
+        cv::Mat model_input = car_status->getPreprocessCache()->getResized(
+            frame, runner->lane_detector->getInputSize(), kResizeStretch);
+        runner->lane_detector->detectLaneLines(frame->image, detected_lines, lane_departure, model_input, frame->capture_time);
+        Timer::time_duration_t processing_time = Timer::calcWallTimePassed(begin_time);
+        car_status->setLaneDetectionTime(processing_time);
+        car_status->setDetectedLaneLines(detected_lines);
+
+        runner->is_lane_departure_warning = lane_departure &&
+            car_status->getCarSpeed() >= MIN_SPEED_FOR_LANE_DEPARTURE_WARNING;
+
+        runner->log->logLaneLines(frame->frame_id, detected_lines, lane_departure, processing_time);
+        ++runner->n_lane_detection_frames;
+        car_status->setFrameProcessed(runner->lane_detection_consumer_id, processed_frame_id);
+    }
+    #endif
+}
+
+void HeadlessRunner::warningMonitorThread(HeadlessRunner *runner) {
+    std::shared_ptr<CarStatus> car_status = runner->car_status;
+    uint64_t processed_frame_id = 0;
+    bool calibration_warned = false;
+    Timer::time_point_t last_lane_departure_warning_time;
+
+    while (runner->running) {
+
+        // Warnings are checked once per frame
+        FramePtr frame = car_status->waitForFrame(processed_frame_id, WARNING_MONITOR_MAX_INTERVAL);
+        if (!frame) continue;
+        processed_frame_id = frame->frame_id;
+
+        // In lockstep replay, check the results of the other threads on
+        // this frame: the next frame is only published once this one is done
+        if (car_status->isLockstepReplay()) {
+            while (runner->running && !car_status->waitForFrameConsumers(
+                processed_frame_id, WARNING_MONITOR_MAX_INTERVAL, runner->warning_monitor_consumer_id)) {
+            }
+        }
+
+        // Same rules as the warning monitor of the main window,
+        // with warnings logged instead of played
+        if (!runner->camera_model->isCalibrated()) {
+            if (!calibration_warned) {
+                runner->log->logWarning(processed_frame_id, "not_calibrated",
+                    "Camera hasn't been calibrated yet. Safety features are disabled.");
+                calibration_warned = true;
+            }
+            car_status->setFrameProcessed(runner->warning_monitor_consumer_id, processed_frame_id);
+            continue;
+        }
+
+        MaxSpeedLimit speed_limit = car_status->getMaxSpeedLimit();
+        if (speed_limit.speed_limit >= 0 && !speed_limit.has_notified) {
+            runner->log->logWarning(processed_frame_id, "speed_limit", std::to_string(speed_limit.speed_limit));
+        }
+
+        if (speed_limit.overspeed_warning && !speed_limit.overspeed_warning_has_notified) {
+            runner->log->logWarning(processed_frame_id, "overspeed",
+                std::to_string(car_status->getCarSpeed()) + " > " + std::to_string(speed_limit.speed_limit));
+        }
+
+        CollisionWarningStatus collision_warning_status = car_status->getCollisionWarning();
+        if (collision_warning_status.is_warning && collision_warning_status.should_notify) {
+            runner->log->logWarning(processed_frame_id, "collision");
+        }
+
+        // Time of the replayed frames, as for the lane departure decision
+        if (runner->is_lane_departure_warning &&
+            Timer::calcDiff(last_lane_departure_warning_time, frame->capture_time) > LANE_DEPARTURE_WARNING_INTERVAL) {
+            runner->log->logWarning(processed_frame_id, "lane_departure");
+            last_lane_departure_warning_time = frame->capture_time;
+        }
+
+        car_status->setFrameProcessed(runner->warning_monitor_consumer_id, processed_frame_id);
+    }
+}
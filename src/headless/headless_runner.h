@@ -0,0 +1,88 @@
+#ifndef HEADLESS_RUNNER_H
+#define HEADLESS_RUNNER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "configs/config.h"
+#include "utils/timer.h"
+
+#include "perception/camera_model/camera_model.h"
+#include "perception/lane_detection/lane_detector.h"
+#include "perception/object_detection/object_detector.h"
+
+#include "sensors/car_status.h"
+#include "sensors/frame_sources/frame_source.h"
+
+#include "ui/simulation/simulation_data.h"
+#include "ui/warnings/collision_warning_controller.h"
+#include "ui/warnings/traffic_sign_monitor.h"
+
+#include "pipeline/model_loader.h"
+#include "pipeline/object_detection_pipeline.h"
+
+#include "structured_log.h"
+
+// How frames of a non-live source are pushed into the pipeline
+enum ReplayMode {
+    // Publish a frame after all processing threads are done with the
+    // previous one (every frame processed, deterministic, no sleep)
+    kReplayLockstep,
+    // Publish frames as fast as they can be read. Processing threads
+    // skip frames they can't keep up with
+    kReplayAsFastAsPossible,
+    // Publish frames at the frame rate of the source
+    kReplayRealtime
+};
+
+// Run the perception pipeline without any UI:
+// frame source -> CarStatus -> object detection, lane detection
+// and warning monitor threads. Results and warnings are written
+// to a StructuredLog instead of being drawn and played.
+class HeadlessRunner {
+   private:
+    std::shared_ptr<CarStatus> car_status;
+    std::shared_ptr<CameraModel> camera_model;
+    std::shared_ptr<ModelLoader> model_loader;
+    std::shared_ptr<CollisionWarningController> collision_warning;
+    std::shared_ptr<ObjectDetectionPipeline> object_detection_pipeline;
+    #ifndef DISABLE_LANE_DETECTOR
+    std::shared_ptr<LaneDetector> lane_detector;
+    #endif
+
+    StructuredLog *log;
+    SimulationData sim_data;
+    ReplayMode replay_mode = kReplayLockstep;
+
+    // Consumer ids of the lane detection and warning monitor threads in
+    // CarStatus (for lockstep replay)
+    int lane_detection_consumer_id = -1;
+    int warning_monitor_consumer_id = -1;
+
+    std::atomic<bool> running = {false};
+    std::atomic<bool> is_lane_departure_warning = {false};
+    std::atomic<uint64_t> n_object_detection_frames = {0};
+    std::atomic<uint64_t> n_lane_detection_frames = {0};
+
+    static void laneDetectionThread(HeadlessRunner *runner);
+    static void warningMonitorThread(HeadlessRunner *runner);
+
+   public:
+    explicit HeadlessRunner(StructuredLog *log);
+
+    // Open a frame source (see createFrameSource()) and an optional
+    // simulation data file (car speed, turn signals, camera calibration).
+    // Live sources (cameras) ignore replay_mode.
+    // Return false on failure
+    bool open(const std::string &source, const std::string &data_file_path, ReplayMode replay_mode);
+
+    // Play the source until its end (or max_frames frames if max_frames >= 0).
+    // Replay starts once all models are loaded, so that no frame is
+    // skipped while warming up.
+    // Block until all processing threads are stopped
+    void run(int max_frames = -1);
+};
+
+#endif
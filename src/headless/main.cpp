@@ -0,0 +1,68 @@
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "headless_runner.h"
+#include "structured_log.h"
+#include "perception/common/inference/inference_backend.h"
+
+using namespace std;
+
+int main(int argc, char *argv[]) {
+
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{source         |0     | camera id, /dev/videoX, video file, image folder or .frames file }"
+        "{data_file      |      | simulation data file (car speed, turn signals, camera calibration) }"
+        "{log            |-     | JSON lines log file. '-' for stdout }"
+        "{mode           |lockstep | replay of files. 'lockstep' (every frame processed, no sleep), 'fast' (frames read as fast as possible, slow stages skip frames) or 'realtime' (source frame rate) }"
+        "{max_frames     |-1    | stop after this number of frames }"
+        "{inference_backend |   | 'auto' (TensorRT, CPU if no GPU or the engine fails), 'tensorrt' or 'cpu'. Default: INFERENCE_BACKEND in configs/config.h }"
+        ;
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("OpenADAS headless runner");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    cv::setNumThreads(1);
+
+    StructuredLog log;
+    if (!log.open(parser.get<std::string>("log"))) {
+        return 1;
+    }
+
+    std::string mode = parser.get<std::string>("mode");
+    ReplayMode replay_mode = kReplayLockstep;
+    if (mode == "fast") {
+        replay_mode = kReplayAsFastAsPossible;
+    } else if (mode == "realtime") {
+        replay_mode = kReplayRealtime;
+    } else if (mode != "lockstep") {
+        cerr << "Unknown mode: " << mode << endl;
+        return 1;
+    }
+
+    // Must be set before models are created
+    std::string inference_backend = parser.get<std::string>("inference_backend");
+    if (!inference_backend.empty()) {
+        InferenceBackendType backend_type;
+        if (!parseInferenceBackendType(inference_backend, backend_type)) {
+            cerr << "Unknown inference backend: " << inference_backend << endl;
+            return 1;
+        }
+        setInferenceBackendType(backend_type);
+    }
+
+    HeadlessRunner runner(&log);
+    if (!runner.open(parser.get<std::string>("source"),
+            parser.get<std::string>("data_file"),
+            replay_mode)) {
+        return 1;
+    }
+
+    runner.run(parser.get<int>("max_frames"));
+
+    return 0;
+}
@@ -0,0 +1,115 @@
+#include "structured_log.h"
+
+#include <iomanip>
+#include <sstream>
+
+#include "configs/config_object_detection.h"
+
+StructuredLog::StructuredLog() {
+    start_time = Timer::getWallTime();
+}
+
+bool StructuredLog::open(const std::string &file_path) {
+    std::lock_guard<std::mutex> guard(log_mutex);
+    if (file_path.empty() || file_path == "-") {
+        out = &std::cout;
+        return true;
+    }
+
+    file.open(file_path, std::ios::out | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Could not open log file: " << file_path << std::endl;
+        return false;
+    }
+    out = &file;
+    return true;
+}
+
+void StructuredLog::writeLine(const std::string &event, const std::string &fields) {
+    std::ostringstream line;
+    line << "{\"event\":\"" << event << "\",\"time\":" << Timer::calcWallTimePassed(start_time);
+    if (!fields.empty()) {
+        line << "," << fields;
+    }
+    line << "}\n";
+
+    std::lock_guard<std::mutex> guard(log_mutex);
+    *out << line.str();
+    out->flush();
+}
+
+void StructuredLog::logDetections(uint64_t frame_id, const std::vector<TrafficObject> &objects,
+    Timer::time_duration_t processing_time) {
+    std::ostringstream fields;
+    fields << std::fixed << std::setprecision(3);
+    fields << "\"frame_id\":" << frame_id << ",\"processing_time\":" << processing_time << ",\"objects\":[";
+    for (size_t i = 0; i < objects.size(); ++i) {
+        const TrafficObject &object = objects[i];
+        if (i > 0) fields << ",";
+        fields << "{\"class\":\"" << escape(ctdet::className[object.classId]) << "\""
+               << ",\"prob\":" << object.prob
+               << ",\"track_id\":" << object.track_id
+               << ",\"track_age\":" << object.track_age
+               << ",\"bbox\":[" << object.bbox.x1 << "," << object.bbox.y1 << ","
+               << object.bbox.x2 << "," << object.bbox.y2 << "]";
+        if (!object.traffic_sign_type.empty()) {
+            fields << ",\"sign\":\"" << escape(object.traffic_sign_type) << "\"";
+        }
+        if (object.distance_to_my_car >= 0) {
+            fields << ",\"distance\":" << object.distance_to_my_car;
+        }
+        fields << "}";
+    }
+    fields << "]";
+    writeLine("detections", fields.str());
+}
+
+void StructuredLog::logLaneLines(uint64_t frame_id, const std::vector<LaneLine> &lane_lines,
+    bool lane_departure, Timer::time_duration_t processing_time) {
+    static const char *type_names[] = {"left", "right", "other"};
+    std::ostringstream fields;
+    fields << "\"frame_id\":" << frame_id << ",\"processing_time\":" << processing_time
+           << ",\"lane_departure\":" << (lane_departure ? "true" : "false") << ",\"lines\":[";
+    for (size_t i = 0; i < lane_lines.size(); ++i) {
+        const cv::Vec4i &line = lane_lines[i].line;
+        if (i > 0) fields << ",";
+        fields << "{\"type\":\"" << type_names[lane_lines[i].type] << "\""
+               << ",\"line\":[" << line[0] << "," << line[1] << "," << line[2] << "," << line[3] << "]}";
+    }
+    fields << "]";
+    writeLine("lane_lines", fields.str());
+}
+
+void StructuredLog::logWarning(uint64_t frame_id, const std::string &type, const std::string &detail) {
+    std::ostringstream fields;
+    fields << "\"frame_id\":" << frame_id << ",\"type\":\"" << escape(type) << "\"";
+    if (!detail.empty()) {
+        fields << ",\"detail\":\"" << escape(detail) << "\"";
+    }
+    writeLine("warning", fields.str());
+}
+
+void StructuredLog::logEvent(const std::string &event, const std::string &fields) {
+    writeLine(event, fields);
+}
+
+std::string StructuredLog::escape(const std::string &s) {
+    std::ostringstream escaped;
+    for (char c : s) {
+        switch (c) {
+            case '"': escaped << "\\\""; break;
+            case '\\': escaped << "\\\\"; break;
+            case '\n': escaped << "\\n"; break;
+            case '\r': escaped << "\\r"; break;
+            case '\t': escaped << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                            << static_cast<int>(c) << std::dec;
+                } else {
+                    escaped << c;
+                }
+        }
+    }
+    return escaped.str();
+}
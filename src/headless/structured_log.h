@@ -0,0 +1,48 @@
+#ifndef STRUCTURED_LOG_H
+#define STRUCTURED_LOG_H
+
+#include <stdint.h>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/timer.h"
+#include "perception/object_detection/traffic_object.h"
+#include "perception/lane_detection/lane_line.h"
+
+// Log of pipeline results and warnings in JSON lines format
+// (one JSON object per line), so that runs can be compared by scripts.
+// Every line has an "event" field and a "time" field (ms since the log
+// was opened). Safe to use from multiple threads.
+class StructuredLog {
+   private:
+    std::mutex log_mutex;
+    std::ofstream file;
+    std::ostream *out = &std::cout;
+    Timer::time_point_t start_time;
+
+    void writeLine(const std::string &event, const std::string &fields);
+
+   public:
+    StructuredLog();
+
+    // Log into a file. Log to stdout if file_path is empty or "-"
+    bool open(const std::string &file_path);
+
+    void logDetections(uint64_t frame_id, const std::vector<TrafficObject> &objects,
+        Timer::time_duration_t processing_time);
+    void logLaneLines(uint64_t frame_id, const std::vector<LaneLine> &lane_lines,
+        bool lane_departure, Timer::time_duration_t processing_time);
+
+    // Warning types: collision, lane_departure, speed_limit, overspeed, not_calibrated
+    void logWarning(uint64_t frame_id, const std::string &type, const std::string &detail = "");
+
+    // Free form event with already formatted JSON fields. Ex: "\"n_frames\":10"
+    void logEvent(const std::string &event, const std::string &fields = "");
+
+    static std::string escape(const std::string &s);
+};
+
+#endif
@@ -7,6 +7,7 @@
 #include "ui/main_window.h"
 #include "ui/simulation/simulation.h"
 #include "ui/input_source.h"
+#include "perception/common/inference/inference_backend.h"
 
 #include "utils/file_storage.h"
 #include "utils/filesystem_include.h"
@@ -23,6 +24,9 @@ int main(int argc, char *argv[]) {
         "{input_source   |simulation| input source. 'camera' or 'simulation'   }"
         "{input_video_path  |      | path to video file for simulation }"
         "{input_data_path   |      | path to data file for simulation  }"
+        "{camera            |0     | frame source for 'camera' input. Camera id, /dev/videoX, video file, image folder or .frames file }"
+        "{replay_mode       |realtime| simulation replay. 'realtime' (video frame rate) or 'lockstep' (as fast as processing allows, every frame processed) }"
+        "{inference_backend |      | 'auto' (TensorRT, CPU if no GPU or the engine fails), 'tensorrt' or 'cpu'. Default: INFERENCE_BACKEND in configs/config.h }"
         "{on_dev_machine    |true| on development machine  }"
         ;
 
@@ -36,9 +40,26 @@ int main(int argc, char *argv[]) {
     std::string input_source = parser.get<std::string>("input_source");
     std::string input_video_path = parser.get<std::string>("input_video_path");
     std::string input_data_path = parser.get<std::string>("input_data_path");
+    std::string camera = parser.get<std::string>("camera");
+    std::string replay_mode = parser.get<std::string>("replay_mode");
+    if (replay_mode != "realtime" && replay_mode != "lockstep") {
+        cerr << "Unknown replay mode: " << replay_mode << endl;
+        return 1;
+    }
 
     bool on_dev_machine = parser.get<bool>("on_dev_machine");
 
+    // Must be set before models are created
+    std::string inference_backend = parser.get<std::string>("inference_backend");
+    if (!inference_backend.empty()) {
+        InferenceBackendType backend_type;
+        if (!parseInferenceBackendType(inference_backend, backend_type)) {
+            cerr << "Unknown inference backend: " << inference_backend << endl;
+            return 1;
+        }
+        setInferenceBackendType(backend_type);
+    }
+
     // If not on development machine
     // (on Jetson Nano)
     if (!on_dev_machine) {
@@ -54,7 +75,7 @@ int main(int argc, char *argv[]) {
     a.setStyle(new DarkStyle);
 
     // Create our mainwindow instance
-    MainWindow *main_window = new MainWindow(0, input_source=="simulation");
+    MainWindow *main_window = new MainWindow(0, input_source=="simulation", camera);
     if (!on_dev_machine) {
         main_window->showFullScreen();
     } else {
@@ -74,6 +95,8 @@ int main(int argc, char *argv[]) {
             simulation = new Simulation(main_window->car_status, main_window->camera_model, input_video_path, input_data_path);
         }
         
+        ((Simulation*)simulation)->setLockstepReplay(replay_mode == "lockstep");
+
         // Set simulation
         main_window->setInputSource(kInputFromSimulation);
         main_window->setSimulation((Simulation*)simulation);
@@ -0,0 +1,111 @@
+#include "async_inference.h"
+
+AsyncInference::AsyncInference(std::shared_ptr<InferenceBackend> backend) :
+    backend(backend) {
+    worker = std::thread(&AsyncInference::workerThread, this);
+}
+
+AsyncInference::~AsyncInference() {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        stopping = true;
+    }
+    slot_changed.notify_all();
+    worker.join();
+}
+
+std::shared_ptr<InferenceBackend> AsyncInference::getBackend() {
+    return backend;
+}
+
+void AsyncInference::workerThread(AsyncInference *async_inference) {
+    std::unique_lock<std::mutex> lock(async_inference->mutex);
+    while (true) {
+        async_inference->slot_changed.wait(lock, [async_inference]() {
+            return async_inference->stopping || !async_inference->queue.empty();
+        });
+        // Requests already submitted are run before stopping, so that
+        // nobody waits forever
+        if (async_inference->queue.empty()) {
+            return;
+        }
+
+        int slot_index = async_inference->queue.front();
+        async_inference->queue.pop_front();
+        Slot &slot = async_inference->slots[slot_index];
+        slot.state = kSlotRunning;
+
+        // The backend runs without the lock: other threads can submit,
+        // poll or read the outputs of the other slot meanwhile
+        lock.unlock();
+        bool success = async_inference->backend->infer(slot.input, slot.batch_size, slot_index);
+        lock.lock();
+
+        slot.success = success;
+        slot.state = kSlotDone;
+        async_inference->slot_changed.notify_all();
+    }
+}
+
+int AsyncInference::acquire(bool wait_for_slot) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        for (int i = 0; i < kInferenceSlots; ++i) {
+            if (slots[i].state == kSlotFree) {
+                slots[i].state = kSlotAcquired;
+                return i;
+            }
+        }
+        if (!wait_for_slot) {
+            return -1;
+        }
+        slot_changed.wait(lock);
+    }
+}
+
+bool AsyncInference::submit(int slot, const float *input, int batch_size) {
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (slots[slot].state != kSlotAcquired) {
+            return false;
+        }
+        slots[slot].state = kSlotQueued;
+        slots[slot].input = input;
+        slots[slot].batch_size = batch_size;
+        slots[slot].success = false;
+        queue.push_back(slot);
+    }
+    slot_changed.notify_all();
+    return true;
+}
+
+bool AsyncInference::poll(int slot) {
+    std::lock_guard<std::mutex> guard(mutex);
+    return slots[slot].state == kSlotDone;
+}
+
+bool AsyncInference::wait(int slot) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (slots[slot].state == kSlotFree || slots[slot].state == kSlotAcquired) {
+        return false;
+    }
+    slot_changed.wait(lock, [this, slot]() { return slots[slot].state == kSlotDone; });
+    return slots[slot].success;
+}
+
+const float *AsyncInference::getOutput(int slot, int output_index) {
+    return backend->getOutput(output_index, slot);
+}
+
+void AsyncInference::release(int slot) {
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (slots[slot].state != kSlotFree && slots[slot].state != kSlotAcquired) {
+            slot_changed.wait(lock, [this, slot]() { return slots[slot].state == kSlotDone; });
+        }
+        slots[slot].state = kSlotFree;
+        slots[slot].input = nullptr;
+    }
+    // Wake up threads waiting in acquire()
+    slot_changed.notify_all();
+}
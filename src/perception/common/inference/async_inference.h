@@ -0,0 +1,87 @@
+#ifndef ASYNC_INFERENCE_H
+#define ASYNC_INFERENCE_H
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "inference_backend.h"
+
+// Run an inference backend on a worker thread, with up to kInferenceSlots
+// requests in flight. The caller can prepare the input of the next request
+// while the backend runs the current one:
+//
+//   int slot = async_inference.acquire();
+//   ... write the input of slot ...
+//   async_inference.submit(slot, input, 1);
+//   ... prepare the next input ...
+//   if (async_inference.wait(slot)) read async_inference.getOutput(slot, 0);
+//   async_inference.release(slot);
+//
+// Requests run in submission order. Works with any backend: with a CPU
+// backend, the worker thread is the one doing the computation.
+// While an AsyncInference exists, only its worker may use the backend
+class AsyncInference {
+   private:
+    enum SlotState {
+        kSlotFree,
+        kSlotAcquired,
+        kSlotQueued,
+        kSlotRunning,
+        kSlotDone,
+    };
+
+    struct Slot {
+        SlotState state = kSlotFree;
+        const float *input = nullptr;
+        int batch_size = 0;
+        bool success = false;
+    };
+
+    std::shared_ptr<InferenceBackend> backend;
+
+    Slot slots[kInferenceSlots];
+    std::deque<int> queue;
+    std::mutex mutex;
+    std::condition_variable slot_changed;
+    bool stopping = false;
+
+    std::thread worker;
+
+    static void workerThread(AsyncInference *async_inference);
+
+   public:
+    explicit AsyncInference(std::shared_ptr<InferenceBackend> backend);
+
+    // Finish the submitted requests and stop the worker
+    ~AsyncInference();
+
+    std::shared_ptr<InferenceBackend> getBackend();
+
+    // Reserve a free slot, e.g. to write the input in a buffer of this slot.
+    // Return -1 if all slots are in use, or with wait_for_slot, wait for
+    // another thread to release one
+    int acquire(bool wait_for_slot = false);
+
+    // Queue the inference of batch_size images of input on an acquired slot.
+    // input is not copied: keep it unchanged until the request is done
+    bool submit(int slot, const float *input, int batch_size);
+
+    // True if the request of slot is done (successfully or not)
+    bool poll(int slot);
+
+    // Wait for the request of slot to be done. Return false if inference
+    // failed or nothing was submitted on slot
+    bool wait(int slot);
+
+    // Output of a done request, valid until the slot is released
+    const float *getOutput(int slot, int output_index);
+
+    // Make slot available for another request. Waits for the request first
+    // if it was submitted
+    void release(int slot);
+};
+
+#endif
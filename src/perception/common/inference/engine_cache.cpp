@@ -0,0 +1,220 @@
+#include "engine_cache.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <cuda_runtime_api.h>
+#include <NvInfer.h>
+
+#include "utils/mapped_file.h"
+
+bool EngineCacheKey::operator==(const EngineCacheKey &other) const {
+    return model_hash == other.model_hash && precision == other.precision &&
+        batch_size == other.batch_size && runtime_version == other.runtime_version;
+}
+
+bool EngineCacheKey::operator!=(const EngineCacheKey &other) const {
+    return !(*this == other);
+}
+
+EngineCache::EngineCache(const std::string &engine_path, const std::string &model_path,
+                         const std::string &precision, int batch_size,
+                         const std::string &runtime_version) :
+    engine_path(engine_path) {
+    key.precision = precision;
+    key.batch_size = batch_size;
+    key.runtime_version = runtime_version;
+
+    struct stat model_stat;
+    if (stat(model_path.c_str(), &model_stat) != 0) {
+        return;
+    }
+    model_size = model_stat.st_size;
+    model_mtime = static_cast<int64_t>(model_stat.st_mtim.tv_sec) * 1000000000LL + model_stat.st_mtim.tv_nsec;
+
+    // Only hash the model if it changed since the manifest was written
+    EngineCacheKey manifest_key;
+    uint64_t manifest_model_size;
+    int64_t manifest_model_mtime;
+    if (readManifest(manifest_key, manifest_model_size, manifest_model_mtime) &&
+        manifest_model_size == model_size && manifest_model_mtime == model_mtime) {
+        key.model_hash = manifest_key.model_hash;
+    } else {
+        key.model_hash = hashFile(model_path);
+    }
+}
+
+const EngineCacheKey &EngineCache::getKey() {
+    return key;
+}
+
+std::string EngineCache::getManifestPath() {
+    return engine_path + ".manifest";
+}
+
+bool EngineCache::readManifest(EngineCacheKey &manifest_key, uint64_t &manifest_model_size,
+                               int64_t &manifest_model_mtime) {
+    std::ifstream manifest(getManifestPath());
+    if (!manifest) {
+        return false;
+    }
+
+    int n_fields = 0;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) continue;
+        std::string name = line.substr(0, separator);
+        std::string value = line.substr(separator + 1);
+        try {
+            if (name == "model_hash") {
+                manifest_key.model_hash = value;
+            } else if (name == "model_size") {
+                manifest_model_size = std::stoull(value);
+            } else if (name == "model_mtime") {
+                manifest_model_mtime = std::stoll(value);
+            } else if (name == "precision") {
+                manifest_key.precision = value;
+            } else if (name == "batch_size") {
+                manifest_key.batch_size = std::stoi(value);
+            } else if (name == "runtime_version") {
+                manifest_key.runtime_version = value;
+            } else {
+                continue;
+            }
+        } catch (const std::exception &) {
+            return false;
+        }
+        ++n_fields;
+    }
+    return n_fields == 6;
+}
+
+bool EngineCache::isValid() {
+    if (key.model_hash.empty()) {
+        std::cerr << "Engine cache: could not read the model of " << engine_path << std::endl;
+        return false;
+    }
+
+    struct stat engine_stat;
+    if (stat(engine_path.c_str(), &engine_stat) != 0) {
+        std::cout << "Engine cache: no engine at " << engine_path << std::endl;
+        return false;
+    }
+
+    EngineCacheKey manifest_key;
+    uint64_t manifest_model_size;
+    int64_t manifest_model_mtime;
+    if (!readManifest(manifest_key, manifest_model_size, manifest_model_mtime)) {
+        std::cout << "Engine cache: no manifest for " << engine_path << std::endl;
+        return false;
+    }
+
+    if (manifest_key.model_hash != key.model_hash) {
+        std::cout << "Engine cache: model changed since " << engine_path << " was built" << std::endl;
+        return false;
+    }
+    if (manifest_key.precision != key.precision || manifest_key.batch_size != key.batch_size) {
+        std::cout << "Engine cache: " << engine_path << " was built for "
+                  << manifest_key.precision << " and batch size " << manifest_key.batch_size
+                  << ", expected " << key.precision << " and batch size " << key.batch_size << std::endl;
+        return false;
+    }
+    if (manifest_key.runtime_version != key.runtime_version) {
+        std::cout << "Engine cache: " << engine_path << " was built with "
+                  << manifest_key.runtime_version << ", running " << key.runtime_version << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool EngineCache::save(const void *data, size_t size) {
+    if (key.model_hash.empty()) {
+        return false;
+    }
+
+    // Without a manifest, a crash before the end leaves an invalid cache
+    remove(getManifestPath().c_str());
+    if (!writeFileAtomic(engine_path, data, size)) {
+        return false;
+    }
+
+    std::ostringstream manifest;
+    manifest << "model_hash=" << key.model_hash << "\n"
+             << "model_size=" << model_size << "\n"
+             << "model_mtime=" << model_mtime << "\n"
+             << "precision=" << key.precision << "\n"
+             << "batch_size=" << key.batch_size << "\n"
+             << "runtime_version=" << key.runtime_version << "\n";
+    std::string content = manifest.str();
+    return writeFileAtomic(getManifestPath(), content.data(), content.size());
+}
+
+void EngineCache::invalidate() {
+    remove(getManifestPath().c_str());
+    remove(engine_path.c_str());
+}
+
+std::string EngineCache::hashFile(const std::string &file_path) {
+    MappedFile file;
+    if (!file.open(file_path)) {
+        return "";
+    }
+    file.adviseSequential();
+
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(file.getData());
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < file.getSize(); ++i) {
+        hash ^= data[i];
+        hash *= 1099511628211ULL;
+    }
+
+    char digest[17];
+    snprintf(digest, sizeof(digest), "%016llx", static_cast<unsigned long long>(hash));
+    return digest;
+}
+
+bool EngineCache::writeFileAtomic(const std::string &file_path, const void *data, size_t size) {
+    std::string tmp_path = file_path + ".tmp";
+    int fd = open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        std::cerr << "Could not write file: " << tmp_path << std::endl;
+        return false;
+    }
+
+    const char *begin = static_cast<const char *>(data);
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = write(fd, begin + written, size - written);
+        if (n <= 0) break;
+        written += n;
+    }
+
+    // Flushed to the disk before being renamed: the final file is either
+    // the old one or the complete new one
+    bool success = written == size && fsync(fd) == 0;
+    success = close(fd) == 0 && success;
+    if (!success || rename(tmp_path.c_str(), file_path.c_str()) != 0) {
+        std::cerr << "Could not write file: " << file_path << std::endl;
+        remove(tmp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+std::string getTensorRTRuntimeVersion() {
+    int version = getInferLibVersion();
+    std::ostringstream result;
+    result << "TensorRT " << version / 1000 << "." << version / 100 % 10 << "." << version % 100;
+
+    int device;
+    cudaDeviceProp prop;
+    if (cudaGetDevice(&device) == cudaSuccess && cudaGetDeviceProperties(&prop, device) == cudaSuccess) {
+        result << ", " << prop.name << " (" << prop.major << "." << prop.minor << ")";
+    }
+    return result.str();
+}
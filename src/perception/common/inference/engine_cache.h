@@ -0,0 +1,73 @@
+#ifndef ENGINE_CACHE_H
+#define ENGINE_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+
+// What a TensorRT engine was built from.
+// An engine is only reused when it was built from the same key
+struct EngineCacheKey {
+    std::string model_hash;       // EngineCache::hashFile() of the model file
+    std::string precision;        // "FLOAT32", "FLOAT16" or "INT8"
+    int batch_size = 0;
+    std::string runtime_version;  // TensorRT version and GPU, see getTensorRTRuntimeVersion()
+
+    bool operator==(const EngineCacheKey &other) const;
+    bool operator!=(const EngineCacheKey &other) const;
+};
+
+// Cache of one TensorRT engine file. The engine has a sidecar manifest
+// "<engine>.manifest" with the key it was built from, and is rebuilt only
+// when the key of the current model, precision and runtime is different.
+// The engine and the manifest are written to temporary files and renamed,
+// so that an interrupted write (e.g. power loss) never leaves a truncated
+// engine with a valid manifest.
+// Hashing a large model takes time: the manifest also records the size and
+// the modification time of the model, and its hash is reused while they
+// don't change
+class EngineCache {
+   private:
+    std::string engine_path;
+    EngineCacheKey key;
+
+    // Model file stat, as recorded in the manifest
+    uint64_t model_size = 0;
+    int64_t model_mtime = 0;
+
+    bool readManifest(EngineCacheKey &manifest_key, uint64_t &manifest_model_size,
+                      int64_t &manifest_model_mtime);
+
+   public:
+    // Compute the key of an engine built from model_path.
+    // The key has an empty model_hash if the model cannot be read
+    EngineCache(const std::string &engine_path, const std::string &model_path,
+                const std::string &precision, int batch_size,
+                const std::string &runtime_version);
+
+    const EngineCacheKey &getKey();
+    std::string getManifestPath();
+
+    // True if the engine file exists and was built from the current key.
+    // Print the reason when it must be rebuilt
+    bool isValid();
+
+    // Write a new engine and its manifest
+    bool save(const void *data, size_t size);
+
+    // Remove the engine and its manifest
+    void invalidate();
+
+    // Hex digest (64-bit FNV-1a) of the content of a file.
+    // Return an empty string if the file cannot be read
+    static std::string hashFile(const std::string &file_path);
+
+    // Write data to file_path.tmp, then rename it to file_path
+    static bool writeFileAtomic(const std::string &file_path, const void *data, size_t size);
+};
+
+// TensorRT library version, and name and compute capability of the
+// current CUDA device, e.g. "TensorRT 7.1.3, Xavier (7.2)"
+std::string getTensorRTRuntimeVersion();
+
+#endif
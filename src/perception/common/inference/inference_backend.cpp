@@ -0,0 +1,56 @@
+#include "inference_backend.h"
+
+#include <atomic>
+#include <iostream>
+#include <cuda_runtime_api.h>
+
+#include "configs/config.h"
+
+static std::atomic<InferenceBackendType> inference_backend_type = {INFERENCE_BACKEND};
+
+void setInferenceBackendType(InferenceBackendType type) {
+    inference_backend_type = type;
+}
+
+InferenceBackendType getInferenceBackendType() {
+    return inference_backend_type;
+}
+
+bool parseInferenceBackendType(const std::string &name, InferenceBackendType &type) {
+    if (name == "auto") {
+        type = kInferenceBackendAuto;
+    } else if (name == "tensorrt") {
+        type = kInferenceBackendTensorRT;
+    } else if (name == "cpu") {
+        type = kInferenceBackendCPU;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+std::string getInferenceBackendTypeName(InferenceBackendType type) {
+    switch (type) {
+        case kInferenceBackendAuto: return "auto";
+        case kInferenceBackendTensorRT: return "tensorrt";
+        case kInferenceBackendCPU: return "cpu";
+    }
+    return "";
+}
+
+InferenceBackendType resolveInferenceBackendType(InferenceBackendType type) {
+    if (type != kInferenceBackendAuto) {
+        return type;
+    }
+    if (isCudaDeviceAvailable()) {
+        return kInferenceBackendTensorRT;
+    }
+    std::cout << "No CUDA device found. Using CPU inference." << std::endl;
+    return kInferenceBackendCPU;
+}
+
+bool isCudaDeviceAvailable() {
+    int n_devices = 0;
+    cudaError_t error = cudaGetDeviceCount(&n_devices);
+    return error == cudaSuccess && n_devices > 0;
+}
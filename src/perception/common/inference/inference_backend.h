@@ -0,0 +1,55 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <string>
+
+enum InferenceBackendType {
+    kInferenceBackendAuto,      // TensorRT if a CUDA device is found and the engine
+                                // can be loaded or built, else CPU
+    kInferenceBackendTensorRT,  // TensorRT engine on the GPU only
+    kInferenceBackendCPU,       // OpenCV DNN on the CPU only
+};
+
+// Number of output buffer sets of a backend, i.e. of requests that can be in
+// flight at the same time with AsyncInference
+const int kInferenceSlots = 2;
+
+// A network run by some inference engine.
+// Inputs and outputs are float tensors in host memory, in NCHW order.
+// Each slot has its own output buffers, so that the outputs of a request
+// can be read while the next one runs.
+// Backends are not thread-safe: use one backend from one thread at a time
+// (see AsyncInference to run it from a worker thread)
+class InferenceBackend {
+   public:
+    virtual ~InferenceBackend() {}
+
+    // Name for logs, e.g. "TensorRT" or "OpenCV DNN (CPU)"
+    virtual std::string getName() = 0;
+
+    // Run the network on batch_size images of input, writing the outputs
+    // to the buffers of slot (0 to kInferenceSlots - 1).
+    // Return false on failure
+    virtual bool infer(const float *input, int batch_size, int slot = 0) = 0;
+
+    // Host buffer of an output of the last infer() call on slot, in the order
+    // of the output names given to the backend
+    virtual const float *getOutput(int output_index, int slot = 0) = 0;
+};
+
+// Backend used by perception models when they are created.
+// Set it before creating ObjectDetector, LaneDetector or TrafficSignClassifier.
+// Default: INFERENCE_BACKEND in configs/config.h
+void setInferenceBackendType(InferenceBackendType type);
+InferenceBackendType getInferenceBackendType();
+
+// Parse "auto", "tensorrt" or "cpu". Return false if name is unknown
+bool parseInferenceBackendType(const std::string &name, InferenceBackendType &type);
+std::string getInferenceBackendTypeName(InferenceBackendType type);
+
+// Resolve kInferenceBackendAuto: TensorRT if a CUDA device is available, else CPU
+InferenceBackendType resolveInferenceBackendType(InferenceBackendType type);
+
+bool isCudaDeviceAvailable();
+
+#endif
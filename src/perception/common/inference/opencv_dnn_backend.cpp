@@ -0,0 +1,66 @@
+#include "opencv_dnn_backend.h"
+
+#include <iostream>
+
+using namespace std;
+
+OpenCVDnnBackend::OpenCVDnnBackend(const std::string &model_path, int input_channels,
+    int input_h, int input_w, const std::vector<std::string> &output_names) :
+    model_path(model_path), input_channels(input_channels),
+    input_h(input_h), input_w(input_w), output_names(output_names) {
+
+    cout << "Loading CPU model at: " << model_path << endl;
+    try {
+        net = cv::dnn::readNet(model_path);
+    } catch (const cv::Exception &e) {
+        cerr << "Error on loading model " << model_path << ": " << e.what() << endl;
+        return;
+    }
+    if (net.empty()) {
+        cerr << "Error on loading model: " << model_path << endl;
+        return;
+    }
+
+    net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    if (this->output_names.empty()) {
+        this->output_names = net.getUnconnectedOutLayersNames();
+    }
+    ready = true;
+}
+
+bool OpenCVDnnBackend::isReady() {
+    return ready;
+}
+
+std::string OpenCVDnnBackend::getName() {
+    return "OpenCV DNN (CPU)";
+}
+
+bool OpenCVDnnBackend::infer(const float *input, int batch_size, int slot) {
+    if (!ready) return false;
+
+    // Wrap the input without copying it
+    int sizes[] = {batch_size, input_channels, input_h, input_w};
+    cv::Mat blob(4, sizes, CV_32F, const_cast<float *>(input));
+
+    try {
+        net.setInput(blob);
+        net.forward(outputs[slot], output_names);
+    } catch (const cv::Exception &e) {
+        cerr << "Error on running model " << model_path << ": " << e.what() << endl;
+        return false;
+    }
+
+    // Outputs are read as raw buffers
+    for (cv::Mat &output : outputs[slot]) {
+        if (!output.isContinuous()) {
+            output = output.clone();
+        }
+    }
+    return true;
+}
+
+const float *OpenCVDnnBackend::getOutput(int output_index, int slot) {
+    return outputs[slot][output_index].ptr<float>();
+}
@@ -0,0 +1,42 @@
+#ifndef OPENCV_DNN_BACKEND_H
+#define OPENCV_DNN_BACKEND_H
+
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/dnn.hpp>
+
+#include "inference_backend.h"
+
+// Run a network on the CPU with OpenCV DNN.
+// Loads any model format read by cv::dnn::readNet()
+// (ONNX, TensorFlow frozen graph, ...)
+class OpenCVDnnBackend : public InferenceBackend {
+   private:
+    std::string model_path;
+    cv::dnn::Net net;
+    bool ready = false;
+
+    int input_channels;
+    int input_h;
+    int input_w;
+
+    std::vector<std::string> output_names;
+    std::vector<cv::Mat> outputs[kInferenceSlots];
+
+   public:
+    // output_names: names of the output layers, in the order used by
+    // getOutput(). Empty: all unconnected output layers of the network
+    OpenCVDnnBackend(const std::string &model_path, int input_channels,
+        int input_h, int input_w,
+        const std::vector<std::string> &output_names = std::vector<std::string>());
+
+    // False if the model could not be loaded
+    bool isReady();
+
+    std::string getName() override;
+    bool infer(const float *input, int batch_size, int slot = 0) override;
+    const float *getOutput(int output_index, int slot = 0) override;
+};
+
+#endif
@@ -0,0 +1,167 @@
+// Test of AsyncInference with a fake backend (no GPU needed).
+// Check that outputs of both slots are kept apart, that requests run in
+// submission order, and that preparing the next input overlaps inference.
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "async_inference.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// Output = 2 * input, after sleeping as long as a network would run
+class FakeBackend : public InferenceBackend {
+   private:
+    int volume;
+    int inference_ms;
+    std::vector<float> outputs[kInferenceSlots];
+
+   public:
+    std::vector<float> history;  // First input value of each request, in run order
+
+    FakeBackend(int volume, int inference_ms) : volume(volume), inference_ms(inference_ms) {
+        for (std::vector<float> &output : outputs) {
+            output.resize(volume);
+        }
+    }
+
+    std::string getName() override { return "Fake"; }
+
+    bool infer(const float *input, int batch_size, int slot = 0) override {
+        std::this_thread::sleep_for(milliseconds(inference_ms));
+        for (int i = 0; i < volume; ++i) {
+            outputs[slot][i] = 2 * input[i];
+        }
+        history.push_back(input[0]);
+        return input[0] >= 0;  // Negative inputs make inference fail
+    }
+
+    const float *getOutput(int output_index, int slot = 0) override {
+        return outputs[slot].data();
+    }
+};
+
+// Busy CPU work standing for the preprocessing of a frame
+void prepareInput(std::vector<float> &input, float value, int ms) {
+    steady_clock::time_point end = steady_clock::now() + milliseconds(ms);
+    while (steady_clock::now() < end) {
+    }
+    std::fill(input.begin(), input.end(), value);
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{frames         |50    | number of frames of the overlap test }"
+        "{inference_ms   |10    | time of a fake inference }"
+        "{preprocess_ms  |10    | time of a fake preprocessing }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("AsyncInference test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    int n_frames = parser.get<int>("frames");
+    int inference_ms = parser.get<int>("inference_ms");
+    int preprocess_ms = parser.get<int>("preprocess_ms");
+    const int volume = 16;
+    bool ok = true;
+
+    {
+        std::shared_ptr<FakeBackend> backend = std::make_shared<FakeBackend>(volume, inference_ms);
+        AsyncInference async_inference(backend);
+        std::vector<float> input_a(volume, 1), input_b(volume, 2), input_c(volume, -1);
+
+        // Two requests in flight, a third one is refused
+        int slot_a = async_inference.acquire();
+        async_inference.submit(slot_a, input_a.data(), 1);
+        int slot_b = async_inference.acquire();
+        async_inference.submit(slot_b, input_b.data(), 1);
+        ok &= check(slot_a >= 0 && slot_b >= 0 && slot_a != slot_b, "two free slots");
+        ok &= check(async_inference.acquire() == -1, "no third slot");
+
+        ok &= check(async_inference.wait(slot_b), "wait b");
+        ok &= check(async_inference.poll(slot_a), "a done before b");
+        ok &= check(async_inference.wait(slot_a), "wait a");
+        ok &= check(async_inference.getOutput(slot_a, 0)[volume - 1] == 2, "output of a");
+        ok &= check(async_inference.getOutput(slot_b, 0)[volume - 1] == 4, "output of b");
+        ok &= check(backend->history.size() == 2 && backend->history[0] == 1, "submission order");
+
+        // A released slot is reused, and failures are reported
+        async_inference.release(slot_a);
+        int slot_c = async_inference.acquire();
+        ok &= check(slot_c == slot_a, "released slot reused");
+        async_inference.submit(slot_c, input_c.data(), 1);
+        ok &= check(!async_inference.wait(slot_c), "failure reported");
+        ok &= check(async_inference.getOutput(slot_b, 0)[0] == 4, "output of b kept");
+        async_inference.release(slot_b);
+        async_inference.release(slot_c);
+        ok &= check(!async_inference.wait(slot_b), "wait on a free slot");
+
+        // Waiting for a slot released by another thread
+        slot_a = async_inference.acquire();
+        slot_b = async_inference.acquire();
+        std::thread releasing_thread([&async_inference, slot_b]() {
+            std::this_thread::sleep_for(milliseconds(20));
+            async_inference.release(slot_b);
+        });
+        int waited_slot = async_inference.acquire(true);
+        releasing_thread.join();
+        ok &= check(waited_slot == slot_b, "slot released by another thread");
+        async_inference.release(slot_a);
+        async_inference.release(waited_slot);
+    }
+
+    // Frame loop: sequential, then preparing frame N + 1 while frame N runs
+    std::shared_ptr<FakeBackend> backend = std::make_shared<FakeBackend>(volume, inference_ms);
+    std::vector<float> inputs[kInferenceSlots];
+    for (std::vector<float> &input : inputs) {
+        input.resize(volume);
+    }
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int frame = 0; frame < n_frames; ++frame) {
+        prepareInput(inputs[0], frame, preprocess_ms);
+        backend->infer(inputs[0].data(), 1);
+        ok &= check(backend->getOutput(0)[0] == 2 * frame, "sequential output");
+    }
+    double sequential_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0;
+
+    {
+        AsyncInference async_inference(backend);
+        begin = steady_clock::now();
+        int pending_slot = -1;
+        float pending_value = 0;
+        for (int frame = 0; frame < n_frames; ++frame) {
+            int slot = async_inference.acquire();
+            prepareInput(inputs[slot], frame, preprocess_ms);
+            async_inference.submit(slot, inputs[slot].data(), 1);
+
+            if (pending_slot >= 0) {
+                async_inference.wait(pending_slot);
+                ok &= check(async_inference.getOutput(pending_slot, 0)[0] == 2 * pending_value, "async output");
+                async_inference.release(pending_slot);
+            }
+            pending_slot = slot;
+            pending_value = frame;
+        }
+        async_inference.wait(pending_slot);
+        ok &= check(async_inference.getOutput(pending_slot, 0)[0] == 2 * pending_value, "last async output");
+        async_inference.release(pending_slot);
+    }
+    double async_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0;
+
+    cout << n_frames << " frames, preprocessing " << preprocess_ms << " ms, inference " << inference_ms << " ms" << endl;
+    cout << "  sequential: " << sequential_ms << " ms" << endl;
+    cout << "  async:      " << async_ms << " ms" << endl;
+    ok &= check(async_ms < 0.75 * sequential_ms, "preprocessing overlaps inference");
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,106 @@
+// Test of EngineCache (no GPU needed): model hashing, manifest and
+// rebuild decisions, on files in a temporary directory.
+
+#include <unistd.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "engine_cache.h"
+#include "utils/filesystem_include.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+void writeFile(const std::string &path, const std::string &content) {
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+}
+
+std::string readFile(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{dir            |      | directory for the test files (default: a temporary directory) }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("EngineCache test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    fs::path dir = parser.get<std::string>("dir");
+    if (dir.empty()) {
+        dir = fs::temp_directory_path() / ("test_engine_cache_" + std::to_string(getpid()));
+    }
+    fs::create_directories(dir);
+    std::string model_path = (dir / "model.uff").string();
+    std::string engine_path = (dir / "model.engine").string();
+    const std::string runtime = "TensorRT 7.1.3, Test GPU (7.2)";
+    bool ok = true;
+
+    // Hash of the content only
+    writeFile(model_path, "weights v1");
+    writeFile((dir / "copy.uff").string(), "weights v1");
+    std::string hash = EngineCache::hashFile(model_path);
+    ok &= check(hash.size() == 16, "hash size");
+    ok &= check(hash == EngineCache::hashFile((dir / "copy.uff").string()), "same content, same hash");
+    ok &= check(EngineCache::hashFile((dir / "missing.uff").string()).empty(), "no hash of a missing file");
+
+    {
+        EngineCache cache(engine_path, model_path, "FLOAT16", 1, runtime);
+        ok &= check(cache.getKey().model_hash == hash, "key has the model hash");
+        ok &= check(!cache.isValid(), "no engine yet");
+        ok &= check(cache.save("engine v1", 9), "save");
+        ok &= check(readFile(engine_path) == "engine v1", "engine written");
+        ok &= check(!fs::exists(engine_path + ".tmp") && !fs::exists(cache.getManifestPath() + ".tmp"),
+            "no temporary file left");
+    }
+
+    // Same model, precision, batch size and runtime: reused
+    ok &= check(EngineCache(engine_path, model_path, "FLOAT16", 1, runtime).isValid(), "engine reused");
+
+    // Any other key: rebuilt
+    ok &= check(!EngineCache(engine_path, model_path, "FLOAT32", 1, runtime).isValid(), "other precision");
+    ok &= check(!EngineCache(engine_path, model_path, "FLOAT16", 4, runtime).isValid(), "other batch size");
+    ok &= check(!EngineCache(engine_path, model_path, "FLOAT16", 1, "TensorRT 8.0.1, Test GPU (7.2)").isValid(),
+        "other runtime version");
+
+    // Model updated (same size, new content)
+    sleep(1);
+    writeFile(model_path, "weights v2");
+    {
+        EngineCache cache(engine_path, model_path, "FLOAT16", 1, runtime);
+        ok &= check(cache.getKey().model_hash != hash, "new model hash");
+        ok &= check(!cache.isValid(), "model changed");
+        ok &= check(cache.save("engine v2", 9), "save new engine");
+    }
+    ok &= check(EngineCache(engine_path, model_path, "FLOAT16", 1, runtime).isValid(), "new engine reused");
+    ok &= check(readFile(engine_path) == "engine v2", "new engine written");
+
+    // Damaged manifest, missing engine
+    EngineCache cache(engine_path, model_path, "FLOAT16", 1, runtime);
+    std::string manifest = readFile(cache.getManifestPath());
+    writeFile(cache.getManifestPath(), manifest.substr(0, manifest.size() / 2));
+    ok &= check(!cache.isValid(), "truncated manifest");
+    writeFile(cache.getManifestPath(), manifest);
+    ok &= check(cache.isValid(), "manifest restored");
+    cache.invalidate();
+    ok &= check(!fs::exists(engine_path) && !cache.isValid(), "invalidated");
+
+    // Model that can't be read
+    EngineCache missing_model(engine_path, (dir / "missing.uff").string(), "FLOAT16", 1, runtime);
+    ok &= check(!missing_model.isValid() && !missing_model.save("engine", 6), "missing model");
+
+    if (parser.get<std::string>("dir").empty()) {
+        fs::remove_all(dir);
+    }
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,190 @@
+#include "ctdetDecoder.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+#include <opencv2/core/hal/intrin.hpp>
+
+#include "ctdet_utils.h"
+
+static inline float Logist(float data) { return 1.f / (1.f + std::exp(-data)); }
+
+namespace {
+
+// A peak of the heatmap, before decoding its box
+struct Peak {
+    float prob;
+    float score;  // Logit of the heatmap
+    int cls;
+    int index;    // y * w + x
+};
+
+// Ranking of the detections: higher probability first, then lower class,
+// then first in row-major order
+inline bool isBetter(const Peak &a, const Peak &b) {
+    if (a.prob != b.prob) return a.prob > b.prob;
+    if (a.cls != b.cls) return a.cls < b.cls;
+    return a.index < b.index;
+}
+
+// Max of the kernel_size neighbours of each value of a row.
+// line has padding values of -FLT_MAX on both sides
+void rowMax(const float *line, float *dst, int w, int kernel_size) {
+    int x = 0;
+#if CV_SIMD128
+    for (; x <= w - 4; x += 4) {
+        cv::v_float32x4 m = cv::v_load(line + x);
+        for (int k = 1; k < kernel_size; ++k) {
+            m = cv::v_max(m, cv::v_load(line + x + k));
+        }
+        cv::v_store(dst + x, m);
+    }
+#endif
+    for (; x < w; ++x) {
+        float m = line[x];
+        for (int k = 1; k < kernel_size; ++k) {
+            m = std::max(m, line[x + k]);
+        }
+        dst[x] = m;
+    }
+}
+
+}  // namespace
+
+void CTdetforward_cpu(const float *hm, const float *reg, const float *wh, float *output,
+                      int w, int h, int classes, int kernel_size, float visthresh,
+                      int max_detections) {
+    int padding = (kernel_size - 1) / 2;
+    int stride = w * h;
+    output[0] = 0;
+    if (max_detections <= 0 || visthresh >= 1) {
+        return;
+    }
+
+    // The sigmoid is monotonic: threshold and max pool the logits, and only
+    // apply the sigmoid to the kept peaks
+    float thresh = visthresh > 0 ? std::log(visthresh / (1 - visthresh)) : -FLT_MAX;
+
+    // Max of each row (horizontal pass), then of each column of these maxima
+    // (vertical pass): a separable kernel_size x kernel_size max pool
+    thread_local std::vector<float> line;
+    thread_local std::vector<float> row_max;
+    thread_local std::vector<float> pooled;
+    line.assign(w + 2 * padding, -FLT_MAX);
+    row_max.resize(stride);
+    pooled.resize(w);
+
+    // Bounded heap of the best max_detections peaks. The worst one is on top
+    std::vector<Peak> heap;
+    heap.reserve(max_detections);
+
+    for (int cls = 0; cls < classes; ++cls) {
+        const float *cls_hm = hm + cls * stride;
+        for (int y = 0; y < h; ++y) {
+            std::copy(cls_hm + y * w, cls_hm + (y + 1) * w, line.begin() + padding);
+            rowMax(line.data(), row_max.data() + y * w, w, kernel_size);
+        }
+
+        for (int y = 0; y < h; ++y) {
+            int y_begin = std::max(y - padding, 0);
+            int y_end = std::min(y + padding, h - 1);
+            const float *row = cls_hm + y * w;
+
+            // Peaks are scanned in (class, index) order, so a later peak with
+            // a logit not above the one of the worst kept peak is never better
+            float min_score = thresh;
+            if (static_cast<int>(heap.size()) == max_detections) {
+                min_score = std::max(min_score, heap.front().score);
+            }
+
+            auto test_peak = [&](int x) {
+                float val = row[x];
+                if (val <= min_score || val != pooled[x]) return;
+
+                // Same tie rule as the CUDA kernel: the cell must be the first
+                // maximum of the window, x being the outer loop
+                for (int dx = -padding; dx <= 0; ++dx) {
+                    int cur_x = x + dx;
+                    if (cur_x < 0) continue;
+                    for (int dy = -padding; dy <= padding; ++dy) {
+                        if (dx == 0 && dy >= 0) break;
+                        int cur_y = y + dy;
+                        if (cur_y < 0 || cur_y >= h) continue;
+                        if (cls_hm[cur_y * w + cur_x] == val) return;
+                    }
+                }
+
+                Peak peak = {Logist(val), val, cls, y * w + x};
+                if (static_cast<int>(heap.size()) < max_detections) {
+                    heap.push_back(peak);
+                    std::push_heap(heap.begin(), heap.end(), isBetter);
+                } else {
+                    std::pop_heap(heap.begin(), heap.end(), isBetter);
+                    heap.back() = peak;
+                    std::push_heap(heap.begin(), heap.end(), isBetter);
+                }
+                if (static_cast<int>(heap.size()) == max_detections) {
+                    min_score = std::max(min_score, heap.front().score);
+                }
+            };
+
+            int x = 0;
+#if CV_SIMD128
+            for (; x <= w - 4; x += 4) {
+                cv::v_float32x4 m = cv::v_load(row_max.data() + y_begin * w + x);
+                for (int yy = y_begin + 1; yy <= y_end; ++yy) {
+                    m = cv::v_max(m, cv::v_load(row_max.data() + yy * w + x));
+                }
+                cv::v_store(pooled.data() + x, m);
+
+                // Most cells are neither a local maximum nor above the threshold
+                cv::v_float32x4 val = cv::v_load(row + x);
+                int mask = cv::v_signmask((val == m) & (val > cv::v_setall_f32(min_score)));
+                for (int i = 0; mask != 0; ++i, mask >>= 1) {
+                    if (mask & 1) test_peak(x + i);
+                }
+            }
+#endif
+            for (; x < w; ++x) {
+                float m = row_max[y_begin * w + x];
+                for (int yy = y_begin + 1; yy <= y_end; ++yy) {
+                    m = std::max(m, row_max[yy * w + x]);
+                }
+                pooled[x] = m;
+                test_peak(x);
+            }
+        }
+    }
+
+    std::sort(heap.begin(), heap.end(), isBetter);
+
+    Detection *detections = reinterpret_cast<Detection *>(output + 1);
+    for (size_t i = 0; i < heap.size(); ++i) {
+        const Peak &peak = heap[i];
+        int reg_index = peak.index;
+        int grid_x = reg_index % w;
+        int grid_y = reg_index / w;
+
+        Detection &det = detections[i];
+        float c_x = grid_x + reg[reg_index];
+        float c_y = grid_y + reg[reg_index + stride];
+        det.bbox.x1 = (c_x - wh[reg_index] / 2) * 4;
+        det.bbox.y1 = (c_y - wh[reg_index + stride] / 2) * 4;
+        det.bbox.x2 = (c_x + wh[reg_index] / 2) * 4;
+        det.bbox.y2 = (c_y + wh[reg_index + stride] / 2) * 4;
+        det.classId = peak.cls;
+        det.prob = peak.prob;
+    }
+
+    output[0] = static_cast<float>(heap.size());
+}
+
+void sortDetections(std::vector<Detection> &detections) {
+    std::sort(detections.begin(), detections.end(), [](const Detection &a, const Detection &b) {
+        if (a.prob != b.prob) return a.prob > b.prob;
+        if (a.classId != b.classId) return a.classId < b.classId;
+        if (a.bbox.y1 != b.bbox.y1) return a.bbox.y1 < b.bbox.y1;
+        return a.bbox.x1 < b.bbox.x1;
+    });
+}
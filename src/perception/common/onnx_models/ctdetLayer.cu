@@ -16,7 +16,8 @@ dim3 cudaGridSize(uint n)
 __device__ float Logist(float data){ return 1./(1. + exp(-data)); }
 
 __global__ void CTdetforward_kernel(const float *hm, const float *reg,const float *wh ,
-        float *output,const int w,const int h,const int classes,const int kernel_size,const float visthresh  ) {
+        float *output,const int w,const int h,const int classes,const int kernel_size,const float visthresh,
+        const int max_detections) {
     int idx = (blockIdx.x + blockIdx.y * gridDim.x) * blockDim.x + threadIdx.x;
     if (idx >= w * h * classes) return;
     int padding = (kernel_size - 1) / 2;
@@ -46,6 +47,7 @@ __global__ void CTdetforward_kernel(const float *hm, const float *reg,const floa
         if(idx == max_index){
             int resCount = (int) atomicAdd(output, 1);
             //printf("%d",resCount);
+            if (resCount >= max_detections) return;
             char *data = (char *) output + sizeof(float) + resCount * sizeof(Detection);
             Detection *det = (Detection *) (data);
             c_x = grid_x + reg[reg_index];
@@ -62,7 +64,8 @@ __global__ void CTdetforward_kernel(const float *hm, const float *reg,const floa
 
 
 __global__ void CTfaceforward_kernel(const float *hm, const float *wh,const float *reg,const float* landmarks,
-                                    float *output,const int w,const int h,const int classes,const int kernel_size,const float visthresh  ) {
+                                    float *output,const int w,const int h,const int classes,const int kernel_size,const float visthresh,
+                                    const int max_detections) {
     int idx = (blockIdx.x + blockIdx.y * gridDim.x) * blockDim.x + threadIdx.x;
     if (idx >= w*h*classes) return;
     int padding = (kernel_size-1)/2;
@@ -92,6 +95,7 @@ __global__ void CTfaceforward_kernel(const float *hm, const float *wh,const floa
         if(idx == max_index){
             int resCount = (int)atomicAdd(output,1);
             //printf("%d",resCount);
+            if (resCount >= max_detections) return;
             char* data = (char * )output + sizeof(float) + resCount*sizeof(Detection);
             Detection* det =  (Detection*)(data);
             c_x = (grid_x + reg[reg_index+stride] + 0.5)*4 ; c_y  = (grid_y + reg[reg_index] + 0.5) * 4;
@@ -112,13 +116,15 @@ __global__ void CTfaceforward_kernel(const float *hm, const float *wh,const floa
 
 
 void CTdetforward_gpu(const float *hm, const float *reg,const float *wh ,float *output,
-                      const int w,const int h,const int classes,const int kernerl_size, const float visthresh ){
+                      const int w,const int h,const int classes,const int kernerl_size, const float visthresh,
+                      const int max_detections ){
     uint num = w * h * classes;
-    CTdetforward_kernel<<<cudaGridSize(num),BLOCK>>>(hm,reg,wh,output,w,h,classes,kernerl_size,visthresh);
+    CTdetforward_kernel<<<cudaGridSize(num),BLOCK>>>(hm,reg,wh,output,w,h,classes,kernerl_size,visthresh,max_detections);
 }
 
 void CTfaceforward_gpu(const float *hm, const float *wh,const float *reg,const float* landmarks,float *output,
-                      const int w,const int h,const int classes,const int kernerl_size, const float visthresh ){
+                      const int w,const int h,const int classes,const int kernerl_size, const float visthresh,
+                      const int max_detections ){
     uint num = w * h * classes;
-    CTfaceforward_kernel<<<cudaGridSize(num),BLOCK>>>(hm,wh,reg,landmarks,output,w,h,classes,kernerl_size,visthresh);
+    CTfaceforward_kernel<<<cudaGridSize(num),BLOCK>>>(hm,wh,reg,landmarks,output,w,h,classes,kernerl_size,visthresh,max_detections);
 }
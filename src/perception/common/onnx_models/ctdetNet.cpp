@@ -7,6 +7,7 @@
 #include "ctdetNet.h"
 #include "ctdetLayer.h"
 #include "entroyCalibrator.h"
+#include "utils/mapped_file.h"
 
 static CTDetLogger gLogger;
 
@@ -30,7 +31,10 @@ namespace ctdet
         {
             std::string msg("failed to parse onnx file");
             gLogger.log(nvinfer1::ILogger::Severity::kERROR, msg.c_str());
-            exit(EXIT_FAILURE);
+            parser->destroy();
+            network->destroy();
+            builder->destroy();
+            return;
         }
 
         builder->setMaxBatchSize(maxBatchSize);
@@ -61,7 +65,11 @@ namespace ctdet
         if (!engine){
             std::string error_message ="Unable to create engine";
             gLogger.log(nvinfer1::ILogger::Severity::kERROR, error_message.c_str());
-            exit(-1);
+            delete calibrator;
+            parser->destroy();
+            network->destroy();
+            builder->destroy();
+            return;
         }
         std::cout << "End building engine..." << std::endl;
 
@@ -93,28 +101,25 @@ namespace ctdet
             mPlugins(nullptr)
     {
         using namespace std;
-        fstream file;
+        MappedFile file;
 
-        file.open(engineFile,ios::binary | ios::in);
-        if(!file.is_open())
+        if(!file.open(engineFile))
         {
             cout << "read engine file" << engineFile <<" failed" << endl;
             return;
         }
-        file.seekg(0, ios::end);
-        int length = file.tellg();
-        file.seekg(0, ios::beg);
-        std::unique_ptr<char[]> data(new char[length]);
-        file.read(data.get(), length);
-
-        file.close();
+        file.adviseSequential();
 
         mPlugins = nvonnxparser::createPluginFactory(gLogger);
         std::cout << "deserializing" << std::endl;
         mRunTime = nvinfer1::createInferRuntime(gLogger);
         assert(mRunTime != nullptr);
-        mEngine = mRunTime->deserializeCudaEngine(data.get(), length, mPlugins);
-        assert(mEngine != nullptr);
+        mEngine = mRunTime->deserializeCudaEngine(file.getData(), file.getSize(), mPlugins);
+        if (mEngine == nullptr)
+        {
+            cout << "deserializing engine file " << engineFile << " failed" << endl;
+            return;
+        }
         InitEngine();
     }
 
@@ -138,9 +143,13 @@ namespace ctdet
             mBindBufferSizes[i] = totalSize;
             mCudaBuffers[i] = safeCudaMalloc(totalSize);
         }
-        outputBufferSize = mBindBufferSizes[1] * 6 ;
+        // Count, then at most maxDetections detections
+        outputBufferSize = sizeof(float) + maxDetections * sizeof(Detection);
         cudaOutputBuffer = safeCudaMalloc(outputBufferSize);
+        for (auto& buffer : hostOutputBuffer)
+            buffer.reset(new float[outputBufferSize / sizeof(float)]);
         CUDA_CHECK(cudaStreamCreate(&mCudaStream));
+        ready = true;
     }
 
     void ctdetNet::doInference(const void *inputData, void *outputData)
@@ -149,36 +158,46 @@ namespace ctdet
         int inputIndex = 0 ;
         CUDA_CHECK(cudaMemcpyAsync(mCudaBuffers[inputIndex], inputData, mBindBufferSizes[inputIndex], cudaMemcpyHostToDevice, mCudaStream));
         mContext->execute(batchSize, &mCudaBuffers[inputIndex]);
-        CUDA_CHECK(cudaMemset(cudaOutputBuffer, 0, sizeof(float)));
+        CUDA_CHECK(cudaMemsetAsync(cudaOutputBuffer, 0, sizeof(float), mCudaStream));
         if (forwardFace){
             CTfaceforward_gpu(static_cast<const float *>(mCudaBuffers[1]),static_cast<const float *>(mCudaBuffers[2]),
                               static_cast<const float *>(mCudaBuffers[3]),static_cast<const float *>(mCudaBuffers[4]),static_cast<float *>(cudaOutputBuffer),
-                              input_w/4,input_h/4,classNum,kernelSize,visThresh);
+                              input_w/4,input_h/4,classNum,kernelSize,visThresh,maxDetections);
         } else{
             CTdetforward_gpu(static_cast<const float *>(mCudaBuffers[1]),static_cast<const float *>(mCudaBuffers[2]),
                          static_cast<const float *>(mCudaBuffers[3]),static_cast<float *>(cudaOutputBuffer),
-                             input_w/4,input_h/4,classNum,kernelSize,visThresh);
+                             input_w/4,input_h/4,classNum,kernelSize,visThresh,maxDetections);
         }
 
-        CUDA_CHECK(cudaMemcpyAsync(outputData, cudaOutputBuffer, outputBufferSize, cudaMemcpyDeviceToHost, mCudaStream));
+        // Read the count first, then copy only the detections that exist
+        float* hostOutput = static_cast<float *>(outputData);
+        CUDA_CHECK(cudaMemcpyAsync(hostOutput, cudaOutputBuffer, sizeof(float), cudaMemcpyDeviceToHost, mCudaStream));
+        CUDA_CHECK(cudaStreamSynchronize(mCudaStream));
+        int numDet = std::min(static_cast<int>(hostOutput[0]), maxDetections);
+        hostOutput[0] = static_cast<float>(numDet);
+        if (numDet > 0) {
+            CUDA_CHECK(cudaMemcpyAsync(hostOutput + 1, static_cast<float *>(cudaOutputBuffer) + 1, numDet * sizeof(Detection),
+                                       cudaMemcpyDeviceToHost, mCudaStream));
+        }
 
         runIters++ ;
     }
-    void ctdetNet::saveEngine(const std::string &fileName)
+    bool ctdetNet::infer(const float *input, int batch_size, int slot)
     {
-        if(mEngine)
-        {
-            nvinfer1::IHostMemory* data = mEngine->serialize();
-            std::ofstream file;
-            file.open(fileName,std::ios::binary | std::ios::out);
-            if(!file.is_open())
-            {
-                std::cout << "read create engine file" << fileName <<" failed" << std::endl;
-                return;
-            }
-            file.write((const char*)data->data(), data->size());
-            file.close();
-        }
+        if (!ready || batch_size != 1) return false;
+        doInference(input, hostOutputBuffer[slot].get());
+        return cudaStreamSynchronize(mCudaStream) == cudaSuccess;
+    }
 
+    bool ctdetNet::saveEngine(EngineCache& engineCache)
+    {
+        if(!mEngine)
+            return false;
+        nvinfer1::IHostMemory* data = mEngine->serialize();
+        if(!data)
+            return false;
+        bool saved = engineCache.save(data->data(), data->size());
+        data->destroy();
+        return saved;
     }
-}
\ No newline at end of file
+}
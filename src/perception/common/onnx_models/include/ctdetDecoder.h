@@ -0,0 +1,30 @@
+#ifndef CTDET_DECODER_H
+#define CTDET_DECODER_H
+
+#include <vector>
+
+struct Detection;
+
+// CPU version of CTdetforward_gpu(), for backends without CUDA.
+// Decode the heads of CenterNet (heatmap logits, center offsets, box sizes,
+// each planar with w * h values per channel) into detections in
+// network input coordinates.
+// A detection is a cell above visthresh (after sigmoid) which is the maximum
+// of its kernel_size x kernel_size window, as in the CUDA kernel.
+// Only the max_detections best ones are kept, and unlike the CUDA kernel
+// they are written in a deterministic order: highest probability first,
+// then lowest class id, then first cell in row-major order.
+// output has the same layout as the output of CTdetforward_gpu():
+// the number of detections as a float, then the Detection structs
+void CTdetforward_cpu(const float *hm, const float *reg, const float *wh, float *output,
+                      int w, int h, int classes, int kernel_size, float visthresh,
+                      int max_detections);
+
+// Sort detections in the order of CTdetforward_cpu(), using the box
+// position for cells of equal probability and class. Used to make the
+// order of the output of the CUDA kernel reproducible. This does not make
+// its content reproducible: above max_detections peaks, the kernel keeps
+// the first ones written by its threads, not the best ones
+void sortDetections(std::vector<Detection> &detections);
+
+#endif
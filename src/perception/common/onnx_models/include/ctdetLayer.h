@@ -5,8 +5,13 @@
 #ifndef CTDET_TRT_CTDETLAYER_H
 #define CTDET_TRT_CTDETLAYER_H
 
+// output: the number of detections as a float, then the Detection structs.
+// Only the first max_detections detections are written, but the count
+// is not capped: clamp it when reading the output
 void CTdetforward_gpu(const float *hm, const float *reg,const float *wh ,float *output,
-                      const int w,const int h,const int classes,const int kernerl_size,const float visthresh  );
+                      const int w,const int h,const int classes,const int kernerl_size,const float visthresh,
+                      const int max_detections );
 void CTfaceforward_gpu(const float *hm, const float *wh,const float *reg,const float* landmarks,float *output,
-                       const int w,const int h,const int classes,const int kernerl_size, const float visthresh );
+                       const int w,const int h,const int classes,const int kernerl_size, const float visthresh,
+                       const int max_detections );
 #endif //CTDET_TRT_CTDETLAYER_H
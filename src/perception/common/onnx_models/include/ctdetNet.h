@@ -9,11 +9,14 @@
 #include <string>
 #include <algorithm>
 #include <numeric>
+#include <memory>
 #include "NvInferPlugin.h"
 #include "NvOnnxParser.h"
 #include "configs/config_object_detection.h"
 #include "ctdet_utils.h"
 #include "NvOnnxParserRuntime.h"
+#include "perception/common/inference/engine_cache.h"
+#include "perception/common/inference/inference_backend.h"
 
 namespace ctdet
 {
@@ -24,7 +27,9 @@ namespace ctdet
         INT8    = 2
     };
 
-    class ctdetNet
+    // TensorRT backend of CenterNet. The heads are decoded on the GPU:
+    // getOutput(0) has the layout of the output of CTdetforward_gpu()
+    class ctdetNet : public InferenceBackend
     {
     public:
         ctdetNet(const std::string& onnxFile,
@@ -34,25 +39,38 @@ namespace ctdet
         ctdetNet(const std::string& engineFile);
 
         ~ctdetNet(){
-            cudaStreamSynchronize(mCudaStream);
-            cudaStreamDestroy(mCudaStream);
+            if(ready){
+                cudaStreamSynchronize(mCudaStream);
+                cudaStreamDestroy(mCudaStream);
+            }
             for(auto& item : mCudaBuffers)
                 cudaFree(item);
             cudaFree(cudaOutputBuffer);
-            if(!mRunTime)
-                mRunTime->destroy();
-            if(!mContext)
+            if(mContext)
                 mContext->destroy();
-            if(!mEngine)
+            if(mEngine)
                 mEngine->destroy();
-            if(!mPlugins)
+            if(mRunTime)
+                mRunTime->destroy();
+            if(mPlugins)
                 mPlugins->destroy();
         }
 
-        void saveEngine(const std::string& fileName);
+        // False if the engine could not be built or loaded
+        bool isReady() { return ready; }
+
+        // Write the engine to the file of engineCache, with its manifest
+        bool saveEngine(EngineCache& engineCache);
 
+        // outputData holds outputBufferSize bytes. Only the count and the
+        // detections that exist are copied back; the copy of the detections
+        // is asynchronous (synchronize mCudaStream or use infer())
         void doInference(const void* inputData, void* outputData);
 
+        std::string getName() override { return "TensorRT"; }
+        bool infer(const float *input, int batch_size, int slot = 0) override;
+        const float *getOutput(int output_index, int slot = 0) override { return hostOutputBuffer[slot].get(); }
+
         void printTime()
         {
             mProfiler.printTime(runIters) ;
@@ -66,6 +84,8 @@ namespace ctdet
         bool forwardFace;
     private:
 
+        bool ready = false;
+
         void InitEngine();
 
         nvinfer1::IExecutionContext* mContext;
@@ -77,7 +97,8 @@ namespace ctdet
         nvonnxparser::IPluginFactory *mPlugins;
         std::vector<void*> mCudaBuffers;
         std::vector<int64_t> mBindBufferSizes;
-        void * cudaOutputBuffer;
+        void * cudaOutputBuffer = nullptr;
+        std::unique_ptr<float[]> hostOutputBuffer[kInferenceSlots];
 
         cudaStream_t mCudaStream;
 
@@ -139,6 +139,11 @@ struct Detection {
     landmarks marks[5];
 };
 
+// Letterbox img (BGR) into the network input and write it normalized,
+// as planar floats (CHW), into input_data in a single pass.
+// input_data is owned by the caller (ctdet::channel * input_h * input_w floats)
+// and can be reused between frames
+extern void prepareImage(const cv::Mat& img, const bool& forwardFace, float* input_data);
 extern std::vector<float> prepareImage(cv::Mat& img, const bool& forwardFace);
 extern void postProcess(std::vector<Detection> & result,const cv::Mat& img, const bool& forwardFace);
 extern void postProcess(std::vector<Detection> & result,const int &img_w ,const int& img_h, const bool& forwardFace);
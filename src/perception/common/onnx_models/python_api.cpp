@@ -20,16 +20,20 @@ void setDevice(int id)
 detResult predict(void* net, void * inputData,int img_w,int img_h)
 {
 
-    int outputCount = ((ctdet::ctdetNet*)net)->outputBufferSize;
-    std::unique_ptr<float[]> outputData(new float[outputCount]);
-    ((ctdet::ctdetNet*)net)->doInference(inputData,outputData.get());
-    auto output = outputData.get();
+    // Use the output buffer of the net, instead of a new one per call
+    ctdet::ctdetNet* ctdet_net = (ctdet::ctdetNet*)net;
+    detResult det;
+    if (!ctdet_net->infer(static_cast<const float*>(inputData), 1)) {
+        det.num = 0;
+        det.det = nullptr;
+        return det;
+    }
+    const float* outputData = ctdet_net->getOutput(0);
     int num_det = static_cast<int>(outputData[0]);
     std::vector<Detection> result;
     result.resize(num_det);
     memcpy(result.data(), &outputData[1], num_det * sizeof(Detection));
-    postProcess(result,img_w,img_h,((ctdet::ctdetNet*)net)->forwardFace);
-    detResult det;
+    postProcess(result,img_w,img_h,ctdet_net->forwardFace);
     det.num=result.size();
     det.det =(Detection*)malloc(result.size()*sizeof(Detection));
     memcpy(det.det,result.data(),result.size()*sizeof(Detection));
@@ -3,48 +3,66 @@
 //
 #include "ctdet_utils.h"
 #include "configs/config_object_detection.h"
+#include <algorithm>
 #include <sstream>
+#include "tensor_packing.h"
 
 
-std::vector<float> prepareImage(cv::Mat& img, const bool& forwardFace)
+void prepareImage(const cv::Mat& img, const bool& forwardFace, float* input_data)
 {
+    CV_Assert(img.type() == CV_8UC3 && ctdet::channel == 3);
 
-
-    int channel = ctdet::channel ;
     int input_w = ctdet::input_w;
     int input_h = ctdet::input_h;
     float scale = cv::min(float(input_w)/img.cols,float(input_h)/img.rows);
     auto scaleSize = cv::Size(img.cols * scale,img.rows * scale);
 
+    // Images already fitted into the input (e.g. by PreprocessCache)
+    // are only padded. The resize buffer is reused by each thread
+    static thread_local cv::Mat resize_buffer;
     cv::Mat resized;
-    cv::resize(img, resized,scaleSize,0,0);
-
-
-    cv::Mat cropped = cv::Mat::zeros(input_h,input_w,CV_8UC3);
-    cv::Rect rect((input_w- scaleSize.width)/2, (input_h-scaleSize.height)/2, scaleSize.width,scaleSize.height);
-
-    resized.copyTo(cropped(rect));
-
-
-    cv::Mat img_float;
-    if(forwardFace)
-        cropped.convertTo(img_float, CV_32FC3, 1.);
-    else
-        cropped.convertTo(img_float, CV_32FC3,1./255.);
+    if (scaleSize == img.size()) {
+        resized = img;
+    } else {
+        cv::resize(img, resize_buffer, scaleSize, 0, 0);
+        resized = resize_buffer;
+    }
 
-    //HWC TO CHW
-    std::vector<cv::Mat> input_channels(channel);
-    cv::split(img_float, input_channels);
+    // (pixel * pixel_scale - mean) / std as one multiply-add.
+    // Padding is black, so it is filled with the normalized value of 0
+    float pixel_scale = forwardFace ? 1.f : 1.f / 255.f;
+    float alpha[3], beta[3];
+    for (int i = 0; i < 3; ++i) {
+        alpha[i] = pixel_scale / ctdet::std[i];
+        beta[i] = -ctdet::mean[i] / ctdet::std[i];
+    }
 
-    // normalize
-    std::vector<float> result(input_h*input_w*channel);
-    auto data = result.data();
     int channelLength = input_h * input_w;
-    for (int i = 0; i < channel; ++i) {
-        cv::Mat normed_channel = (input_channels[i]-ctdet::mean[i])/ctdet::std[i];
-        memcpy(data,normed_channel.data,channelLength*sizeof(float));
-        data += channelLength;
+    float *planes[3] = {input_data, input_data + channelLength, input_data + 2 * channelLength};
+    int left = (input_w - scaleSize.width) / 2;
+    int top = (input_h - scaleSize.height) / 2;
+    int right = left + scaleSize.width;
+    int bottom = top + scaleSize.height;
+
+    for (int y = 0; y < input_h; ++y) {
+        float *rows[3] = {planes[0] + y * input_w, planes[1] + y * input_w, planes[2] + y * input_w};
+        if (y < top || y >= bottom) {
+            for (int i = 0; i < 3; ++i) std::fill(rows[i], rows[i] + input_w, beta[i]);
+            continue;
+        }
+        for (int i = 0; i < 3; ++i) {
+            std::fill(rows[i], rows[i] + left, beta[i]);
+            std::fill(rows[i] + right, rows[i] + input_w, beta[i]);
+        }
+        normalizeRow(resized.ptr<uchar>(y - top), scaleSize.width, alpha, beta,
+            rows[0] + left, rows[1] + left, rows[2] + left);
     }
+}
+
+std::vector<float> prepareImage(cv::Mat& img, const bool& forwardFace)
+{
+    std::vector<float> result(ctdet::input_h * ctdet::input_w * ctdet::channel);
+    prepareImage(img, forwardFace, result.data());
     return result;
 }
 
@@ -18,56 +18,81 @@
 #include "buffers.h"
 #include "common.h"
 #include "logger.h"
+#include "tensor_packing.h"
+
+ClassificationNet::ClassificationNet(const UffModelParams& params): mParams(params) {
+    if (mParams.classListFile != "") {
+        if (UffModel::readClassListFile(mParams.classListFile, mParams.classes) != 0) {
+            cerr << "Error on loading class list: " << mParams.classListFile
+                 << endl;
+            return;
+        }
+        mParams.nClasses = mParams.classes.size();
+    }
 
-ClassificationNet::ClassificationNet(const UffModelParams& params): UffModel(params) {}
+    for (std::vector<float>& input_buffer : input_buffers) {
+        input_buffer.resize(mParams.batchSize * 3 * mParams.inputH * mParams.inputW);
+    }
+    backend = createUffModelBackend(mParams);
+    if (backend) {
+        cout << "ClassificationNet backend: " << backend->getName() << endl;
+        async_inference = std::unique_ptr<AsyncInference>(new AsyncInference(backend));
+    }
+}
+
+bool ClassificationNet::isReady() {
+    return backend != nullptr;
+}
 
-// Reads the input, pre-process, and stores in managed buffer
-bool ClassificationNet::processInput(const samplesCommon::BufferManager& buffers, const std::vector<cv::Mat> & imgs) {
+// Reads the input, pre-process, and stores in the input buffer of a slot
+int ClassificationNet::submitInput(const std::vector<cv::Mat> & imgs) {
     const int inputH = mParams.inputH;
     const int inputW = mParams.inputW;
     const int batchSize = imgs.size();
 
-    // put data into buffer
-    float* hostDataBuffer =
-        static_cast<float*>(buffers.getHostBuffer(mParams.inputTensorNames[0]));
-
-    int volChl = inputH * inputW;
-    int volImg = volChl * 3;
-    for (int i = 0; i < batchSize; ++i) {
-
-        cv::Mat resized_img;
-        cv::resize(imgs[i], resized_img, cv::Size(inputW, inputH));
-        resized_img.convertTo(resized_img, CV_32FC3, 1.0/255);
+    if (!async_inference || batchSize > mParams.batchSize) {
+        return -1;
+    }
 
-        for (int x = 0; x < inputW; ++x) {
-            for (int y = 0; y < inputH; ++y) {
-                cv::Vec3f intensity = resized_img.at<cv::Vec3f>(y, x);
+    int slot = async_inference->acquire();
+    if (slot < 0) {
+        return -1;
+    }
 
-                int j = y * inputH + x;
+    // put data into buffer
+    float* hostDataBuffer = input_buffers[slot].data();
 
-                hostDataBuffer[i * volImg + 0 * volChl + j] = float(intensity.val[2]);
-                hostDataBuffer[i * volImg + 1 * volChl + j] = float(intensity.val[1]);
-                hostDataBuffer[i * volImg + 2 * volChl + j] = float(intensity.val[0]);
-            }
-        }
+    // Crops are resized straight into their batch slot
+    for (int i = 0; i < batchSize; ++i) {
+        resizeImageToTensor(imgs[i], cv::Size(inputW, inputH), hostDataBuffer, i, true, 1.0f / 255);
     }
 
-    return true;
+    batch_sizes[slot] = batchSize;
+    async_inference->submit(slot, hostDataBuffer, batchSize);
+    return slot;
 }
 
 // Process output and verify result
-bool ClassificationNet::processOutput(const samplesCommon::BufferManager& buffers, std::vector<int> & labels, int n_samples, float threshold) {
+bool ClassificationNet::waitOutput(int slot, std::vector<int> & labels, float threshold,
+                                   std::vector<float>* confidences) {
+    int n_samples = batch_sizes[slot];
+    if (!async_inference->wait(slot)) {
+        async_inference->release(slot);
+        labels.insert(labels.end(), n_samples, -1);
+        if (confidences) confidences->insert(confidences->end(), n_samples, 0);
+        return false;
+    }
 
-    const float* out_buff = static_cast<float*>(
-        buffers.getHostBuffer(mParams.outputTensorNames[0]));
+    const float* out_buff = async_inference->getOutput(slot, 0);
 
     for (int batch = 0; batch < n_samples; ++batch) {
+        const float* probs = out_buff + batch * mParams.nClasses;
         int label = -1;
         float max_prob = 0.0;
         for (int i = 0; i < mParams.nClasses; ++i) {
-            if (out_buff[i] > max_prob) {
+            if (probs[i] > max_prob) {
                 label = i;
-                max_prob = out_buff[batch * mParams.nClasses + i];
+                max_prob = probs[i];
             }
         }
 
@@ -76,43 +101,50 @@ bool ClassificationNet::processOutput(const samplesCommon::BufferManager& buffer
         }
 
         labels.push_back(label);
+        if (confidences) confidences->push_back(max_prob);
     }
 
+    async_inference->release(slot);
     return true;
 }
 
-// Runs the TensorRT inference engine
+// Runs the inference backend
 // This function is the main execution function
-// It allocates the buffer, sets inputs and executes the engine
+// It sets inputs and executes the engine
 bool ClassificationNet::infer(const std::vector<cv::Mat>& input_imgs, std::vector<int>& labels, float threshold) {
 
-    if (!processInput(*buffers, input_imgs)) {
+    int slot = submitInput(input_imgs);
+    if (slot < 0) {
         cout << "Processing input failed" << endl;
         return false;
     }
 
-    // Memcpy from host input buffers to device input buffers
-    buffers->copyInputToDevice();
-
-    bool status = context->execute(input_imgs.size(),
-                                   buffers->getDeviceBindings().data());
-    if (!status) {
-        cout << "CUDA execution failed" << endl;
+    if (!waitOutput(slot, labels, threshold)) {
+        cout << "Inference failed" << endl;
         return false;
     }
 
-    // Memcpy from device output buffers to host output buffers
-    buffers->copyOutputToHost();
+    return true;
+}
 
-    // Post-process output
-    if (!processOutput(*buffers, labels, input_imgs.size(), threshold)) {
-        cout << "Processing output failed" << endl;
+bool ClassificationNet::submit(const std::vector<cv::Mat>& input_imgs) {
+    int slot = submitInput(input_imgs);
+    if (slot < 0) {
         return false;
     }
-
+    pending_slots.push_back(slot);
     return true;
 }
 
+bool ClassificationNet::wait(std::vector<int>& labels, float threshold, std::vector<float>* confidences) {
+    if (pending_slots.empty()) {
+        return false;
+    }
+    int slot = pending_slots.front();
+    pending_slots.pop_front();
+    return waitOutput(slot, labels, threshold, confidences);
+}
+
 std::string ClassificationNet::getClassName(int class_id) {
     for (size_t i = 0; i < mParams.classes.size(); ++i) {
         if (mParams.classes[i].id == class_id) {
@@ -13,6 +13,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 #include <sstream>
+#include <deque>
 
 #include "../common/include/BatchStream.h"
 #include "../common/include/EntropyCalibrator.h"
@@ -21,25 +22,51 @@
 #include "../common/include/common.h"
 #include "../common/include/logger.h"
 #include "../common/include/uff_model.h"
+#include "perception/common/inference/async_inference.h"
 
 #include "utils/filesystem_include.h"
 
-struct ClassificationNet : UffModel {
+struct ClassificationNet {
    public:
     ClassificationNet(const UffModelParams& params);
 
-    // Run the TensorRT inference engine
+    // False if no inference backend could be created
+    bool isReady();
+
+    // Run the network on at most mParams.batchSize images
     bool infer(const std::vector<cv::Mat>& input_imgs, std::vector<int>& labels, float threshold);
 
+    // Asynchronous inference, with up to kInferenceSlots batches in flight:
+    // the next batch can be prepared and submitted while the network runs.
+    // submit() returns false if all slots are in use.
+    // wait() appends the labels of the oldest submitted batch
+    // (-1 for each image if inference failed), and their probabilities
+    // to confidences if not null
+    bool submit(const std::vector<cv::Mat>& input_imgs);
+    bool wait(std::vector<int>& labels, float threshold, std::vector<float>* confidences = nullptr);
+
     std::string getClassName(int class_id);
 
    private:
-    // Put input to buffer
-    bool processInput(const samplesCommon::BufferManager& buffers, 
-                        const std::vector<cv::Mat> &imgs);
+    UffModelParams mParams;
+    std::shared_ptr<InferenceBackend> backend;
+    std::unique_ptr<AsyncInference> async_inference;
+
+    // Network input (NCHW, mParams.batchSize images) and number of images
+    // of each slot
+    std::vector<float> input_buffers[kInferenceSlots];
+    int batch_sizes[kInferenceSlots];
+
+    // Slots submitted by submit() and not waited for yet, oldest first
+    std::deque<int> pending_slots;
+
+    // Put input to the buffer of a free slot and start inference.
+    // Return the slot, or -1 on failure
+    int submitInput(const std::vector<cv::Mat> &imgs);
 
-    // Process the output
-    bool processOutput(const samplesCommon::BufferManager& buffers, std::vector<int> & labels, int n_samples, float threshold);
+    // Wait for the inference of slot, process the output and release the slot
+    bool waitOutput(int slot, std::vector<int> & labels, float threshold,
+                    std::vector<float>* confidences = nullptr);
 
 };
 
@@ -0,0 +1,31 @@
+#ifndef TENSOR_PACKING_H
+#define TENSOR_PACKING_H
+
+#include <opencv2/core.hpp>
+
+// Normalize one row of width BGR pixels into three planes:
+// dst_c[x] = src[3 * x + c] * alpha[c] + beta[c].
+// Converted with SIMD (NEON / SSE), 16 pixels at a time
+void normalizeRow(const uchar* src, int width, const float* alpha, const float* beta,
+                  float* dst0, float* dst1, float* dst2);
+
+// Pack a BGR image (CV_8UC3) into the planar (CHW) float input of a network:
+// tensor[c][y][x] = pixel value of channel c * scale + offset.
+// Channels are written in RGB order if swap_rb is set, else in BGR order.
+// img must already have the input size of the network (any shape).
+// The image is written at batch_index in buffer, i.e. at
+// buffer + batch_index * 3 * img.rows * img.cols.
+// Rows are read in memory order and converted with SIMD (NEON / SSE)
+void packImageToTensor(const cv::Mat& img, float* buffer, int batch_index,
+                       bool swap_rb, float scale, float offset = 0);
+
+// Resize a BGR image (CV_8UC3) to size and pack it like packImageToTensor(),
+// in one pass: each tensor value is sampled bilinearly from img, with the
+// pixel centers of cv::resize (INTER_LINEAR). Values may differ from
+// cv::resize + packImageToTensor() by the rounding of cv::resize to 8 bits.
+// img may be a ROI of a larger image (e.g. a crop of an object): it is
+// read in place, without any intermediate image
+void resizeImageToTensor(const cv::Mat& img, cv::Size size, float* buffer, int batch_index,
+                         bool swap_rb, float scale, float offset = 0);
+
+#endif
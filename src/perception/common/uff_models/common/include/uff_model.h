@@ -23,6 +23,8 @@
 #include "logger.h"
 #include "filesystem_include.h"
 #include "object_class.h"
+#include "perception/common/inference/engine_cache.h"
+#include "perception/common/inference/inference_backend.h"
 
 struct UffModelParams {
     int inputW;
@@ -36,6 +38,10 @@ struct UffModelParams {
     std::string engineFilePath;
     std::string uffFilePath;
 
+    // Model for the CPU backend (a format read by OpenCV DNN,
+    // e.g. the frozen TensorFlow graph the UFF file was made from)
+    std::string cpuModelFilePath;
+
     int dlaCore{-1};
 
     bool int8{false};  //!< Allow runnning the network in Int8 mode.
@@ -47,20 +53,28 @@ struct UffModelParams {
     std::vector<std::string> outputTensorNames;
 };
 
-struct UffModel {
+// TensorRT backend of a UFF model
+struct UffModel : InferenceBackend {
 
    public:
     template <typename T>
     using SampleUniquePtr = std::unique_ptr<T, samplesCommon::InferDeleter>;
 
     nvinfer1::Dims mInputDims;
-    std::shared_ptr<samplesCommon::BufferManager> buffers;
+    // Host and device buffers of each slot. The execution context is shared
+    std::shared_ptr<samplesCommon::BufferManager> buffers[kInferenceSlots];
 
    public:
     UffModel(const UffModelParams& params);
 
+    // False if the engine could not be loaded or built
+    bool isReady();
+
+    std::string getName() override;
+
     // Run the TensorRT inference engine
-    bool infer(const cv::Mat& input_img, cv::Mat& output_img);
+    bool infer(const float* input, int batch_size, int slot = 0) override;
+    const float* getOutput(int output_index, int slot = 0) override;
 
     // Build network from uff file
     bool build();
@@ -81,8 +95,8 @@ struct UffModel {
     // Read engine file and creates a TensorRT network
     bool loadEngine();
 
-    // Save engine to file
-    bool saveEngine(const std::string& fileName,
+    // Save engine to its file, with the manifest of engineCache
+    bool saveEngine(EngineCache& engineCache,
                 std::ostream& err);
 
     // Create execution context
@@ -90,13 +104,21 @@ struct UffModel {
 
     // Read class list from file
     // Return 0 if success, otherwise return a positive number
-    int readClassListFile(const std::string & class_list_file, std::vector<ObjectClass> &classes);
+    static int readClassListFile(const std::string & class_list_file, std::vector<ObjectClass> &classes);
 
    private:
-    std::string& ltrim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
-    std::string& rtrim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
-    std::string& trim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
+    bool ready = false;
+
+    static std::string& ltrim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
+    static std::string& rtrim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
+    static std::string& trim(std::string& str, const std::string& chars = "\t\n\v\f\r ");
 
 };
 
+// Create the backend of a UFF model, as selected by getInferenceBackendType().
+// In auto mode, fall back to the CPU backend if the TensorRT engine
+// cannot be loaded or built.
+// Return nullptr if no backend could be created
+std::shared_ptr<InferenceBackend> createUffModelBackend(const UffModelParams& params);
+
 #endif
\ No newline at end of file
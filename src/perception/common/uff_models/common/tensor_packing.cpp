@@ -0,0 +1,134 @@
+#include "tensor_packing.h"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+void normalizeRow(const uchar* src, int width, const float* alpha, const float* beta,
+                  float* dst0, float* dst1, float* dst2) {
+    int x = 0;
+#if CV_SIMD128
+    // OpenCV universal intrinsics are compiled to NEON on ARM and SSE on x86
+    const cv::v_float32x4 alpha0 = cv::v_setall_f32(alpha[0]), beta0 = cv::v_setall_f32(beta[0]);
+    const cv::v_float32x4 alpha1 = cv::v_setall_f32(alpha[1]), beta1 = cv::v_setall_f32(beta[1]);
+    const cv::v_float32x4 alpha2 = cv::v_setall_f32(alpha[2]), beta2 = cv::v_setall_f32(beta[2]);
+    auto store = [](const cv::v_uint8x16& v, const cv::v_float32x4& a, const cv::v_float32x4& b, float* dst) {
+        cv::v_uint16x8 v16_lo, v16_hi;
+        cv::v_expand(v, v16_lo, v16_hi);
+        cv::v_uint32x4 v32[4];
+        cv::v_expand(v16_lo, v32[0], v32[1]);
+        cv::v_expand(v16_hi, v32[2], v32[3]);
+        for (int i = 0; i < 4; ++i) {
+            cv::v_store(dst + 4 * i, cv::v_muladd(cv::v_cvt_f32(cv::v_reinterpret_as_s32(v32[i])), a, b));
+        }
+    };
+    for (; x <= width - 16; x += 16) {
+        cv::v_uint8x16 c0, c1, c2;
+        cv::v_load_deinterleave(src + 3 * x, c0, c1, c2);
+        store(c0, alpha0, beta0, dst0 + x);
+        store(c1, alpha1, beta1, dst1 + x);
+        store(c2, alpha2, beta2, dst2 + x);
+    }
+#endif
+    for (; x < width; ++x) {
+        dst0[x] = src[3 * x] * alpha[0] + beta[0];
+        dst1[x] = src[3 * x + 1] * alpha[1] + beta[1];
+        dst2[x] = src[3 * x + 2] * alpha[2] + beta[2];
+    }
+}
+
+void packImageToTensor(const cv::Mat& img, float* buffer, int batch_index,
+                       bool swap_rb, float scale, float offset) {
+    CV_Assert(img.type() == CV_8UC3);
+
+    const int rows = img.rows;
+    const int cols = img.cols;
+    const int vol_chl = rows * cols;
+    float* tensor = buffer + static_cast<size_t>(batch_index) * 3 * vol_chl;
+
+    // Planes of the source channels 0, 1, 2 (B, G, R)
+    float* planes[3] = {tensor, tensor + vol_chl, tensor + 2 * vol_chl};
+    if (swap_rb) {
+        std::swap(planes[0], planes[2]);
+    }
+
+    const float alpha[3] = {scale, scale, scale};
+    const float beta[3] = {offset, offset, offset};
+    for (int y = 0; y < rows; ++y) {
+        normalizeRow(img.ptr<uchar>(y), cols, alpha, beta,
+                     planes[0] + y * cols, planes[1] + y * cols, planes[2] + y * cols);
+    }
+}
+
+void resizeImageToTensor(const cv::Mat& img, cv::Size size, float* buffer, int batch_index,
+                         bool swap_rb, float scale, float offset) {
+    CV_Assert(img.type() == CV_8UC3 && !img.empty());
+
+    const int rows = size.height;
+    const int cols = size.width;
+    const int vol_chl = rows * cols;
+    float* tensor = buffer + static_cast<size_t>(batch_index) * 3 * vol_chl;
+
+    // Planes of the source channels 0, 1, 2 (B, G, R)
+    float* planes[3] = {tensor, tensor + vol_chl, tensor + 2 * vol_chl};
+    if (swap_rb) {
+        std::swap(planes[0], planes[2]);
+    }
+
+    // Source columns (byte offsets) and weights of each tensor column
+    const float fx = static_cast<float>(img.cols) / cols;
+    const float fy = static_cast<float>(img.rows) / rows;
+    cv::AutoBuffer<int> x_offsets(2 * cols);
+    cv::AutoBuffer<float> x_weights(cols);
+    for (int x = 0; x < cols; ++x) {
+        float sx = (x + 0.5f) * fx - 0.5f;
+        int x0 = cvFloor(sx);
+        float wx = sx - x0;
+        if (x0 < 0) {
+            x0 = 0;
+            wx = 0;
+        }
+        if (x0 >= img.cols - 1) {
+            x0 = img.cols - 1;
+            wx = 0;
+        }
+        int x1 = std::min(x0 + 1, img.cols - 1);
+        x_offsets[2 * x] = 3 * x0;
+        x_offsets[2 * x + 1] = 3 * x1;
+        x_weights[x] = wx;
+    }
+
+    for (int y = 0; y < rows; ++y) {
+        float sy = (y + 0.5f) * fy - 0.5f;
+        int y0 = cvFloor(sy);
+        float wy = sy - y0;
+        if (y0 < 0) {
+            y0 = 0;
+            wy = 0;
+        }
+        if (y0 >= img.rows - 1) {
+            y0 = img.rows - 1;
+            wy = 0;
+        }
+        const uchar* src0 = img.ptr<uchar>(y0);
+        const uchar* src1 = img.ptr<uchar>(std::min(y0 + 1, img.rows - 1));
+
+        // Vertical weights folded with scale
+        const float w0 = (1 - wy) * scale;
+        const float w1 = wy * scale;
+        float* dst0 = planes[0] + y * cols;
+        float* dst1 = planes[1] + y * cols;
+        float* dst2 = planes[2] + y * cols;
+        for (int x = 0; x < cols; ++x) {
+            const uchar* p00 = src0 + x_offsets[2 * x];
+            const uchar* p01 = src0 + x_offsets[2 * x + 1];
+            const uchar* p10 = src1 + x_offsets[2 * x];
+            const uchar* p11 = src1 + x_offsets[2 * x + 1];
+            const float wx = x_weights[x];
+            float* dst[3] = {dst0 + x, dst1 + x, dst2 + x};
+            for (int c = 0; c < 3; ++c) {
+                float top = p00[c] + wx * (p01[c] - p00[c]);
+                float bottom = p10[c] + wx * (p11[c] - p10[c]);
+                *dst[c] = w0 * top + w1 * bottom + offset;
+            }
+        }
+    }
+}
@@ -17,64 +17,117 @@
 #include "common.h"
 #include "logger.h"
 #include "uff_model.h"
+#include "perception/common/inference/opencv_dnn_backend.h"
+#include "utils/mapped_file.h"
 
 UffModel::UffModel(const UffModelParams& params) {
     mParams = params;
 
-    // If plan file is existed => Load it
+    // Reuse the engine file only if it was built from this model,
+    // precision, batch size and TensorRT version
+    std::string precision = mParams.int8 ? "INT8" : mParams.fp16 ? "FLOAT16" : "FLOAT32";
+    EngineCache engineCache(mParams.engineFilePath, mParams.uffFilePath, precision,
+                            mParams.batchSize, getTensorRTRuntimeVersion());
+
+    bool loaded = false;
     if (!mParams.forceRebuildEngine && mParams.engineFilePath != "" &&
-        fs::exists(mParams.engineFilePath)) {
+        engineCache.isValid()) {
         cout << "Loading TensorRT engine file at: " << mParams.engineFilePath
              << endl;
-        loadEngine();
+        loaded = loadEngine();
+        if (!loaded) {
+            cerr << "Error on loading engine at: " << mParams.engineFilePath
+                 << ". Rebuilding it." << endl;
+        }
+    }
 
-    } else {  // Else, create engine file
+    if (!loaded) {  // Else, build the engine and save it
 
         cout << "Creating a new engine file at: " << mParams.engineFilePath
              << endl;
-        build();
-        if (!saveEngine(mParams.engineFilePath, std::cerr)) {
-            cerr << "Error on saving engine at: " << mParams.engineFilePath
-                 << endl;
+        if (!build()) {
             return;
         }
-    }
-
-    if (mParams.classListFile != "") {
-        if (readClassListFile(mParams.classListFile, mParams.classes) != 0) {
-            cerr << "Error on loading class list: " << mParams.classListFile
+        if (!saveEngine(engineCache, std::cerr)) {
+            cerr << "Error on saving engine at: " << mParams.engineFilePath
                  << endl;
             return;
         }
-        cout << mParams.nClasses << endl;
-        mParams.nClasses = mParams.classes.size();
     }
 
-    createContext();
+    ready = createContext();
 }
 
-bool UffModel::loadEngine() {
-    std::ifstream engineFile(mParams.engineFilePath, std::ios::binary);
-    if (!engineFile) {
+bool UffModel::isReady() {
+    return ready;
+}
+
+std::string UffModel::getName() {
+    return "TensorRT";
+}
+
+bool UffModel::infer(const float* input, int batch_size, int slot) {
+    if (!ready) return false;
+    samplesCommon::BufferManager& slot_buffers = *buffers[slot];
+
+    // Copy the input straight to the device buffer
+    const std::string& input_name = mParams.inputTensorNames[0];
+    size_t input_size = slot_buffers.size(input_name) / mParams.batchSize * batch_size;
+    if (cudaMemcpy(slot_buffers.getDeviceBuffer(input_name), input, input_size,
+                   cudaMemcpyHostToDevice) != cudaSuccess) {
+        return false;
+    }
+
+    if (!context->execute(batch_size, slot_buffers.getDeviceBindings().data())) {
         return false;
     }
 
-    engineFile.seekg(0, engineFile.end);
-    long int fsize = engineFile.tellg();
-    engineFile.seekg(0, engineFile.beg);
+    // Memcpy from device output buffers to host output buffers
+    slot_buffers.copyOutputToHost();
+    return true;
+}
 
-    std::vector<char> engineData(fsize);
-    engineFile.read(engineData.data(), fsize);
+const float* UffModel::getOutput(int output_index, int slot) {
+    return static_cast<const float*>(
+        buffers[slot]->getHostBuffer(mParams.outputTensorNames[output_index]));
+}
 
-    if (!engineFile) {
+std::shared_ptr<InferenceBackend> createUffModelBackend(const UffModelParams& params) {
+    InferenceBackendType type = resolveInferenceBackendType(getInferenceBackendType());
+
+    if (type == kInferenceBackendTensorRT) {
+        std::shared_ptr<UffModel> model = std::make_shared<UffModel>(params);
+        if (model->isReady()) {
+            return model;
+        }
+        cerr << "Error on creating TensorRT engine for: " << params.uffFilePath << endl;
+        if (getInferenceBackendType() != kInferenceBackendAuto) {
+            return nullptr;
+        }
+        cerr << "Falling back to CPU inference." << endl;
+    }
+
+    std::shared_ptr<OpenCVDnnBackend> cpu_model = std::make_shared<OpenCVDnnBackend>(
+        params.cpuModelFilePath, 3, params.inputH, params.inputW, params.outputTensorNames);
+    if (!cpu_model->isReady()) {
+        return nullptr;
+    }
+    return cpu_model;
+}
+
+bool UffModel::loadEngine() {
+    // The engine is deserialized straight from the mapped file
+    MappedFile engineFile;
+    if (!engineFile.open(mParams.engineFilePath)) {
         return false;
     }
+    engineFile.adviseSequential();
 
     SampleUniquePtr<nvinfer1::IRuntime> runtime{
         createInferRuntime(gLogger.getTRTLogger())};
 
     mEngine = std::shared_ptr<nvinfer1::ICudaEngine>(
-        runtime->deserializeCudaEngine(engineData.data(), fsize, nullptr),
+        runtime->deserializeCudaEngine(engineFile.getData(), engineFile.getSize(), nullptr),
         samplesCommon::InferDeleter());
     if (!mEngine) {
         return false;
@@ -83,31 +136,25 @@ bool UffModel::loadEngine() {
     return true;
 }
 
-bool UffModel::saveEngine(const std::string& fileName, std::ostream& err) {
-    std::ofstream engineFile(fileName, std::ios::binary);
-    if (!engineFile) {
-        err << "Cannot open engine file: " << fileName << std::endl;
-        return false;
-    }
-
+bool UffModel::saveEngine(EngineCache& engineCache, std::ostream& err) {
     IHostMemory* serializedEngine = mEngine->serialize();
     if (serializedEngine == nullptr) {
         err << "Engine serialization failed" << std::endl;
         return false;
     }
 
-    engineFile.write(static_cast<char*>(serializedEngine->data()),
-                     serializedEngine->size());
-
+    bool saved = engineCache.save(serializedEngine->data(), serializedEngine->size());
     serializedEngine->destroy();
-    return !engineFile.fail();
+    return saved;
 }
 
 // From engine, create context for execution
 bool UffModel::createContext() {
-    // Create RAII buffer manager object
-    buffers = std::make_shared<samplesCommon::BufferManager>(mEngine,
-                                                             mParams.batchSize);
+    // Create RAII buffer manager objects
+    for (int slot = 0; slot < kInferenceSlots; ++slot) {
+        buffers[slot] = std::make_shared<samplesCommon::BufferManager>(mEngine,
+                                                                       mParams.batchSize);
+    }
 
     context = SampleUniquePtr<nvinfer1::IExecutionContext>(
         mEngine->createExecutionContext());
@@ -168,7 +215,6 @@ bool UffModel::build() {
 
     if (!mEngine) {
         std::cout << "Error on building engine!" << std::endl;
-        exit(1);
         return false;
     }
     assert(network->getNbInputs() == 1);
@@ -198,7 +244,7 @@ void UffModel::constructNetwork(
 
     // Register tensorflow input
     parser->registerInput(mParams.inputTensorNames[0].c_str(),
-                          nvinfer1::Dims3(3, mParams.inputW, mParams.inputH),
+                          nvinfer1::Dims3(3, mParams.inputH, mParams.inputW),
                           nvuffparser::UffInputOrder::kNCHW);
     parser->registerOutput(mParams.outputTensorNames[0].c_str());
 
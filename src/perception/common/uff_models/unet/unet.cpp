@@ -18,97 +18,68 @@
 #include "buffers.h"
 #include "common.h"
 #include "logger.h"
+#include "tensor_packing.h"
 
-Unet::Unet(const UffModelParams& params): UffModel(params) {}
-
-// Reads the input, pre-process, and stores in managed buffer
-bool Unet::processInput(const samplesCommon::BufferManager& buffers,
-                        const cv::Mat& img) {
-    int inputH = mParams.inputH;
-    int inputW = mParams.inputW;
-
-    cv::Mat resized_img;
-    cv::resize(img, resized_img, cv::Size(inputW, inputH));
-
-    // put data into buffer
-    float* hostDataBuffer =
-        static_cast<float*>(buffers.getHostBuffer(mParams.inputTensorNames[0]));
-
-    int volChl = inputH * inputW;
-
-    for (int x = 0; x < inputW; ++x) {
-        for (int y = 0; y < inputH; ++y) {
-            cv::Vec3b intensity = resized_img.at<cv::Vec3b>(y, x);
-            int blue = intensity.val[0];
-            int green = intensity.val[1];
-            int red = intensity.val[2];
-
-            int j = y * inputH + x;
-
-            hostDataBuffer[0 * volChl + j] = float(red);
-            hostDataBuffer[1 * volChl + j] = float(green);
-            hostDataBuffer[2 * volChl + j] = float(blue);
-        }
+Unet::Unet(const UffModelParams& params): mParams(params) {
+    input_buffer.resize(3 * mParams.inputH * mParams.inputW);
+    backend = createUffModelBackend(mParams);
+    if (backend) {
+        cout << "Unet backend: " << backend->getName() << endl;
     }
+}
 
-    return true;
+bool Unet::isReady() {
+    return backend != nullptr;
 }
 
-// Process output and verify result
-bool Unet::processOutput(const samplesCommon::BufferManager& buffers,
-                         cv::Mat& output_img) {
+bool Unet::runInput(const cv::Mat& img) {
+    if (!backend) {
+        return false;
+    }
+
     int inputH = mParams.inputH;
     int inputW = mParams.inputW;
 
-    const float* out_buff = static_cast<float*>(
-        buffers.getHostBuffer(mParams.outputTensorNames[0]));
-
-    output_img = cv::Mat(inputH, inputW, CV_32F, cv::Scalar(0));
-
-    for (int x = 0; x < inputW; ++x) {
-        for (int y = 0; y < inputH; ++y) {
-            int j = y * inputH + x;
-            output_img.at<float>(y, x) = out_buff[j];
-        }
+    cv::Mat resized_img;
+    if (img.size() == cv::Size(inputW, inputH)) {
+        resized_img = img;
+    } else {
+        cv::resize(img, resized_img, cv::Size(inputW, inputH));
     }
 
-    return true;
+    // put data into the buffer
+    packImageToTensor(resized_img, input_buffer.data(), 0, true, 1.0f);
+
+    return backend->infer(input_buffer.data(), 1);
 }
 
-// Runs the TensorRT inference engine
+// Runs the inference backend
 // This function is the main execution function
-// It allocates the buffer, sets inputs and executes the engine
+// It sets inputs and executes the engine
 bool Unet::infer(const cv::Mat& input_img, cv::Mat& output_img) {
-    int origin_w = input_img.size().width;
-    int origin_h = input_img.size().height;
-
-    if (!processInput(*buffers, input_img)) {
-        return false;
-    }
-
-    // Memcpy from host input buffers to device input buffers
-    buffers->copyInputToDevice();
+    return infer(input_img, output_img, input_img.size());
+}
 
-    bool status = context->execute(mParams.batchSize,
-                                   buffers->getDeviceBindings().data());
-    if (!status) {
+bool Unet::infer(const cv::Mat& input_img, cv::Mat& output_img, cv::Size output_size) {
+    if (!runInput(input_img)) {
         return false;
     }
 
-    // Memcpy from device output buffers to host output buffers
-    buffers->copyOutputToHost();
-
-    cv::Mat prepared_output;
+    // Row-major output of any shape, resized to the original size
+    const float* out_buff = backend->getOutput(0);
+    cv::resize(cv::Mat(mParams.inputH, mParams.inputW, CV_32F, const_cast<float*>(out_buff)),
+               output_img, output_size);
+    return true;
+}
 
-    // Post-process output
-    if (!processOutput(*buffers, prepared_output)) {
+bool Unet::inferMask(const cv::Mat& input_img, cv::Mat& mask, float threshold) {
+    if (!runInput(input_img)) {
         return false;
     }
 
-    // Resize output_img to original size
-    cv::resize(prepared_output, prepared_output, cv::Size(origin_w, origin_h));
-
-    output_img = prepared_output;
-
+    // One pass over the output, straight from the output buffer
+    const float* out_buff = backend->getOutput(0);
+    cv::compare(cv::Mat(mParams.inputH, mParams.inputW, CV_32F, const_cast<float*>(out_buff)),
+                threshold, mask, cv::CMP_GT);
     return true;
-}
\ No newline at end of file
+}
@@ -20,26 +20,40 @@
 #include "../common/include/common.h"
 #include "../common/include/logger.h"
 #include "../common/include/uff_model.h"
+#include "perception/common/inference/inference_backend.h"
 
 #include "utils/filesystem_include.h"
 
-struct Unet : UffModel {
+struct Unet {
  
    public:
     Unet(const UffModelParams& params);
 
-    // Run the TensorRT inference engine
+    // False if no inference backend could be created
+    bool isReady();
+
+    // Run the network
     bool infer(const cv::Mat& input_img, cv::Mat& output_img);
 
+    // Run the engine and resize the output to output_size.
+    // input_img is not resized if it already has the input size of the network
+    bool infer(const cv::Mat& input_img, cv::Mat& output_img, cv::Size output_size);
+
+    // Run the engine and threshold the output while reading it out, at the
+    // resolution of the network: mask (CV_8U) is 255 where the output is
+    // above threshold, 0 elsewhere
+    bool inferMask(const cv::Mat& input_img, cv::Mat& mask, float threshold);
+
    private:
+    UffModelParams mParams;
+    // Run on the calling thread: the lane thread runs one frame at a time
+    std::shared_ptr<InferenceBackend> backend;
 
-    // Put input to buffer
-    bool processInput(const samplesCommon::BufferManager& buffers,
-                      const cv::Mat& input_img);
+    // Network input (CHW)
+    std::vector<float> input_buffer;
 
-    // Process the output
-    bool processOutput(const samplesCommon::BufferManager& buffers,
-                       cv::Mat& output_img);
+    // Put input to the buffer and run the backend
+    bool runInput(const cv::Mat& input_img);
 };
 
 #endif
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "perception/lane_detection/lane_line.h"
+#include "perception/lane_detection/tracked_lane_postprocessor.h"
 #include "perception/common/uff_models/unet/unet.h"
 #include "utils/timer.h"
 
@@ -15,44 +16,52 @@ class LaneDetector {
    private:
     std::shared_ptr<Unet> model;
 
-    std::vector<Timer::time_point_t> dual_line_checking_time;
-    std::vector<bool> is_dual_line;
+    // Reused across frames by the fast path of detectLaneLines()
+    cv::Mat lane_mask;
+    // Lines of the binary lane mask of a frame: in the whole mask, or only
+    // around the tracked lines once locked
+    TrackedLanePostprocessor postprocessor;
 
    public:
     bool ready = false;
 
     LaneDetector();
 
-    cv::Mat getLaneMask(const cv::Mat& input_img);
+    // Size of the network input
+    cv::Size getInputSize();
+
+    // model_input: input_img already resized to getInputSize()
+    // (e.g. by the preprocessing cache of CarStatus). If empty,
+    // input_img is resized here
+    cv::Mat getLaneMask(const cv::Mat& input_img, const cv::Mat& model_input = cv::Mat());
 
     // Lane detect function
-    // For debug purpose
+    // Lines are detected in the binary lane mask at the resolution of the
+    // network, and returned in the coordinates of input_img.
+    // capture_time: capture time of the frame (Frame::capture_time), which
+    // time based decisions (lane departure, prediction of the tracked
+    // lines) are made at
+    // For debug purpose: also gives the mask (CV_8U, network resolution)
+    // and draws the detected segments and the lane lines
     std::vector<LaneLine> detectLaneLines(const cv::Mat& input_img,
                                                 cv::Mat& line_mask,
                                                 cv::Mat& detected_lines_img,
                                                 cv::Mat& reduced_lines_img,
-                                                bool &lane_departure);
-    // For general usage
-    std::vector<LaneLine> detectLaneLines(const cv::Mat& img, bool &lane_departure);
+                                                bool &lane_departure,
+                                                const cv::Mat& model_input = cv::Mat(),
+                                                Timer::time_point_t capture_time = Timer::getCurrentTime());
+    // For general usage: results only, no visualization
+    std::vector<LaneLine> detectLaneLines(const cv::Mat& img, bool &lane_departure,
+                                                const cv::Mat& model_input = cv::Mat(),
+                                                Timer::time_point_t capture_time = Timer::getCurrentTime());
+    // Same, filling lane_lines (its capacity is reused)
+    void detectLaneLines(const cv::Mat& img, std::vector<LaneLine>& lane_lines,
+                         bool &lane_departure, const cv::Mat& model_input = cv::Mat(),
+                         Timer::time_point_t capture_time = Timer::getCurrentTime());
 
-   private:
-    // Utils functions
-    std::vector<cv::Vec4i> detectAndReduceLines(const cv::Mat& img,
-                                                cv::Mat& detected_lines_img,
-                                                cv::Mat& reduced_linesImg);
-    static cv::Vec2d linearParameters(cv::Vec4i line);
-    static cv::Vec4i extendedLine(cv::Vec4i line, double d);
-    static std::vector<cv::Point2i> boundingRectangleContour(cv::Vec4i line,
-                                                             float d);
-    static bool extendedBoundingRectangleLineEquivalence(
-        const cv::Vec4i& _l1, const cv::Vec4i& _l2,
-        float extensionLengthFraction, float maxAngleDiff,
-        float boundingRectangleThickness);
-    void getLinePointinImageBorder(const cv::Point &p1_in,
-        const cv::Point &p2_in,
-        cv::Point &p1_out,
-        cv::Point &p2_out, int rows,
-        int cols);
+    // Forget the tracked lines, when frames are skipped (e.g. while the
+    // turning signal is on)
+    void resetTracking();
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,348 @@
+#include "lane_postprocessor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <opencv2/imgproc.hpp>
+
+using namespace cv;
+
+LanePostprocessor::LanePostprocessor() {
+    // Lane departure history: room for a few seconds of frames
+    dual_line_checking_time.reserve(256);
+    is_dual_line.reserve(256);
+}
+
+EgoLaneLines findEgoLaneLines(const std::vector<cv::Vec4i>& lines, cv::Size image_size) {
+    EgoLaneLines ego_lane_lines;
+    int center_point = image_size.width / 2;
+    int last_row = image_size.height - 1;
+    int last_col = image_size.width - 1;
+    int left_x = -1, right_x = image_size.width;
+    int left_y = -1, right_y = -1;
+    int min_side_y = std::ceil(0.95 * last_row);
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+        const cv::Vec4i& l = lines[i];
+
+        // Crossing of the bottom row, nearest to the center on each side
+        if (l[1] != l[3] && std::min(l[1], l[3]) <= last_row && std::max(l[1], l[3]) >= last_row) {
+            int x = cvRound(l[0] + static_cast<double>(last_row - l[1]) * (l[2] - l[0]) / (l[3] - l[1]));
+            if (x >= 0 && x <= center_point && x >= left_x) {
+                left_x = x;
+                ego_lane_lines.left = i;
+            } else if (x > center_point && x <= last_col && x <= right_x) {
+                right_x = x;
+                ego_lane_lines.right = i;
+            }
+        }
+
+        // Crossings of the sides, lowest first
+        if (l[0] == l[2]) continue;
+        for (int side_x : {0, last_col}) {
+            if (std::min(l[0], l[2]) > side_x || std::max(l[0], l[2]) < side_x) continue;
+            int y = cvRound(l[1] + static_cast<double>(side_x - l[0]) * (l[3] - l[1]) / (l[2] - l[0]));
+            if (y < min_side_y || y > last_row) continue;
+            if (side_x == 0 && y >= left_y) {
+                left_y = y;
+                if (left_x < 0) ego_lane_lines.left = i;
+            } else if (side_x == last_col && y >= right_y) {
+                right_y = y;
+                if (right_x > last_col) ego_lane_lines.right = i;
+            }
+        }
+    }
+
+    // Lines found on the bottom row take precedence over the sides
+    if (left_x >= 0) {
+        ego_lane_lines.left_pos = left_x - center_point;
+    } else if (left_y >= 0) {
+        ego_lane_lines.left_pos = -center_point - (last_row - left_y);
+    }
+    if (right_x <= last_col) {
+        ego_lane_lines.right_pos = right_x - center_point;
+    } else if (right_y >= 0) {
+        ego_lane_lines.right_pos = center_point + (last_row - right_y);
+    }
+    return ego_lane_lines;
+}
+
+void LanePostprocessor::process(const cv::Mat& lane_mask, cv::Size lane_frame_size,
+                                std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                                Timer::time_point_t time) {
+    if (lane_mask.empty()) {
+        lane_lines.clear();
+        lane_departure = false;
+        reliable_lane_scene = false;
+        cluttered_lane_scene = false;
+        return;
+    }
+    mask_size = lane_mask.size();
+    frame_size = lane_frame_size;
+
+    // Delect lines in any reasonable way
+    float scale = getMaskScale();
+    HoughLinesP(lane_mask, segments, 1, CV_PI / 180, std::max(1, cvRound(40 * scale)), 5 * scale, 50 * scale);
+
+    reduceLines();
+    classifyLines(lane_lines, lane_departure, time);
+}
+
+void LanePostprocessor::processSegments(const std::vector<cv::Vec4i>& input_segments, cv::Size input_mask_size,
+                                        cv::Size input_frame_size, std::vector<LaneLine>& lane_lines,
+                                        bool& lane_departure, Timer::time_point_t time) {
+    segments = input_segments;
+    mask_size = input_mask_size;
+    frame_size = input_frame_size;
+    reduceLines();
+    classifyLines(lane_lines, lane_departure, time);
+}
+
+// Geometric mean of the scales of both axes
+float LanePostprocessor::getMaskScale() const {
+    return std::sqrt(static_cast<float>(mask_size.area()) / frame_size.area());
+}
+
+// Segments -> one fitted line per cluster of segments, in frame coordinates
+void LanePostprocessor::reduceLines() {
+    // Same clusters as cv::partition with the pairwise equivalence,
+    // without comparing all pairs
+    LineClusteringParams clustering_params;
+    // line extension length - as fraction of original line width
+    clustering_params.extension_length_fraction = 0.1;
+    // maximum allowed angle difference for lines to be considered
+    // in same equivalence class
+    clustering_params.max_angle_diff = 2.0;
+    // thickness of bounding rectangle around each line
+    clustering_params.bounding_rectangle_thickness = 20 * getMaskScale();
+    n_clusters = clusterLines(segments, labels, clustering_params, clustering_workspace);
+
+    // Sums over the end points of each cluster, instead of a point cloud
+    line_fits.assign(n_clusters, LineFit());
+    for (size_t i = 0; i < segments.size(); i++) {
+        LineFit& fit = line_fits[labels[i]];
+        for (int k = 0; k < 4; k += 2) {
+            int x = segments[i][k];
+            int y = segments[i][k + 1];
+            if (fit.n_points == 0) {
+                fit.min_x = fit.max_x = x;
+            }
+            fit.min_x = std::min(fit.min_x, x);
+            fit.max_x = std::max(fit.max_x, x);
+            float fx = x, fy = y;
+            fit.x += fx;
+            fit.y += fy;
+            fit.x2 += fx * fx;
+            fit.y2 += fy * fy;
+            fit.xy += fx * fy;
+            ++fit.n_points;
+        }
+    }
+
+    // fit line to each equivalence class: closed form of cv::fitLine
+    // with DIST_L2 (direction of largest variance through the centroid)
+    float scale_x = static_cast<float>(frame_size.width) / mask_size.width;
+    float scale_y = static_cast<float>(frame_size.height) / mask_size.height;
+    lines.clear();
+    for (const LineFit& fit : line_fits) {
+        double w = fit.n_points;
+        double x = fit.x / w, y = fit.y / w;
+        double dx2 = fit.x2 / w - x * x;
+        double dy2 = fit.y2 / w - y * y;
+        double dxy = fit.xy / w - x * y;
+        float t = static_cast<float>(atan2(2 * dxy, dx2 - dy2)) / 2;
+
+        // lineParams: [vx,vy, x0,y0]: (normalized vector, point on our
+        // contour)
+        // (x,y) = (x0,y0) + t*(vx,vy), t -> (-inf; inf)
+        Vec4f lineParams(static_cast<float>(cos(t)), static_cast<float>(sin(t)),
+                         static_cast<float>(x), static_cast<float>(y));
+
+        // derive y coords of fitted line
+        float m = lineParams[1] / lineParams[0];
+        float y1 = ((fit.min_x - lineParams[2]) * m) + lineParams[3];
+        float y2 = ((fit.max_x - lineParams[2]) * m) + lineParams[3];
+
+        // End points from mask to frame coordinates (pixel centers)
+        lines.push_back(cv::Vec4i((fit.min_x + 0.5f) * scale_x - 0.5f, (y1 + 0.5f) * scale_y - 0.5f,
+                                  (fit.max_x + 0.5f) * scale_x - 0.5f, (y2 + 0.5f) * scale_y - 0.5f));
+    }
+}
+
+// Filter the fitted lines, find the lines of the ego lane and check
+// lane departure
+void LanePostprocessor::classifyLines(std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                                      Timer::time_point_t time) {
+
+    // Filter short lines
+    int img_height = frame_size.height;
+    lines.erase(std::remove_if(lines.begin(), lines.end(), [img_height](const cv::Vec4i& line) {
+        int line_length = sqrt(pow(line[2] - line[0], 2) + pow(line[3] - line[1], 2));
+        return !(line_length > 0.2 * img_height);
+    }), lines.end());
+
+    // Filter all horizontal lines
+    int n_filtered_horizontal_lines = 0;
+    lines.erase(std::remove_if(lines.begin(), lines.end(), [&n_filtered_horizontal_lines](const cv::Vec4i& line) {
+        double angle = atan2(line[3] - line[1], line[2] - line[0]) * 180.0 / CV_PI;
+        if (angle < 0) angle = angle + 360;
+        if (angle > 180) angle = 360 - angle;
+        if (angle < 150 && angle > 30) {
+            return false;
+        }
+        ++n_filtered_horizontal_lines;
+        return true;
+    }), lines.end());
+
+    // === Classify lines ===
+    // Extend lines
+    for (size_t i = 0; i < lines.size(); i++) {
+        cv::Point p1 = Point(lines[i][0], lines[i][1]);
+        cv::Point p2 = Point(lines[i][2], lines[i][3]);
+        getLinePointinImageBorder(p1, p2, p1, p2, frame_size.height, frame_size.width);
+        lines[i] = cv::Vec4i(p1.x, p1.y, p2.x, p2.y);
+    }
+    lane_lines.clear();
+    for (size_t i = 0; i < lines.size(); i++) {
+        lane_lines.push_back(LaneLine(lines[i], OtherLaneLine));
+    }
+    EgoLaneLines ego_lane_lines = findEgoLaneLines(lines, frame_size);
+    bool found_left = ego_lane_lines.left >= 0;
+    bool found_right = ego_lane_lines.right >= 0;
+    float left_pos = ego_lane_lines.left_pos;
+    float right_pos = ego_lane_lines.right_pos;
+    if (found_left) lane_lines[ego_lane_lines.left].type = LeftLaneLine;
+    if (found_right) lane_lines[ego_lane_lines.right].type = RightLaneLine;
+    int center_point = frame_size.width / 2;
+
+    // === Lane departure warning ===
+    lane_departure = false;
+
+    // Remove expired tracking
+    int n_remove = 0;
+    for (size_t i = 0; i < dual_line_checking_time.size(); ++i) {
+        if (Timer::calcDiff(dual_line_checking_time[i], time) > 3000) {
+            ++n_remove;
+        } else {
+            break;
+        }
+    }
+    if (n_remove > 0) {
+        dual_line_checking_time.erase(dual_line_checking_time.begin() + n_remove - 1);
+        is_dual_line.erase(is_dual_line.begin() + n_remove - 1);
+    }
+    dual_line_checking_time.push_back(time);
+    is_dual_line.push_back(found_left && found_right);
+
+    //  Calculate ratio of frames containing good line condition
+    float good_frame_ratio = 0;
+    if (is_dual_line.size() > 5) {
+        int n_frames_good_lines = std::count(is_dual_line.begin(), is_dual_line.end(), true);
+        good_frame_ratio = static_cast<float>(n_frames_good_lines) / is_dual_line.size();
+    }
+
+    cluttered_lane_scene = n_filtered_horizontal_lines >= 3 || lane_lines.size() >= 6;
+    reliable_lane_scene = good_frame_ratio > 0.6 && !cluttered_lane_scene;
+    if (reliable_lane_scene && found_left && found_right) {
+
+        // Normalize left pos, right pos to range(-xx.xx -> xx.xx)
+        left_pos /= center_point;
+        right_pos /= center_point;
+
+        if ((abs(left_pos) < 0.3 && abs(right_pos) > 0.5)
+        || (abs(left_pos) > 0.5 && abs(right_pos) < 0.3)) {
+            lane_departure = true;
+        }
+
+    }
+}
+
+bool LanePostprocessor::isLaneSceneReliable() const {
+    return reliable_lane_scene;
+}
+
+bool LanePostprocessor::isLaneSceneCluttered() const {
+    return cluttered_lane_scene;
+}
+
+void LanePostprocessor::drawSegments(cv::Mat& detected_lines_img) {
+    detected_lines_img = Mat::zeros(mask_size, CV_8UC3);
+
+    // grab a random colour for each equivalence class
+    RNG rng(215526);
+    std::vector<Scalar> colors(n_clusters);
+    for (int i = 0; i < n_clusters; i++) {
+        colors[i] = Scalar(rng.uniform(30, 255), rng.uniform(30, 255),
+                           rng.uniform(30, 255));
+    }
+
+    // draw original detected lines
+    for (size_t i = 0; i < segments.size(); i++) {
+        cv::Vec4i& detectedLine = segments[i];
+        line(detected_lines_img, cv::Point(detectedLine[0], detectedLine[1]),
+             cv::Point(detectedLine[2], detectedLine[3]), colors[labels[i]], 2);
+    }
+}
+
+void LanePostprocessor::drawLaneLines(const std::vector<LaneLine>& lane_lines, bool lane_departure,
+                                      cv::Mat& reduced_lines_img) {
+    reduced_lines_img = Mat::zeros(frame_size, CV_8UC3);
+    for (const LaneLine& line : lane_lines) {
+        cv::Point p1 = Point(line.line[0], line.line[1]);
+        cv::Point p2 = Point(line.line[2], line.line[3]);
+        cv::Scalar color(50, 50, 50);
+        if (line.type == LeftLaneLine) {
+            color = cv::Scalar(255, 0, 0);
+        } else if (line.type == RightLaneLine) {
+            color = cv::Scalar(0, 0, 255);
+        }
+        cv::line(reduced_lines_img, p1, p2, color, 2);
+    }
+    if (lane_departure) {
+        cv::putText(reduced_lines_img, "LANE DEPARTURE", Point2f(reduced_lines_img.cols / 2,reduced_lines_img.rows / 2), FONT_HERSHEY_PLAIN, 1.2,  Scalar(0,0,255,255), 1.5);
+    }
+}
+
+void LanePostprocessor::getLinePointinImageBorder(const cv::Point &p1_in,
+                                                  const cv::Point &p2_in,
+                                                  cv::Point &p1_out,
+                                                  cv::Point &p2_out, int rows,
+                                                  int cols) {
+    double m =
+        (double)(p1_in.y - p2_in.y) /
+        (double)(p1_in.x - p2_in.x + std::numeric_limits<double>::epsilon());
+    double b = p1_in.y - (m * p1_in.x);
+
+    // At most 4 intersections with the borders: no vector needed
+    cv::Point border_point[4];
+    int n_border_points = 0;
+    double x, y;
+    // test for the line y = 0
+    y = 0;
+    x = (y - b) / m;
+    if (x > 0 && x < cols) border_point[n_border_points++] = cv::Point(x, y);
+
+    // test for the line y = img.rows
+    y = rows;
+    x = (y - b) / m;
+    if (x > 0 && x < cols) border_point[n_border_points++] = cv::Point(x, y);
+
+    // check intersection with horizontal lines x = 0
+    x = 0;
+    y = m * x + b;
+    if (y > 0 && y < rows) border_point[n_border_points++] = cv::Point(x, y);
+
+    x = cols;
+    y = m * x + b;
+    if (y > 0 && y < rows) border_point[n_border_points++] = cv::Point(x, y);
+
+    // Lines through a corner may cross less than 2 borders strictly:
+    // they are kept as they are
+    if (n_border_points < 2) {
+        p1_out = p1_in;
+        p2_out = p2_in;
+        return;
+    }
+    p1_out = border_point[0];
+    p2_out = border_point[1];
+}
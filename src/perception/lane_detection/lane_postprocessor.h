@@ -0,0 +1,104 @@
+#ifndef LANE_POSTPROCESSOR_H
+#define LANE_POSTPROCESSOR_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "perception/lane_detection/lane_line.h"
+#include "perception/lane_detection/line_clustering.h"
+#include "utils/timer.h"
+
+// Lines of the ego lane among lines extended to the borders of an image
+// of size image_size: the left (right) line is the one crossing the bottom
+// row nearest to the center, on its left (right). Failing that, the one
+// crossing the left (right) column lowest, in the bottom 5% of the rows.
+// Positions are relative to the center column, in pixels: for a line
+// found on a side, they continue past the corner by the distance from the
+// bottom row. Index -1 if no line is found
+struct EgoLaneLines {
+    int left = -1;
+    int right = -1;
+    float left_pos = 0;
+    float right_pos = 0;
+};
+EgoLaneLines findEgoLaneLines(const std::vector<cv::Vec4i>& lines, cv::Size image_size);
+
+// Lane lines and lane departure from the lane probability map of the
+// lane detection network: line segments (HoughLinesP), clustering and
+// line fitting at the resolution of the mask, then filtering and left /
+// right lane assignment in frame coordinates.
+// All intermediate results are kept in a workspace reused across frames:
+// once the buffers have grown to the usual size of a frame, processing
+// allocates nothing (except in HoughLinesP itself).
+// Visualization is a separate step, drawing the last processed frame.
+// Not thread-safe: one instance per lane detection thread
+class LanePostprocessor {
+   private:
+    // Sums over the end points of the segments of a cluster, for the
+    // closed-form least-squares line fit (cv::fitLine with DIST_L2)
+    struct LineFit {
+        double x = 0, y = 0, x2 = 0, y2 = 0, xy = 0;
+        int n_points = 0;
+        int min_x = 0, max_x = 0;
+    };
+
+    // Workspace
+    cv::Size mask_size;
+    cv::Size frame_size;
+    std::vector<cv::Vec4i> segments;         // HoughLinesP output
+    std::vector<int> labels;                 // Cluster of each segment
+    int n_clusters = 0;
+    LineClusteringWorkspace clustering_workspace;
+    std::vector<LineFit> line_fits;          // Of each cluster
+    std::vector<cv::Vec4i> lines;            // Fitted, filtered and extended lines (frame)
+
+    // Lane departure: recent frames with both lane lines found
+    std::vector<Timer::time_point_t> dual_line_checking_time;
+    std::vector<bool> is_dual_line;
+    bool reliable_lane_scene = false;
+    bool cluttered_lane_scene = false;
+
+    // Pixel lengths are tuned for masks of the size of the frame: scale of
+    // the mask, to adapt them
+    float getMaskScale() const;
+    void reduceLines();
+    void classifyLines(std::vector<LaneLine>& lane_lines, bool& lane_departure, Timer::time_point_t time);
+    static void getLinePointinImageBorder(const cv::Point& p1_in, const cv::Point& p2_in,
+                                          cv::Point& p1_out, cv::Point& p2_out,
+                                          int rows, int cols);
+
+   public:
+    LanePostprocessor();
+
+    // lane_mask: binary lane mask (CV_8U, non-zero on lanes) of any size,
+    // usually the output size of the network. Lines are detected and
+    // fitted at the resolution of the mask: only their end points are
+    // scaled to frame_size.
+    // lane_lines is cleared and filled (its capacity is reused).
+    // time: capture time of the frame, for the lane departure history
+    void process(const cv::Mat& lane_mask, cv::Size frame_size,
+                 std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                 Timer::time_point_t time);
+
+    // Same from line segments already detected in a mask of mask_size
+    void processSegments(const std::vector<cv::Vec4i>& segments, cv::Size mask_size, cv::Size frame_size,
+                         std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                         Timer::time_point_t time);
+
+    // Whether lane departure may be warned on the last processed frame,
+    // whatever the position of the lines: both lane lines found in most
+    // recent frames, few horizontal lines (e.g. crosswalks, stop lines)
+    // and few lines overall. lane_departure of process() is only set then
+    bool isLaneSceneReliable() const;
+    // Whether the last processed frame has many horizontal lines or many
+    // lines overall (part of isLaneSceneReliable())
+    bool isLaneSceneCluttered() const;
+
+    // Visualization of the last processed frame: segments colored by
+    // cluster (mask size), and lane lines colored by type (frame size)
+    void drawSegments(cv::Mat& detected_lines_img);
+    void drawLaneLines(const std::vector<LaneLine>& lane_lines, bool lane_departure,
+                       cv::Mat& reduced_lines_img);
+};
+
+#endif
@@ -0,0 +1,216 @@
+#include "lane_tracker.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "configs/config_lane_detection.h"
+
+bool LaneTracker::LineTrack::isLocked() const {
+    return active && hits >= LANE_TRACKER_MIN_HITS;
+}
+
+float LaneTracker::getBottomRow() const {
+    return frame_size.height - 1;
+}
+
+float LaneTracker::getTopRow() const {
+    return frame_size.height * LANE_TRACKER_TOP_ROW;
+}
+
+bool LaneTracker::getMeasurement(const cv::Vec4i& line, cv::Matx21f& measurement) const {
+    if (line[1] == line[3]) {
+        return false;
+    }
+    float dx_dy = static_cast<float>(line[2] - line[0]) / (line[3] - line[1]);
+    measurement(0) = line[0] + (getBottomRow() - line[1]) * dx_dy;
+    measurement(1) = line[0] + (getTopRow() - line[1]) * dx_dy;
+    return true;
+}
+
+cv::Vec4i LaneTracker::getTrackedLine(const LineTrack& track) const {
+    float x_bottom = track.filter.statePost.at<float>(0);
+    float x_top = track.filter.statePost.at<float>(1);
+    float dx_dy = (x_top - x_bottom) / (getTopRow() - getBottomRow());
+    float x0 = x_bottom - getBottomRow() * dx_dy;
+    float x1 = x_bottom + (frame_size.height - getBottomRow()) * dx_dy;
+    return cv::Vec4i(cvRound(x0), 0, cvRound(x1), frame_size.height);
+}
+
+void LaneTracker::initTrack(LineTrack& track, const cv::Matx21f& measurement) {
+    // State: x at the bottom and top rows, and their velocities (px/s)
+    track.filter.init(4, 2, 0, CV_32F);
+    cv::setIdentity(track.filter.measurementMatrix);
+    cv::setIdentity(track.filter.measurementNoiseCov,
+                    cv::Scalar::all(LANE_TRACKER_MEASUREMENT_NOISE * LANE_TRACKER_MEASUREMENT_NOISE));
+    // Unknown velocity at first
+    cv::setIdentity(track.filter.errorCovPost,
+                    cv::Scalar::all(LANE_TRACKER_MEASUREMENT_NOISE * LANE_TRACKER_MEASUREMENT_NOISE));
+    track.filter.errorCovPost.at<float>(2, 2) = track.filter.errorCovPost.at<float>(3, 3) =
+        LANE_TRACKER_INITIAL_VELOCITY_NOISE * LANE_TRACKER_INITIAL_VELOCITY_NOISE;
+    track.filter.statePost.at<float>(0) = measurement(0);
+    track.filter.statePost.at<float>(1) = measurement(1);
+    track.active = true;
+    track.hits = 1;
+    track.misses = 0;
+}
+
+void LaneTracker::predictTrack(LineTrack& track, float dt) {
+    // Constant velocity, with a random acceleration of
+    // LANE_TRACKER_ACCELERATION_NOISE
+    cv::setIdentity(track.filter.transitionMatrix);
+    track.filter.transitionMatrix.at<float>(0, 2) = dt;
+    track.filter.transitionMatrix.at<float>(1, 3) = dt;
+
+    float q = LANE_TRACKER_ACCELERATION_NOISE * LANE_TRACKER_ACCELERATION_NOISE;
+    cv::Mat& noise = track.filter.processNoiseCov;
+    noise.setTo(0);
+    for (int i = 0; i < 2; ++i) {
+        noise.at<float>(i, i) = q * dt * dt * dt * dt / 4;
+        noise.at<float>(i, i + 2) = noise.at<float>(i + 2, i) = q * dt * dt * dt / 2;
+        noise.at<float>(i + 2, i + 2) = q * dt * dt;
+    }
+    // Also sets statePost and errorCovPost, for frames without detection
+    track.filter.predict();
+}
+
+int LaneTracker::updateTrack(LineTrack& track, std::vector<LaneLine>& lane_lines, lane_line_type type) {
+    int detected = -1;
+    for (size_t i = 0; i < lane_lines.size(); ++i) {
+        if (lane_lines[i].type == type) {
+            detected = i;
+            break;
+        }
+    }
+    cv::Matx21f measurement;
+    bool measured = detected >= 0 && getMeasurement(lane_lines[detected].line, measurement);
+
+    if (!track.active) {
+        if (!measured) return -1;
+        initTrack(track, measurement);
+        return detected;
+    }
+
+    float band = LANE_TRACKER_SEARCH_BAND * frame_size.width;
+    if (measured && std::abs(measurement(0) - track.filter.statePre.at<float>(0)) <= band &&
+        std::abs(measurement(1) - track.filter.statePre.at<float>(1)) <= band) {
+        // Header on the measurement: no copy
+        track.filter.correct(cv::Mat(measurement, false));
+        ++track.hits;
+        track.misses = 0;
+        return detected;
+    }
+
+    // Not locked yet: start again from the new detection
+    if (!track.isLocked() && measured) {
+        initTrack(track, measurement);
+        return detected;
+    }
+
+    ++track.misses;
+    if (track.misses > LANE_TRACKER_MAX_MISSES) {
+        track.active = false;
+    }
+    return -1;
+}
+
+bool LaneTracker::isLocked() const {
+    return left_track.isLocked() && right_track.isLocked();
+}
+
+bool LaneTracker::getSearchMask(cv::Size mask_size, cv::Mat& search_mask) const {
+    if (!isLocked() || frame_size.area() == 0) {
+        return false;
+    }
+    search_mask.create(mask_size, CV_8U);
+    search_mask.setTo(cv::Scalar(0));
+
+    // Pixel centers of the mask in the frame, and back. Filled row by
+    // row: cv::fillConvexPoly would copy the corners into a new vector
+    float scale_x = static_cast<float>(mask_size.width) / frame_size.width;
+    float scale_y = static_cast<float>(mask_size.height) / frame_size.height;
+    float half_width = LANE_TRACKER_SEARCH_BAND * mask_size.width;
+    for (const LineTrack* track : {&left_track, &right_track}) {
+        float x_bottom = track->filter.statePost.at<float>(0);
+        float x_top = track->filter.statePost.at<float>(1);
+        float dx_dy = (x_top - x_bottom) / (getTopRow() - getBottomRow());
+        for (int row = 0; row < mask_size.height; ++row) {
+            float frame_y = (row + 0.5f) / scale_y - 0.5f;
+            float frame_x = x_bottom + (frame_y - getBottomRow()) * dx_dy;
+            float band_x = (frame_x + 0.5f) * scale_x - 0.5f;
+            int x0 = std::max(0, cvRound(band_x - half_width));
+            int x1 = std::min(mask_size.width - 1, cvRound(band_x + half_width));
+            if (x0 <= x1) {
+                uchar* mask_row = search_mask.ptr<uchar>(row);
+                std::fill(mask_row + x0, mask_row + x1 + 1, 255);
+            }
+        }
+    }
+    return true;
+}
+
+void LaneTracker::update(std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                         cv::Size lane_frame_size, Timer::time_point_t time) {
+    float dt = 0;
+    if (has_last_update) {
+        Timer::time_duration_t time_passed = Timer::calcDiff(last_update_time, time);
+        if (time_passed < 0 || time_passed > LANE_TRACKER_MAX_GAP || lane_frame_size != frame_size) {
+            reset();
+        } else {
+            dt = time_passed / 1000.0f;
+        }
+    }
+    frame_size = lane_frame_size;
+    last_update_time = time;
+    has_last_update = true;
+
+    for (LineTrack* track : {&left_track, &right_track}) {
+        if (track->active) {
+            predictTrack(*track, dt);
+        }
+    }
+    int left = updateTrack(left_track, lane_lines, LeftLaneLine);
+    int right = updateTrack(right_track, lane_lines, RightLaneLine);
+
+    // Lines not associated to a track are not lines of the ego lane
+    for (int i = 0; i < static_cast<int>(lane_lines.size()); ++i) {
+        if ((lane_lines[i].type == LeftLaneLine && i != left) ||
+            (lane_lines[i].type == RightLaneLine && i != right)) {
+            lane_lines[i].type = OtherLaneLine;
+        }
+    }
+
+    // Locked lines are given by the filter, even without detection
+    if (left_track.isLocked()) {
+        if (left >= 0) {
+            lane_lines[left].line = getTrackedLine(left_track);
+        } else {
+            lane_lines.push_back(LaneLine(getTrackedLine(left_track), LeftLaneLine));
+        }
+    }
+    if (right_track.isLocked()) {
+        if (right >= 0) {
+            lane_lines[right].line = getTrackedLine(right_track);
+        } else {
+            lane_lines.push_back(LaneLine(getTrackedLine(right_track), RightLaneLine));
+        }
+    }
+
+    // === Lane departure warning ===
+    // Same rule as LanePostprocessor, on the filtered bottom row positions
+    lane_departure = false;
+    if (isLocked()) {
+        float center_point = frame_size.width / 2;
+        float left_pos = (left_track.filter.statePost.at<float>(0) - center_point) / center_point;
+        float right_pos = (right_track.filter.statePost.at<float>(0) - center_point) / center_point;
+        if ((std::abs(left_pos) < 0.3 && std::abs(right_pos) > 0.5)
+            || (std::abs(left_pos) > 0.5 && std::abs(right_pos) < 0.3)) {
+            lane_departure = true;
+        }
+    }
+}
+
+void LaneTracker::reset() {
+    left_track.active = false;
+    right_track.active = false;
+    has_last_update = false;
+}
@@ -0,0 +1,77 @@
+#ifndef LANE_TRACKER_H
+#define LANE_TRACKER_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+#include <opencv2/video/tracking.hpp>
+
+#include "perception/lane_detection/lane_line.h"
+#include "utils/timer.h"
+
+// Temporal tracking of the left and right lines of the ego lane.
+// Each line is described by its x at the bottom row of the frame and at
+// LANE_TRACKER_TOP_ROW, filtered by a Kalman filter with a constant
+// velocity model. Detections are associated to a line if both x are
+// within LANE_TRACKER_SEARCH_BAND of the prediction. A line is locked after
+// LANE_TRACKER_MIN_HITS associated frames, and lost after more than
+// LANE_TRACKER_MAX_MISSES frames without detection.
+// Once both lines are locked, lines only need to be searched in a band
+// around the predicted lines (getSearchMask()). Otherwise, the whole mask
+// is searched.
+// Not thread-safe: update() must be called in frame order from one thread
+class LaneTracker {
+   private:
+    struct LineTrack {
+        cv::KalmanFilter filter;
+        bool active = false;
+        int hits = 0;
+        int misses = 0;
+        bool isLocked() const;
+    };
+
+    LineTrack left_track;
+    LineTrack right_track;
+    cv::Size frame_size;
+    Timer::time_point_t last_update_time;
+    bool has_last_update = false;
+
+    // Rows of the frame where lines are described
+    float getBottomRow() const;
+    float getTopRow() const;
+
+    // x of line at the bottom and top rows. False for a horizontal line
+    bool getMeasurement(const cv::Vec4i& line, cv::Matx21f& measurement) const;
+    // Line through the filtered x at the bottom and top rows, from the top
+    // border to the bottom border of the frame
+    cv::Vec4i getTrackedLine(const LineTrack& track) const;
+
+    void initTrack(LineTrack& track, const cv::Matx21f& measurement);
+    void predictTrack(LineTrack& track, float dt);
+    // Associate the detected line of type (if any) to track. Return the
+    // index of the associated line in lane_lines, or -1
+    int updateTrack(LineTrack& track, std::vector<LaneLine>& lane_lines, lane_line_type type);
+
+   public:
+    // Whether both lines are locked, and lines may be searched in the
+    // band around the predicted lines only
+    bool isLocked() const;
+
+    // Binary mask (CV_8U, of mask_size) of the bands around the predicted
+    // lines, in a mask of the frame of the last update. False if not
+    // locked
+    bool getSearchMask(cv::Size mask_size, cv::Mat& search_mask) const;
+
+    // Update the tracks with the lane lines of a frame captured at time
+    // (left and right lines from LanePostprocessor). The left and right
+    // lines in lane_lines are replaced by the tracked lines, and
+    // lane_departure is decided on the tracked lines: false until both
+    // are locked. It doesn't check the scene (see
+    // LanePostprocessor::isLaneSceneReliable())
+    void update(std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                cv::Size frame_size, Timer::time_point_t time);
+
+    // Remove both tracks, e.g. when lanes are not analyzed for a while
+    void reset();
+};
+
+#endif
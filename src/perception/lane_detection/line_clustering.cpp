@@ -0,0 +1,220 @@
+#include "line_clustering.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <opencv2/imgproc.hpp>
+
+// Used line merging method from https://stackoverflow.com/questions/30746327/get-a-single-line-representation-for-multiple-close-by-lines-clustered-together/30904076
+
+namespace {
+
+// Slope m and intercept c of y = m * x + c through the end points of line.
+// Closed form of cv::solve() on the 2x2 system (same operations, hence
+// same results). (0, 0) for a vertical line, where cv::solve() fails
+cv::Vec2d linearParameters(cv::Vec4i line) {
+    double det = static_cast<double>(line[0]) - line[2];
+    if (det == 0.) {
+        return cv::Vec2d(0, 0);
+    }
+    double inv_det = 1. / det;
+    return cv::Vec2d((static_cast<double>(line[1]) - line[3]) * inv_det,
+                     (static_cast<double>(line[3]) * line[0] - static_cast<double>(line[1]) * line[2]) * inv_det);
+}
+
+cv::Vec4i extendedLine(cv::Vec4i line, double d) {
+    // oriented left-t-right
+    cv::Vec4d _line = line[2] - line[0] < 0
+                      ? cv::Vec4d(line[2], line[3], line[0], line[1])
+                      : cv::Vec4d(line[0], line[1], line[2], line[3]);
+    double m = linearParameters(_line)[0];
+    // solution of pythagorean theorem and m = yd/xd
+    double xd = sqrt(d * d / (m * m + 1));
+    double yd = xd * m;
+    return cv::Vec4d(_line[0] - xd, _line[1] - yd, _line[2] + xd, _line[3] + yd);
+}
+
+// Corners of the rectangle of half thickness d around line
+void boundingRectangleContour(cv::Vec4i line, float d, cv::Point2i contour[4]) {
+    // finds coordinates of perpendicular lines with length d in both line
+    // points https://math.stackexchange.com/a/2043065/183923
+
+    cv::Vec2f mc = linearParameters(line);
+    float m = mc[0];
+    float factor = sqrtf((d * d) / (1 + (1 / (m * m))));
+
+    float x3, y3, x4, y4, x5, y5, x6, y6;
+    // special case(vertical perpendicular line) when -1/m -> -infinity
+    if (m == 0) {
+        x3 = line[0];
+        y3 = line[1] + d;
+        x4 = line[0];
+        y4 = line[1] - d;
+        x5 = line[2];
+        y5 = line[3] + d;
+        x6 = line[2];
+        y6 = line[3] - d;
+    } else {
+        // slope of perpendicular lines
+        float m_per = -1 / m;
+
+        // y1 = m_per * x1 + c_per
+        float c_per1 = line[1] - m_per * line[0];
+        float c_per2 = line[3] - m_per * line[2];
+
+        // coordinates of perpendicular lines
+        x3 = line[0] + factor;
+        y3 = m_per * x3 + c_per1;
+        x4 = line[0] - factor;
+        y4 = m_per * x4 + c_per1;
+        x5 = line[2] + factor;
+        y5 = m_per * x5 + c_per2;
+        x6 = line[2] - factor;
+        y6 = m_per * x6 + c_per2;
+    }
+
+    contour[0] = cv::Point2i(x3, y3);
+    contour[1] = cv::Point2i(x4, y4);
+    contour[2] = cv::Point2i(x6, y6);
+    contour[3] = cv::Point2i(x5, y5);
+}
+
+LineSegmentGeometry getLineSegmentGeometry(const cv::Vec4i& l, const LineClusteringParams& params) {
+    LineSegmentGeometry geometry;
+    // extend lines by percentage of line width
+    float len = sqrtf((l[2] - l[0]) * (l[2] - l[0]) +
+                      (l[3] - l[1]) * (l[3] - l[1]));
+    geometry.extended_line = extendedLine(l, len * params.extension_length_fraction);
+    geometry.angle = atan(linearParameters(geometry.extended_line)[0]);
+
+    // calculate window around extended line
+    boundingRectangleContour(geometry.extended_line, params.bounding_rectangle_thickness / 2,
+                             geometry.contour);
+    int min_x = geometry.contour[0].x, max_x = min_x;
+    int min_y = geometry.contour[0].y, max_y = min_y;
+    for (int i = 1; i < 4; ++i) {
+        min_x = std::min(min_x, geometry.contour[i].x);
+        max_x = std::max(max_x, geometry.contour[i].x);
+        min_y = std::min(min_y, geometry.contour[i].y);
+        max_y = std::max(max_y, geometry.contour[i].y);
+    }
+    geometry.contour_bounds = cv::Rect2i(min_x, min_y, max_x - min_x, max_y - min_y);
+    return geometry;
+}
+
+bool isAngleClose(float a1, float a2, const LineClusteringParams& params) {
+    return !(fabs(a1 - a2) > params.max_angle_diff * M_PI / 180.0);
+}
+
+// A point strictly inside the rectangle of a segment
+bool isInsideRectangle(const LineSegmentGeometry& geometry, cv::Point2i point) {
+    const cv::Rect2i& bounds = geometry.contour_bounds;
+    if (point.x < bounds.x || point.x > bounds.x + bounds.width ||
+        point.y < bounds.y || point.y > bounds.y + bounds.height) {
+        return false;
+    }
+    // Header on the contour, no copy
+    cv::Mat contour(4, 1, CV_32SC2, const_cast<cv::Point2i*>(geometry.contour));
+    return cv::pointPolygonTest(contour, point, false) == 1;
+}
+
+// At least one point of the extended line of g2 needs to be inside the
+// extended bounding rectangle of g1. Angles are checked by the caller
+bool isEquivalent(const LineSegmentGeometry& g1, const LineSegmentGeometry& g2) {
+    const cv::Vec4i& el2 = g2.extended_line;
+    return isInsideRectangle(g1, cv::Point2i(el2[0], el2[1])) ||
+           isInsideRectangle(g1, cv::Point2i(el2[2], el2[3]));
+}
+
+int findRoot(std::vector<int>& parents, int i) {
+    int root = i;
+    while (parents[root] != root) {
+        root = parents[root];
+    }
+    // Path compression
+    while (parents[i] != root) {
+        int parent = parents[i];
+        parents[i] = root;
+        i = parent;
+    }
+    return root;
+}
+
+}  // namespace
+
+bool extendedBoundingRectangleLineEquivalence(const cv::Vec4i& l1, const cv::Vec4i& l2,
+                                              const LineClusteringParams& params) {
+    LineSegmentGeometry g1 = getLineSegmentGeometry(l1, params);
+    LineSegmentGeometry g2 = getLineSegmentGeometry(l2, params);
+
+    // reject the lines that have wide difference in angles
+    if (!isAngleClose(g1.angle, g2.angle, params)) {
+        return false;
+    }
+    return isEquivalent(g1, g2);
+}
+
+int clusterLines(const std::vector<cv::Vec4i>& lines, std::vector<int>& labels,
+                 const LineClusteringParams& params) {
+    LineClusteringWorkspace workspace;
+    return clusterLines(lines, labels, params, workspace);
+}
+
+int clusterLines(const std::vector<cv::Vec4i>& lines, std::vector<int>& labels,
+                 const LineClusteringParams& params, LineClusteringWorkspace& workspace) {
+    int n_lines = lines.size();
+    std::vector<LineSegmentGeometry>& geometries = workspace.geometries;
+    geometries.resize(n_lines);
+    for (int i = 0; i < n_lines; ++i) {
+        geometries[i] = getLineSegmentGeometry(lines[i], params);
+    }
+
+    // Segments by increasing angle (then index). As the difference of
+    // angles only grows along this order, the sweep from a segment stops at
+    // the first one whose angle is too far
+    std::vector<int>& order = workspace.order;
+    order.resize(n_lines);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&geometries](int a, int b) {
+        return geometries[a].angle < geometries[b].angle ||
+               (geometries[a].angle == geometries[b].angle && a < b);
+    });
+
+    std::vector<int>& parents = workspace.parents;
+    std::vector<int>& ranks = workspace.ranks;
+    parents.resize(n_lines);
+    ranks.assign(n_lines, 0);
+    std::iota(parents.begin(), parents.end(), 0);
+    for (int p = 0; p < n_lines; ++p) {
+        int i = order[p];
+        for (int q = p + 1; q < n_lines; ++q) {
+            int j = order[q];
+            if (!isAngleClose(geometries[i].angle, geometries[j].angle, params)) break;
+
+            int root_i = findRoot(parents, i);
+            int root_j = findRoot(parents, j);
+            if (root_i == root_j) continue;
+
+            // Both ways, as cv::partition
+            if (isEquivalent(geometries[i], geometries[j]) || isEquivalent(geometries[j], geometries[i])) {
+                if (ranks[root_i] < ranks[root_j]) std::swap(root_i, root_j);
+                parents[root_j] = root_i;
+                if (ranks[root_i] == ranks[root_j]) ++ranks[root_i];
+            }
+        }
+    }
+
+    // Labels by first occurrence, as cv::partition
+    labels.assign(n_lines, -1);
+    std::vector<int>& root_labels = workspace.root_labels;
+    root_labels.assign(n_lines, -1);
+    int n_classes = 0;
+    for (int i = 0; i < n_lines; ++i) {
+        int root = findRoot(parents, i);
+        if (root_labels[root] < 0) {
+            root_labels[root] = n_classes++;
+        }
+        labels[i] = root_labels[root];
+    }
+    return n_classes;
+}
@@ -0,0 +1,57 @@
+#ifndef LINE_CLUSTERING_H
+#define LINE_CLUSTERING_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+// Clustering of line segments (e.g. from HoughLinesP) into lines.
+// Two segments are equivalent if, once each is extended by
+// extension_length_fraction of its length, their angles differ by at most
+// max_angle_diff degrees and an end point of one is inside the rectangle
+// of thickness bounding_rectangle_thickness around the other.
+// Clusters are the connected components of this relation
+struct LineClusteringParams {
+    float extension_length_fraction = 0.1f;
+    float max_angle_diff = 2.0f;
+    float bounding_rectangle_thickness = 20;
+};
+
+// What the equivalence test needs of a segment
+struct LineSegmentGeometry {
+    cv::Vec4i extended_line;
+    float angle;                 // Of the extended line, in radians
+    cv::Point2i contour[4];      // Rectangle around the extended line
+    cv::Rect2i contour_bounds;   // Bounding box of contour (inclusive)
+};
+
+// Buffers of clusterLines(), kept between calls to avoid allocations
+struct LineClusteringWorkspace {
+    std::vector<LineSegmentGeometry> geometries;
+    std::vector<int> order;
+    std::vector<int> parents;
+    std::vector<int> ranks;
+    std::vector<int> root_labels;
+};
+
+// Equivalence of two segments, one way: an end point of l2 is inside the
+// rectangle of l1. To be used with cv::partition, which tries both ways
+bool extendedBoundingRectangleLineEquivalence(const cv::Vec4i& l1, const cv::Vec4i& l2,
+                                              const LineClusteringParams& params);
+
+// Same clusters and labels as
+//   cv::partition(lines, labels, extendedBoundingRectangleLineEquivalence)
+// (labels numbered by first occurrence in lines). Return the number of
+// clusters.
+// The geometry of each segment is computed once. Segments are sorted by
+// angle, so that each segment is only compared with the next segments
+// whose angle is close enough (sorted sweep), and rectangles are rejected
+// by their bounding boxes before the exact test. Segments are merged with
+// union-find, skipping pairs already in the same cluster
+int clusterLines(const std::vector<cv::Vec4i>& lines, std::vector<int>& labels,
+                 const LineClusteringParams& params = LineClusteringParams());
+// Same, reusing the buffers of workspace: no allocation once the buffers
+// (and labels) have grown to the number of segments
+int clusterLines(const std::vector<cv::Vec4i>& lines, std::vector<int>& labels,
+                 const LineClusteringParams& params, LineClusteringWorkspace& workspace);
+
+#endif
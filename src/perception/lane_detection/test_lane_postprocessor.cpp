@@ -0,0 +1,248 @@
+// Test of LanePostprocessor (no model needed): ego lane lines of synthetic
+// lines, and lane lines of a synthetic lane mask at the resolution of
+// the network. Processing should allocate nothing once its workspace has
+// grown, except in HoughLinesP: process() and the tracked postprocessing
+// of LaneDetector must allocate exactly as much as their HoughLinesP calls.
+// Allocations are counted through operator new, and through the default
+// allocator of cv::Mat for Mat buffers (cv::fastMalloc).
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <opencv2/opencv.hpp>
+
+#include "lane_postprocessor.h"
+#include "tracked_lane_postprocessor.h"
+#include "configs/config_lane_detection.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+std::atomic<size_t> n_allocations(0);
+
+void* operator new(size_t size) {
+    ++n_allocations;
+    void* p = std::malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+#if CV_VERSION_MAJOR >= 4
+typedef cv::AccessFlag MatAccessFlag;
+#else
+typedef int MatAccessFlag;
+#endif
+
+// Counts the Mat buffers allocated by cv::Mat::create(), and leaves the
+// allocation itself to the standard allocator
+class CountingMatAllocator : public cv::MatAllocator {
+   public:
+    mutable std::atomic<size_t> n_mats{0};
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data, size_t* step,
+                           MatAccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        ++n_mats;
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+
+    bool allocate(cv::UMatData* data, MatAccessFlag flags, cv::UMatUsageFlags usage_flags) const override {
+        return cv::Mat::getStdAllocator()->allocate(data, flags, usage_flags);
+    }
+
+    void deallocate(cv::UMatData* data) const override {
+        cv::Mat::getStdAllocator()->deallocate(data);
+    }
+};
+
+CountingMatAllocator mat_allocator;
+
+struct AllocationCount {
+    size_t n_new;
+    size_t n_mats;
+};
+
+AllocationCount countAllocations() {
+    return {n_allocations, mat_allocator.n_mats};
+}
+
+AllocationCount countAllocationsSince(const AllocationCount& before) {
+    AllocationCount now = countAllocations();
+    return {now.n_new - before.n_new, now.n_mats - before.n_mats};
+}
+
+// Ego lane lines in a 1280x720 image (center column 640, last row 719)
+bool testFindEgoLaneLines() {
+    bool ok = true;
+    cv::Size size(1280, 720);
+    cv::Vec4i outer_left(100, 720, 500, 0);      // Bottom row at x = 101
+    cv::Vec4i left(300, 720, 600, 0);            // Bottom row at x = 300
+    cv::Vec4i right(1000, 720, 700, 0);          // Bottom row at x = 1000
+    cv::Vec4i left_side(0, 700, 500, 0);         // Left column at y = 700
+    cv::Vec4i right_side(1280, 710, 800, 0);     // Right column at y = 709
+
+    EgoLaneLines ego = findEgoLaneLines({outer_left, right, left}, size);
+    ok &= check(ego.left == 2 && ego.right == 1, "nearest lines on the bottom row");
+    ok &= check(ego.left_pos == -340 && ego.right_pos == 360, "positions on the bottom row");
+
+    ego = findEgoLaneLines({}, size);
+    ok &= check(ego.left == -1 && ego.right == -1, "no line");
+
+    ego = findEgoLaneLines({left_side, right_side}, size);
+    ok &= check(ego.left == 0 && ego.right == 1, "lines on the sides");
+    ok &= check(ego.left_pos == -659 && ego.right_pos == 650, "positions on the sides");
+
+    ego = findEgoLaneLines({right_side, left_side, outer_left}, size);
+    ok &= check(ego.left == 2 && ego.right == 0, "bottom row before the sides");
+
+    // More lines than a uchar line id image could tell apart
+    std::vector<cv::Vec4i> many_lines(300, outer_left);
+    many_lines.push_back(left);
+    ego = findEgoLaneLines(many_lines, size);
+    ok &= check(ego.left == 300 && ego.right == -1, "more than 255 lines");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{frames         |20    | number of frames to count allocations on }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("LanePostprocessor test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+    int n_frames = std::max(1, parser.get<int>("frames"));
+    cv::Mat::setDefaultAllocator(&mat_allocator);
+    bool ok = testFindEgoLaneLines();
+
+    // Two lanes meeting towards the horizon in the mask of a 1280x720
+    // frame: bottom row at x = 250 and x = 1050 in the frame. And the same
+    // with some noise
+    cv::Size frame_size(1280, 720);
+    cv::Mat clean_lane_mask = cv::Mat::zeros(384, 384, CV_8U);
+    cv::line(clean_lane_mask, cv::Point(75, 383), cv::Point(180, 213), cv::Scalar(255), 4);
+    cv::line(clean_lane_mask, cv::Point(315, 383), cv::Point(210, 213), cv::Scalar(255), 4);
+    cv::Mat lane_mask = clean_lane_mask.clone();
+    cv::RNG rng(1234);
+    for (int i = 0; i < 60; ++i) {
+        cv::circle(lane_mask, cv::Point(rng.uniform(0, 384), rng.uniform(0, 384)), 1, cv::Scalar(255), -1);
+    }
+
+    LanePostprocessor postprocessor;
+    std::vector<LaneLine> lane_lines;
+    bool lane_departure = false;
+
+    // Warm up: buffers grow to the size of a frame
+    for (int i = 0; i < 3; ++i) {
+        postprocessor.process(lane_mask, frame_size, lane_lines, lane_departure, Timer::getCurrentTime());
+    }
+    int n_left = 0, n_right = 0;
+    for (const LaneLine& line : lane_lines) {
+        n_left += line.type == LeftLaneLine;
+        n_right += line.type == RightLaneLine;
+    }
+    ok &= check(n_left == 1 && n_right == 1, "one left and one right lane line");
+    for (const LaneLine& line : lane_lines) {
+        EgoLaneLines ego = findEgoLaneLines(std::vector<cv::Vec4i>(1, line.line), frame_size);
+        if (line.type == LeftLaneLine) {
+            ok &= check(std::abs(ego.left_pos - (250 - 640)) < 10, "left lane line in frame coordinates");
+        } else if (line.type == RightLaneLine) {
+            ok &= check(std::abs(ego.right_pos - (1050 - 640)) < 10, "right lane line in frame coordinates");
+        }
+    }
+    std::vector<LaneLine> expected_lane_lines = lane_lines;
+
+    // Postprocessing of the segments of a frame: no allocation at all
+    // Same parameters as process(), scaled by 0.4 from 1280x720 to 384x384
+    std::vector<cv::Vec4i> segments;
+    cv::HoughLinesP(lane_mask, segments, 1, CV_PI / 180, 16, 2, 20);
+    postprocessor.processSegments(segments, lane_mask.size(), frame_size, lane_lines, lane_departure, Timer::getCurrentTime());
+    AllocationCount before = countAllocations();
+    for (int i = 0; i < n_frames; ++i) {
+        postprocessor.processSegments(segments, lane_mask.size(), frame_size, lane_lines, lane_departure, Timer::getCurrentTime());
+    }
+    AllocationCount postprocessing = countAllocationsSince(before);
+    ok &= check(postprocessing.n_new == 0 && postprocessing.n_mats == 0, "no allocation in postprocessing");
+    ok &= check(lane_lines.size() == expected_lane_lines.size(), "same lane lines from segments");
+    for (size_t i = 0; i < lane_lines.size() && i < expected_lane_lines.size(); ++i) {
+        ok &= check(lane_lines[i].line == expected_lane_lines[i].line &&
+                    lane_lines[i].type == expected_lane_lines[i].type, "same lane line from segments");
+    }
+
+    // Whole processing: the only allocations left are the scratch memory
+    // of HoughLinesP, which depends on the mask only
+    before = countAllocations();
+    for (int i = 0; i < n_frames; ++i) {
+        cv::HoughLinesP(lane_mask, segments, 1, CV_PI / 180, 16, 2, 20);
+    }
+    AllocationCount hough = countAllocationsSince(before);
+    before = countAllocations();
+    for (int i = 0; i < n_frames; ++i) {
+        postprocessor.process(lane_mask, frame_size, lane_lines, lane_departure, Timer::getCurrentTime());
+    }
+    AllocationCount processing = countAllocationsSince(before);
+    ok &= check(processing.n_new == hough.n_new && processing.n_mats == hough.n_mats,
+                "no allocation in process() but in HoughLinesP");
+
+    // Tracked postprocessing of LaneDetector, searching around the locked
+    // lines. Without noise, the search bands keep the whole mask: same
+    // HoughLinesP input as the full search. The whole mask is also
+    // processed once every LANE_TRACKER_SCENE_CHECK_INTERVAL frames
+    TrackedLanePostprocessor tracked_postprocessor;
+    Timer::time_point_t start = Timer::getCurrentTime();
+    int frame = 0;
+    for (; frame < LANE_TRACKER_MIN_HITS + 2 * LANE_TRACKER_SCENE_CHECK_INTERVAL; ++frame) {
+        tracked_postprocessor.process(clean_lane_mask, frame_size, lane_lines, lane_departure,
+                                      start + std::chrono::milliseconds(33 * frame));
+    }
+    ok &= check(tracked_postprocessor.isLocked() || !LANE_DETECTION_USE_TRACKER, "tracked lines locked");
+    before = countAllocations();
+    for (int i = 0; i < n_frames; ++i) {
+        cv::HoughLinesP(clean_lane_mask, segments, 1, CV_PI / 180, 16, 2, 20);
+    }
+    AllocationCount clean_hough = countAllocationsSince(before);
+    // Whole intervals: one scene check per interval, whatever the phase
+    int n_tracked_frames = (n_frames + LANE_TRACKER_SCENE_CHECK_INTERVAL - 1) /
+                           LANE_TRACKER_SCENE_CHECK_INTERVAL * LANE_TRACKER_SCENE_CHECK_INTERVAL;
+    int n_hough_calls = n_tracked_frames +
+                        (LANE_DETECTION_USE_TRACKER ? n_tracked_frames / LANE_TRACKER_SCENE_CHECK_INTERVAL : 0);
+    before = countAllocations();
+    for (int i = 0; i < n_tracked_frames; ++i, ++frame) {
+        tracked_postprocessor.process(clean_lane_mask, frame_size, lane_lines, lane_departure,
+                                      start + std::chrono::milliseconds(33 * frame));
+    }
+    AllocationCount tracked_processing = countAllocationsSince(before);
+    ok &= check(tracked_processing.n_new == clean_hough.n_new / n_frames * n_hough_calls &&
+                tracked_processing.n_mats == clean_hough.n_mats / n_frames * n_hough_calls,
+                "no allocation in tracked postprocessing but in HoughLinesP");
+    n_left = n_right = 0;
+    for (const LaneLine& line : lane_lines) {
+        n_left += line.type == LeftLaneLine;
+        n_right += line.type == RightLaneLine;
+    }
+    ok &= check(n_left == 1 && n_right == 1, "one left and one right tracked lane line");
+
+    cout << "Allocations per frame (operator new, Mat): postprocessing "
+         << postprocessing.n_new / n_frames << ", " << postprocessing.n_mats / n_frames
+         << "; HoughLinesP " << static_cast<double>(hough.n_new) / n_frames << ", "
+         << static_cast<double>(hough.n_mats) / n_frames
+         << "; process() " << static_cast<double>(processing.n_new) / n_frames << ", "
+         << static_cast<double>(processing.n_mats) / n_frames
+         << "; tracked " << static_cast<double>(tracked_processing.n_new) / n_tracked_frames << ", "
+         << static_cast<double>(tracked_processing.n_mats) / n_tracked_frames << endl;
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,265 @@
+// Test of LaneTracker on synthetic lane lines (no model needed): lock after
+// LANE_TRACKER_MIN_HITS frames, coasting through frames without detection,
+// loss after LANE_TRACKER_MAX_MISSES frames, reset on a time gap, the
+// search band mask around the locked lines, and the scene checks of
+// TrackedLanePostprocessor while searching in the bands.
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "lane_tracker.h"
+#include "tracked_lane_postprocessor.h"
+#include "configs/config_lane_detection.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+const cv::Size kFrameSize(1280, 720);
+const int kFrameInterval = 33;  // ms
+
+// Ego lane lines of a 1280x720 frame, crossing the bottom border at
+// x = 300 and x = 1000
+const cv::Vec4i kLeftLine(300, 720, 600, 0);
+const cv::Vec4i kRightLine(1000, 720, 700, 0);
+
+float lineX(const cv::Vec4i& line, float y) {
+    return line[0] + (y - line[1]) * (line[2] - line[0]) / (line[3] - line[1]);
+}
+
+// Update with the given lines, at frame `frame` of a sequence starting at
+// start. Return lane_departure
+bool updateTracker(LaneTracker& tracker, std::vector<LaneLine>& lane_lines, const std::vector<LaneLine>& detected,
+                   Timer::time_point_t start, int frame) {
+    lane_lines = detected;
+    bool lane_departure = true;
+    tracker.update(lane_lines, lane_departure, kFrameSize,
+                   start + std::chrono::milliseconds(frame * kFrameInterval));
+    return lane_departure;
+}
+
+// The line of type in lane_lines is near expected, on the bottom row and
+// at LANE_TRACKER_TOP_ROW
+bool hasLine(const std::vector<LaneLine>& lane_lines, lane_line_type type, const cv::Vec4i& expected) {
+    int n_found = 0;
+    bool near = false;
+    for (const LaneLine& lane_line : lane_lines) {
+        if (lane_line.type != type) continue;
+        ++n_found;
+        float top_row = kFrameSize.height * LANE_TRACKER_TOP_ROW;
+        float bottom_row = kFrameSize.height - 1;
+        near = std::abs(lineX(lane_line.line, bottom_row) - lineX(expected, bottom_row)) < 2 &&
+               std::abs(lineX(lane_line.line, top_row) - lineX(expected, top_row)) < 2;
+    }
+    return n_found == 1 && near;
+}
+
+bool testLockAndLoss(Timer::time_point_t start) {
+    bool ok = true;
+    LaneTracker tracker;
+    std::vector<LaneLine> lane_lines;
+    const std::vector<LaneLine> detected = {LaneLine(kLeftLine, LeftLaneLine), LaneLine(kRightLine, RightLaneLine)};
+    int frame = 0;
+
+    cv::Mat search_mask;
+    for (; frame < LANE_TRACKER_MIN_HITS - 1; ++frame) {
+        updateTracker(tracker, lane_lines, detected, start, frame);
+        ok &= check(!tracker.isLocked(), "not locked before min hits");
+        ok &= check(!tracker.getSearchMask(cv::Size(384, 384), search_mask), "no search mask before lock");
+    }
+    updateTracker(tracker, lane_lines, detected, start, frame++);
+    ok &= check(tracker.isLocked(), "locked after min hits");
+    ok &= check(hasLine(lane_lines, LeftLaneLine, kLeftLine) && hasLine(lane_lines, RightLaneLine, kRightLine),
+                "tracked lines on the detected lines");
+
+    // Coasting: tracked lines without detection. A left line far from
+    // the tracked one is not associated, and is not a line of the ego lane
+    const std::vector<LaneLine> far_left = {LaneLine(cv::Vec4i(50, 720, 450, 0), LeftLaneLine)};
+    for (int i = 0; i < LANE_TRACKER_MAX_MISSES; ++i, ++frame) {
+        updateTracker(tracker, lane_lines, i % 2 == 0 ? far_left : std::vector<LaneLine>(), start, frame);
+        ok &= check(tracker.isLocked(), "still locked while missed");
+        ok &= check(hasLine(lane_lines, LeftLaneLine, kLeftLine) && hasLine(lane_lines, RightLaneLine, kRightLine),
+                    "tracked lines while missed");
+    }
+    ok &= check(lane_lines.size() == 3 && lane_lines[0].type == OtherLaneLine,
+                "line out of the band is not associated");
+
+    // Lost after max misses
+    updateTracker(tracker, lane_lines, std::vector<LaneLine>(), start, frame++);
+    ok &= check(!tracker.isLocked(), "lost after max misses");
+    ok &= check(lane_lines.empty(), "no line once lost");
+    ok &= check(!tracker.getSearchMask(cv::Size(384, 384), search_mask), "no search mask once lost");
+
+    // Found again: min hits again before lock
+    for (int i = 0; i < LANE_TRACKER_MIN_HITS - 1; ++i, ++frame) {
+        updateTracker(tracker, lane_lines, detected, start, frame);
+    }
+    ok &= check(!tracker.isLocked(), "not locked again before min hits");
+    updateTracker(tracker, lane_lines, detected, start, frame++);
+    ok &= check(tracker.isLocked(), "locked again after min hits");
+    return ok;
+}
+
+bool testReset(Timer::time_point_t start) {
+    bool ok = true;
+    LaneTracker tracker;
+    std::vector<LaneLine> lane_lines;
+    const std::vector<LaneLine> detected = {LaneLine(kLeftLine, LeftLaneLine), LaneLine(kRightLine, RightLaneLine)};
+    int frame = 0;
+    for (; frame < LANE_TRACKER_MIN_HITS; ++frame) {
+        updateTracker(tracker, lane_lines, detected, start, frame);
+    }
+    ok &= check(tracker.isLocked(), "locked");
+
+    // Frames after a gap are not predicted from the old ones
+    int gap_frames = LANE_TRACKER_MAX_GAP / kFrameInterval + 2;
+    frame += gap_frames;
+    updateTracker(tracker, lane_lines, detected, start, frame);
+    ok &= check(!tracker.isLocked(), "reset after a time gap");
+
+    for (int i = 1; i < LANE_TRACKER_MIN_HITS; ++i) {
+        updateTracker(tracker, lane_lines, detected, start, ++frame);
+    }
+    ok &= check(tracker.isLocked(), "locked after the gap");
+
+    // Nor frames going back in time
+    updateTracker(tracker, lane_lines, detected, start, frame - 1);
+    ok &= check(!tracker.isLocked(), "reset when time goes backwards");
+
+    for (int i = 0; i < LANE_TRACKER_MIN_HITS; ++i) {
+        updateTracker(tracker, lane_lines, detected, start, ++frame);
+    }
+    tracker.reset();
+    ok &= check(!tracker.isLocked(), "not locked after reset");
+    return ok;
+}
+
+bool testLaneDeparture(Timer::time_point_t start) {
+    bool ok = true;
+    LaneTracker tracker;
+    std::vector<LaneLine> lane_lines;
+    // Car on the left line: bottom x at 500 (left) and 1150 (right)
+    const std::vector<LaneLine> detected = {
+        LaneLine(cv::Vec4i(500, 720, 620, 0), LeftLaneLine), LaneLine(cv::Vec4i(1150, 720, 720, 0), RightLaneLine)};
+    int frame = 0;
+    for (; frame < LANE_TRACKER_MIN_HITS - 1; ++frame) {
+        ok &= check(!updateTracker(tracker, lane_lines, detected, start, frame), "no lane departure before lock");
+    }
+    ok &= check(updateTracker(tracker, lane_lines, detected, start, frame++), "lane departure once locked");
+    ok &= check(updateTracker(tracker, lane_lines, std::vector<LaneLine>(), start, frame++), "lane departure while coasting");
+
+    const std::vector<LaneLine> centered = {LaneLine(kLeftLine, LeftLaneLine), LaneLine(kRightLine, RightLaneLine)};
+    tracker.reset();
+    for (int i = 0; i < LANE_TRACKER_MIN_HITS; ++i, ++frame) {
+        ok &= check(!updateTracker(tracker, lane_lines, centered, start, frame), "no lane departure in the lane");
+    }
+    return ok;
+}
+
+bool testSearchMask(Timer::time_point_t start) {
+    bool ok = true;
+    LaneTracker tracker;
+    std::vector<LaneLine> lane_lines;
+    const std::vector<LaneLine> detected = {LaneLine(kLeftLine, LeftLaneLine), LaneLine(kRightLine, RightLaneLine)};
+    for (int frame = 0; frame < LANE_TRACKER_MIN_HITS; ++frame) {
+        updateTracker(tracker, lane_lines, detected, start, frame);
+    }
+
+    // Mask at the resolution of the network
+    cv::Size mask_size(384, 384);
+    cv::Mat search_mask;
+    ok &= check(tracker.getSearchMask(mask_size, search_mask), "search mask once locked");
+    ok &= check(search_mask.size() == mask_size && search_mask.type() == CV_8U, "size and type of the mask");
+
+    float scale_x = static_cast<float>(mask_size.width) / kFrameSize.width;
+    float scale_y = static_cast<float>(mask_size.height) / kFrameSize.height;
+    float half_width = LANE_TRACKER_SEARCH_BAND * mask_size.width;
+    for (int row : {mask_size.height / 2, mask_size.height * 3 / 4, mask_size.height - 1}) {
+        float frame_y = (row + 0.5f) / scale_y - 0.5f;
+        int left_x = cvRound((lineX(kLeftLine, frame_y) + 0.5f) * scale_x - 0.5f);
+        int right_x = cvRound((lineX(kRightLine, frame_y) + 0.5f) * scale_x - 0.5f);
+        const uchar* mask_row = search_mask.ptr<uchar>(row);
+        ok &= check(mask_row[left_x] && mask_row[right_x], "lines inside the bands");
+        ok &= check(mask_row[cvRound(left_x + half_width) - 2] && mask_row[cvRound(right_x - half_width) + 2],
+                    "band width");
+        ok &= check(!mask_row[cvRound(left_x - half_width) - 3] && !mask_row[cvRound(right_x + half_width) + 3],
+                    "outside of the bands");
+        ok &= check(!mask_row[(left_x + right_x) / 2], "center of the lane outside of the bands");
+    }
+    return ok;
+}
+
+// Lane mask (network resolution) of a car on the left line of its lane:
+// bottom row at x = 560 and x = 1150 in the frame. With a crosswalk on the
+// left of the lane, outside of the search bands
+cv::Mat makeDepartureMask(bool crosswalk) {
+    cv::Mat lane_mask = cv::Mat::zeros(384, 384, CV_8U);
+    cv::line(lane_mask, cv::Point(168, 383), cv::Point(190, 213), cv::Scalar(255), 4);
+    cv::line(lane_mask, cv::Point(345, 383), cv::Point(230, 213), cv::Scalar(255), 4);
+    if (crosswalk) {
+        for (int y = 300; y <= 360; y += 20) {
+            cv::line(lane_mask, cv::Point(10, y), cv::Point(120, y), cv::Scalar(255), 3);
+        }
+    }
+    return lane_mask;
+}
+
+bool testSceneClutter(Timer::time_point_t start) {
+    bool ok = true;
+    if (!LANE_DETECTION_USE_TRACKER) {
+        return ok;
+    }
+    TrackedLanePostprocessor postprocessor;
+    std::vector<LaneLine> lane_lines;
+    bool lane_departure = false;
+    cv::Mat lane_mask = makeDepartureMask(false);
+    cv::Mat crosswalk_mask = makeDepartureMask(true);
+    auto process = [&](const cv::Mat& mask, int frame) {
+        postprocessor.process(mask, kFrameSize, lane_lines, lane_departure,
+                              start + std::chrono::milliseconds(frame * kFrameInterval));
+    };
+
+    // Locked, with enough frames for the lane departure history
+    int frame = 0;
+    for (; frame < 10; ++frame) {
+        process(lane_mask, frame);
+    }
+    ok &= check(postprocessor.isLocked(), "locked on the mask");
+    ok &= check(lane_departure, "lane departure on the mask");
+
+    // The crosswalk is not in the bands, but is seen by the scene check
+    for (int i = 0; i < LANE_TRACKER_SCENE_CHECK_INTERVAL; ++i) {
+        process(crosswalk_mask, frame++);
+    }
+    ok &= check(postprocessor.isLocked(), "still locked with the crosswalk");
+    ok &= check(!lane_departure, "no lane departure with a crosswalk outside of the bands");
+
+    for (int i = 0; i < LANE_TRACKER_SCENE_CHECK_INTERVAL; ++i) {
+        process(lane_mask, frame++);
+    }
+    ok &= check(lane_departure, "lane departure again after the crosswalk");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("LaneTracker test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    Timer::time_point_t start = Timer::getCurrentTime();
+    bool ok = testLockAndLoss(start);
+    ok &= testReset(start);
+    ok &= testLaneDeparture(start);
+    ok &= testSearchMask(start);
+    ok &= testSceneClutter(start);
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,82 @@
+// Benchmark of clusterLines() against cv::partition() with the pairwise
+// equivalence, on recorded lane masks (e.g. written by test_lane_detector).
+// Also checks that both give the same labels.
+
+#include <chrono>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "filesystem_include.h"
+#include "line_clustering.h"
+
+using namespace std;
+using namespace cv;
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{input_folder   |      | folder of lane masks (white lanes on black) }"
+        "{repeat         |10    | number of runs of each method on each mask }";
+
+    CommandLineParser parser(argc, argv, keys);
+    parser.about("Line clustering benchmark");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    std::string input_folder = parser.get<std::string>("input_folder");
+    int repeat = std::max(1, parser.get<int>("repeat"));
+    LineClusteringParams params;
+
+    using namespace std::chrono;
+    double partition_time = 0;
+    double clustering_time = 0;
+    size_t n_masks = 0;
+    size_t n_lines = 0;
+    size_t n_mismatches = 0;
+    for (auto& p : fs::recursive_directory_iterator(input_folder)) {
+        if (p.path().extension() != ".png" && p.path().extension() != ".jpg") continue;
+        cv::Mat mask = cv::imread(p.path().string(), cv::IMREAD_GRAYSCALE);
+        if (mask.empty()) continue;
+
+        // Same line detection as LaneDetector
+        cv::Mat thresh = mask > 127;
+        std::vector<cv::Vec4i> lines;
+        HoughLinesP(thresh, lines, 1, CV_PI / 180, 40, 5, 50);
+
+        std::vector<int> partition_labels, clustering_labels;
+        int n_partition_classes = 0, n_clustering_classes = 0;
+        auto start = high_resolution_clock::now();
+        for (int i = 0; i < repeat; ++i) {
+            n_partition_classes = cv::partition(lines, partition_labels,
+                [&params](const cv::Vec4i& l1, const cv::Vec4i& l2) {
+                    return extendedBoundingRectangleLineEquivalence(l1, l2, params);
+                });
+        }
+        auto middle = high_resolution_clock::now();
+        for (int i = 0; i < repeat; ++i) {
+            n_clustering_classes = clusterLines(lines, clustering_labels, params);
+        }
+        auto stop = high_resolution_clock::now();
+
+        partition_time += 0.001 * duration_cast<microseconds>(middle - start).count() / repeat;
+        clustering_time += 0.001 * duration_cast<microseconds>(stop - middle).count() / repeat;
+        ++n_masks;
+        n_lines += lines.size();
+        if (n_partition_classes != n_clustering_classes || partition_labels != clustering_labels) {
+            ++n_mismatches;
+            cout << "Different clusters: " << p.path().string() << endl;
+        }
+    }
+
+    if (n_masks == 0) {
+        cerr << "No mask found in " << input_folder << endl;
+        return 1;
+    }
+    cout << "Masks: " << n_masks << ", avg. segments: " << static_cast<double>(n_lines) / n_masks << endl;
+    cout << "Avg. time cv::partition: " << partition_time / n_masks << " ms" << endl;
+    cout << "Avg. time clusterLines: " << clustering_time / n_masks << " ms" << endl;
+    cout << (n_mismatches == 0 ? "Same clusters on all masks" : "Some clusters differ") << endl;
+    return n_mismatches == 0 ? 0 : 1;
+}
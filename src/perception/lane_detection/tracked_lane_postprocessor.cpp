@@ -0,0 +1,53 @@
+#include "tracked_lane_postprocessor.h"
+
+#include "configs/config_lane_detection.h"
+
+void TrackedLanePostprocessor::process(const cv::Mat& lane_mask, cv::Size frame_size,
+                                       std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                                       Timer::time_point_t time) {
+    if (!LANE_DETECTION_USE_TRACKER) {
+        postprocessor.process(lane_mask, frame_size, lane_lines, lane_departure, time);
+        return;
+    }
+
+    // Once the lines are locked, line segments are only searched in the
+    // bands around them: full search again when a line is lost
+    if (!lane_mask.empty() && tracker.getSearchMask(lane_mask.size(), search_mask)) {
+        cv::bitwise_and(lane_mask, search_mask, tracked_lane_mask);
+        postprocessor.process(tracked_lane_mask, frame_size, lane_lines, lane_departure, time);
+
+        // The bands hide the clutter: check the whole mask from time to time
+        if (++n_frames_since_scene_check >= LANE_TRACKER_SCENE_CHECK_INTERVAL) {
+            bool scene_lane_departure;
+            scene_postprocessor.process(lane_mask, frame_size, scene_lane_lines, scene_lane_departure, time);
+            scene_cluttered = scene_postprocessor.isLaneSceneCluttered();
+            n_frames_since_scene_check = 0;
+        }
+    } else {
+        postprocessor.process(lane_mask, frame_size, lane_lines, lane_departure, time);
+        scene_cluttered = postprocessor.isLaneSceneCluttered();
+        n_frames_since_scene_check = 0;
+    }
+    tracker.update(lane_lines, lane_departure, frame_size, time);
+
+    // Tracked lines may coast through frames without detection, but not
+    // through scenes where the lines are unreliable
+    lane_departure = lane_departure && postprocessor.isLaneSceneReliable() && !scene_cluttered;
+}
+
+void TrackedLanePostprocessor::reset() {
+    tracker.reset();
+}
+
+bool TrackedLanePostprocessor::isLocked() const {
+    return LANE_DETECTION_USE_TRACKER && tracker.isLocked();
+}
+
+void TrackedLanePostprocessor::drawSegments(cv::Mat& detected_lines_img) {
+    postprocessor.drawSegments(detected_lines_img);
+}
+
+void TrackedLanePostprocessor::drawLaneLines(const std::vector<LaneLine>& lane_lines, bool lane_departure,
+                                             cv::Mat& reduced_lines_img) {
+    postprocessor.drawLaneLines(lane_lines, lane_departure, reduced_lines_img);
+}
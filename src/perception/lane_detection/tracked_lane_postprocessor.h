@@ -0,0 +1,53 @@
+#ifndef TRACKED_LANE_POSTPROCESSOR_H
+#define TRACKED_LANE_POSTPROCESSOR_H
+
+#include <vector>
+#include <opencv2/core.hpp>
+
+#include "perception/lane_detection/lane_line.h"
+#include "perception/lane_detection/lane_postprocessor.h"
+#include "perception/lane_detection/lane_tracker.h"
+#include "utils/timer.h"
+
+// Lane postprocessing of LaneDetector: LanePostprocessor on the lane mask,
+// followed by LaneTracker (LANE_DETECTION_USE_TRACKER). Once the lines are
+// locked, line segments are only searched in the bands around them. The
+// clutter of the scene (see LanePostprocessor::isLaneSceneCluttered()) is
+// then checked on the whole mask every LANE_TRACKER_SCENE_CHECK_INTERVAL
+// frames, as crosswalks and stop lines are mostly outside of the bands.
+// Like LanePostprocessor, it allocates nothing once its buffers have grown
+// to the size of a frame (except in HoughLinesP itself).
+// Not thread-safe: one instance per lane detection thread
+class TrackedLanePostprocessor {
+   private:
+    LanePostprocessor postprocessor;
+    LaneTracker tracker;
+    cv::Mat search_mask;
+    cv::Mat tracked_lane_mask;
+
+    // Clutter of the whole mask, while searching in the bands
+    LanePostprocessor scene_postprocessor;
+    std::vector<LaneLine> scene_lane_lines;
+    bool scene_cluttered = false;
+    int n_frames_since_scene_check = 0;
+
+   public:
+    // Same as LanePostprocessor::process(), then tracking of the lines
+    // (see LaneTracker::update())
+    void process(const cv::Mat& lane_mask, cv::Size frame_size,
+                 std::vector<LaneLine>& lane_lines, bool& lane_departure,
+                 Timer::time_point_t time);
+
+    // Forget the tracked lines
+    void reset();
+
+    // Whether segments are only searched around the tracked lines
+    bool isLocked() const;
+
+    // Visualization of the last processed frame (see LanePostprocessor)
+    void drawSegments(cv::Mat& detected_lines_img);
+    void drawLaneLines(const std::vector<LaneLine>& lane_lines, bool lane_departure,
+                       cv::Mat& reduced_lines_img);
+};
+
+#endif
@@ -1,53 +1,164 @@
 #include "object_detector.h"
 
+#include <future>
+
+#include "perception/common/onnx_models/include/ctdetDecoder.h"
+#include "perception/common/inference/opencv_dnn_backend.h"
+
 using namespace std;
 
 ObjectDetector::ObjectDetector() {
 
-    // If plan file is existed => Load it
-    if (fs::exists(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN)) {
+    // Load the sign classifier in parallel with the detection network
+    std::future<std::shared_ptr<TrafficSignClassifier>> sign_classifier_loading =
+        std::async(std::launch::async, []() { return std::make_shared<TrafficSignClassifier>(); });
+
+    InferenceBackendType backend_type = resolveInferenceBackendType(getInferenceBackendType());
+    if (backend_type == kInferenceBackendTensorRT) {
+        backend = createTensorRTBackend();
+        if (!backend && getInferenceBackendType() == kInferenceBackendAuto) {
+            cerr << "Falling back to CPU inference." << endl;
+            backend_type = kInferenceBackendCPU;
+        }
+    }
+    if (backend_type == kInferenceBackendCPU) {
+        backend = createCPUBackend();
+        decode_on_cpu = true;
+    }
+
+    inputData = std::unique_ptr<float[]>(new float[getInputVolume()]);
+    sign_classifier = sign_classifier_loading.get();
+    if (!backend) {
+        cerr << "Error on creating object detection model." << endl;
+        return;
+    }
+    cout << "Object detection backend: " << backend->getName() << endl;
+    async_inference = std::unique_ptr<AsyncInference>(new AsyncInference(backend));
+
+    if (decode_on_cpu) {
+        outputData = std::unique_ptr<float[]>(
+            new float[1 + ctdet::maxDetections * sizeof(Detection) / sizeof(float)]);
+    }
+}
+
+std::shared_ptr<InferenceBackend> ObjectDetector::createTensorRTBackend() {
+
+    std::shared_ptr<ctdet::ctdetNet> net;
+    bool can_build = SMARTCAM_OBJECT_DETECTION_MODE == std::string("FLOAT32") ||
+        SMARTCAM_OBJECT_DETECTION_MODE == std::string("FLOAT16");
+
+    // Reuse the plan file only if it was built from this model, mode and TensorRT version.
+    // Plans in other modes can't be built here: they are used as they are
+    EngineCache engine_cache(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN, SMARTCAM_OBJECT_DETECTION_MODEL,
+        SMARTCAM_OBJECT_DETECTION_MODE, 1, getTensorRTRuntimeVersion());
+    if (engine_cache.isValid() || (!can_build && fs::exists(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN))) {
 
         cout << "Loading TensorRT plan file at: " << SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN << endl;
-        net = new ctdet::ctdetNet(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN);
+        net = std::make_shared<ctdet::ctdetNet>(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN);
+
+    }
 
-    } else { // Else, create engine file
+    if ((!net || !net->isReady()) && can_build) { // Missing, stale or unreadable plan: build it
 
-        cout << "TensorRT plan file not found. Creating a new plan file at: " << SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN << endl;
-        if (SMARTCAM_OBJECT_DETECTION_MODE == std::string("FLOAT32")) {
-            net = new ctdet::ctdetNet(SMARTCAM_OBJECT_DETECTION_MODEL, "", ctdet::RUN_MODE::FLOAT32);
-        } else if (SMARTCAM_OBJECT_DETECTION_MODE == std::string("FLOAT16")) {
-            net = new ctdet::ctdetNet(SMARTCAM_OBJECT_DETECTION_MODEL, "", ctdet::RUN_MODE::FLOAT16);
-        } else {
-            cout << "TensorRT mode " << SMARTCAM_OBJECT_DETECTION_MODE << " is not supported now. Please build model using `build_tensorrt_engine`" << endl;
+        cout << "Creating a new plan file at: " << SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN << endl;
+        ctdet::RUN_MODE mode = SMARTCAM_OBJECT_DETECTION_MODE == std::string("FLOAT16") ?
+            ctdet::RUN_MODE::FLOAT16 : ctdet::RUN_MODE::FLOAT32;
+        net = std::make_shared<ctdet::ctdetNet>(SMARTCAM_OBJECT_DETECTION_MODEL, "", mode);
+        if (net->isReady()) {
+            net->saveEngine(engine_cache);
         }
-        net->saveEngine(SMARTCAM_OBJECT_DETECTION_TENSORRT_PLAN);
 
+    } else if (!net) {
+        cout << "TensorRT mode " << SMARTCAM_OBJECT_DETECTION_MODE << " is not supported now. Please build model using `build_tensorrt_engine`" << endl;
+        return nullptr;
+    }
+
+    if (!net->isReady()) {
+        cerr << "Error on creating TensorRT engine for object detection." << endl;
+        return nullptr;
+    }
+    forward_face = net->forwardFace;
+    return net;
+}
+
+std::shared_ptr<InferenceBackend> ObjectDetector::createCPUBackend() {
+    std::vector<std::string> output_names = SMARTCAM_OBJECT_DETECTION_CPU_OUTPUTS;
+    std::shared_ptr<OpenCVDnnBackend> cpu_backend = std::make_shared<OpenCVDnnBackend>(
+        SMARTCAM_OBJECT_DETECTION_CPU_MODEL, ctdet::channel, ctdet::input_h, ctdet::input_w, output_names);
+    if (!cpu_backend->isReady()) {
+        return nullptr;
     }
-    
-    outputData = std::unique_ptr<float[]>(new float[net->outputBufferSize]);
+    return cpu_backend;
+}
+
+bool ObjectDetector::isReady() {
+    return async_inference != nullptr;
 }
 
 std::vector<TrafficObject> ObjectDetector::detect(const cv::Mat &img, const cv::Mat &original_img) {
+    preprocess(img, inputData.get());
+    std::vector<Detection> detected_objects = infer(inputData.get(), img);
+    return classifySigns(detected_objects, img, original_img);
+}
+
+void ObjectDetector::preprocess(const cv::Mat &img, float *input_data) {
+    prepareImage(img, forward_face, input_data);
+}
+
+cv::Size ObjectDetector::getInputSize() {
+    return cv::Size(ctdet::input_w, ctdet::input_h);
+}
+
+size_t ObjectDetector::getInputVolume() {
+    return ctdet::channel * ctdet::input_h * ctdet::input_w;
+}
+
+int ObjectDetector::submitInference(const float *input_data, const cv::Mat &img) {
+    if (!async_inference) {
+        return -1;
+    }
+    int slot = async_inference->acquire(true);
+    if (slot < 0) {
+        return -1;
+    }
+    slot_images[slot] = img;
+    async_inference->submit(slot, input_data, 1);
+    return slot;
+}
 
-    cv::Mat frame(img);
-    auto inputData = prepareImage(frame, net->forwardFace);
+std::vector<Detection> ObjectDetector::waitInference(int slot) {
+    cv::Mat img = slot_images[slot];
+    slot_images[slot].release();
 
-    net->doInference(inputData.data(), outputData.get());
+    if (!async_inference->wait(slot)) {
+        async_inference->release(slot);
+        cerr << "Error on running object detection model." << endl;
+        return std::vector<Detection>();
+    }
+
+    // Number of detections, then the detections
+    const float *output = async_inference->getOutput(slot, 0);
+    if (decode_on_cpu) {
+        CTdetforward_cpu(async_inference->getOutput(slot, 0), async_inference->getOutput(slot, 1),
+            async_inference->getOutput(slot, 2),
+            outputData.get(), ctdet::input_w / 4, ctdet::input_h / 4, ctdet::classNum,
+            ctdet::kernelSize, ctdet::visThresh, ctdet::maxDetections);
+        output = outputData.get();
+    }
 
-    int num_det = static_cast<int>(outputData[0]);
+    int num_det = static_cast<int>(output[0]);
 
     std::vector<Detection> detected_objects;
     detected_objects.resize(num_det);
-    memcpy(detected_objects.data(), &outputData[1], num_det * sizeof(Detection));
-
-    postProcess(detected_objects, img, net->forwardFace);
+    memcpy(detected_objects.data(), &output[1], num_det * sizeof(Detection));
+    async_inference->release(slot);
+    if (!decode_on_cpu) {
+        // The CUDA kernel appends detections in any order. Same order as
+        // the CPU decoder, but not the same top K above maxDetections peaks
+        sortDetections(detected_objects);
+    }
 
-    // Do traffic sign classification
-    float fx = static_cast<float>(original_img.cols) / img.cols;
-    float fy = static_cast<float>(original_img.rows) / img.rows;
-    std::vector<TrafficObject> traffic_objects;
-    int original_img_height = original_img.rows;
-    int original_img_width = original_img.cols;
+    postProcess(detected_objects, img, forward_face);
 
     // Filter by size
     std::vector<Detection> filtered_detected_object(detected_objects.size());
@@ -56,23 +167,71 @@ std::vector<TrafficObject> ObjectDetector::detect(const cv::Mat &img, const cv::
         d.bbox.y2 - d.bbox.y1 >= MIN_OBJECT_SIZE;
     } );
     filtered_detected_object.resize(std::distance(filtered_detected_object.begin(),it));  // shrink container to new size
-    detected_objects = filtered_detected_object;
+    return filtered_detected_object;
+}
+
+void ObjectDetector::cancelInference(int slot) {
+    slot_images[slot].release();
+    async_inference->release(slot);
+}
+
+std::vector<Detection> ObjectDetector::infer(const float *input_data, const cv::Mat &img) {
+    int slot = submitInference(input_data, img);
+    if (slot < 0) {
+        cerr << "Error on running object detection model." << endl;
+        return std::vector<Detection>();
+    }
+    return waitInference(slot);
+}
+
+std::vector<TrafficObject> ObjectDetector::classifySigns(const std::vector<Detection> &detected_objects,
+    const cv::Mat &img, const cv::Mat &original_img) {
+    std::vector<TrafficObject> traffic_objects;
+    for (const Detection &detection : detected_objects) {
+        traffic_objects.push_back(TrafficObject(detection, ""));
+    }
+    classifySigns(traffic_objects, img, original_img);
+    return traffic_objects;
+}
 
-    // Classify traffic signs
+void ObjectDetector::classifySigns(std::vector<TrafficObject> &traffic_objects,
+    const cv::Mat &img, const cv::Mat &original_img) {
     std::vector<size_t> sign_object_ids;
+    std::future<SignClassificationResult> result = submitSignClassification(
+        traffic_objects, img, original_img, sign_object_ids, 0);
+    waitSignClassification(traffic_objects, sign_object_ids, result);
+}
+
+std::future<SignClassificationResult> ObjectDetector::submitSignClassification(
+    const std::vector<TrafficObject> &traffic_objects, const cv::Mat &img, const cv::Mat &original_img,
+    std::vector<size_t> &sign_object_ids, int max_delay_ms) {
+
+    // Do traffic sign classification
+    float fx = static_cast<float>(original_img.cols) / img.cols;
+    float fy = static_cast<float>(original_img.rows) / img.rows;
+    int original_img_height = original_img.rows;
+    int original_img_width = original_img.cols;
+
+    std::lock_guard<std::mutex> lock(sign_classification_cache_mutex);
+    sign_classification_cache.nextFrame();
+
+    // Classify traffic signs. Tracked signs with a confident
+    // classification reuse it
+    sign_object_ids.clear();
     std::vector<cv::Mat> sign_crops;
-    for (size_t i = 0; i < detected_objects.size(); ++i) {
+    for (size_t i = 0; i < traffic_objects.size(); ++i) {
 
-        if (detected_objects[i].classId == 8) { // Traffic sign
+        if (traffic_objects[i].classId == 8) { // Traffic sign
 
-            int x1 = min(original_img_width - 1, static_cast<int>(fx * detected_objects[i].bbox.x1));
-            int x2 = min(original_img_width - 1, static_cast<int>(fx * detected_objects[i].bbox.x2));
-            int y1 = min(original_img_height - 1, static_cast<int>(fy * detected_objects[i].bbox.y1));
-            int y2 = min(original_img_height - 1, static_cast<int>(fy * detected_objects[i].bbox.y2));
+            int x1 = min(original_img_width - 1, static_cast<int>(fx * traffic_objects[i].bbox.x1));
+            int x2 = min(original_img_width - 1, static_cast<int>(fx * traffic_objects[i].bbox.x2));
+            int y1 = min(original_img_height - 1, static_cast<int>(fy * traffic_objects[i].bbox.y1));
+            int y2 = min(original_img_height - 1, static_cast<int>(fy * traffic_objects[i].bbox.y2));
             int width = x2 - x1;
             int height = y2 - y1;
 
-            if (width > MIN_TRAFFIC_SIGN_SIZE && height > MIN_TRAFFIC_SIGN_SIZE) {
+            if (width > MIN_TRAFFIC_SIGN_SIZE && height > MIN_TRAFFIC_SIGN_SIZE &&
+                sign_classification_cache.needsClassification(traffic_objects[i])) {
 
                 cv::Rect roi(x1, y1, width, height);
                 cv::Mat crop = original_img(roi);
@@ -83,18 +242,46 @@ std::vector<TrafficObject> ObjectDetector::detect(const cv::Mat &img, const cv::
             }
             
         }
-        
-        traffic_objects.push_back(
-            TrafficObject(detected_objects[i], "")
-        );
     }
 
-    std::vector<std::string> sign_names = sign_classifier.getSignNames(sign_crops);
+    return sign_classifier->classify(sign_crops, max_delay_ms);
+}
+
+void ObjectDetector::waitSignClassification(std::vector<TrafficObject> &traffic_objects,
+    const std::vector<size_t> &sign_object_ids, std::future<SignClassificationResult> &pending_result) {
+
+    SignClassificationResult result = pending_result.get();
+    std::lock_guard<std::mutex> lock(sign_classification_cache_mutex);
+
+    // Untracked signs use their own classification, filtered by confidence
     for (size_t i = 0; i < sign_object_ids.size(); ++i) {
-        traffic_objects[sign_object_ids[i]].traffic_sign_type = sign_names[i];
+        TrafficObject &object = traffic_objects[sign_object_ids[i]];
+        float confidence = result.confidences[i];
+        if (object.track_id < 0) {
+            int sign_id = confidence >= SIGN_CLASSIFICATION_THRESH ? result.class_ids[i] : -1;
+            object.traffic_sign_type = sign_classifier->getSignName(sign_id);
+        } else {
+            sign_classification_cache.addVote(object, result.class_ids[i], confidence);
+        }
     }
 
-    return traffic_objects;
+    for (TrafficObject &object : traffic_objects) {
+        if (object.classId == 8 && object.track_id >= 0) {
+            object.traffic_sign_type = sign_classifier->getSignName(
+                sign_classification_cache.getClassId(object));
+        }
+    }
+}
+
+SignClassificationStats ObjectDetector::getSignClassificationStats() {
+    SignClassificationStats stats;
+    {
+        std::lock_guard<std::mutex> lock(sign_classification_cache_mutex);
+        stats.n_requests = sign_classification_cache.getRequestCount();
+        stats.n_classifications = sign_classification_cache.getClassificationCount();
+    }
+    stats.batcher = sign_classifier->getBatcherStats();
+    return stats;
 }
 
 void ObjectDetector::drawDetections(const std::vector<TrafficObject> & result,cv::Mat& img)
@@ -1,27 +1,109 @@
 #ifndef OBJECT_DETECTOR_H
 #define OBJECT_DETECTOR_H
 
+#include <future>
 #include <iostream>
 #include <memory>
+#include <mutex>
 #include <string>
 
 #include "perception/common/onnx_models/include/ctdetNet.h"
+#include "perception/common/inference/inference_backend.h"
+#include "perception/common/inference/async_inference.h"
 #include "traffic_object.h"
+#include "sign_classification_cache.h"
 #include "traffic_sign_classification/sign_classifier.h"
 
 #include "utils/filesystem_include.h"
 #include "configs/config.h"
 
+// Statistics of the traffic sign classification of a detector
+struct SignClassificationStats {
+    uint64_t n_requests = 0;         // Signs large enough to be classified
+    uint64_t n_classifications = 0;  // Signs run through the classifier
+    SignClassificationBatcherStats batcher;
+};
+
 class ObjectDetector {
    private:
-    ctdet::ctdetNet * net;
+    // CenterNet run by TensorRT (heads decoded on the GPU)
+    // or by the CPU backend (heads decoded here)
+    std::shared_ptr<InferenceBackend> backend;
+    std::unique_ptr<AsyncInference> async_inference;
+    bool decode_on_cpu = false;
+    bool forward_face = false;
+
+    std::unique_ptr<float[]> inputData;
     std::unique_ptr<float[]> outputData;
 
-    TrafficSignClassifier sign_classifier;
+    // Image of each inference slot
+    cv::Mat slot_images[kInferenceSlots];
+
+    std::shared_ptr<InferenceBackend> createTensorRTBackend();
+    std::shared_ptr<InferenceBackend> createCPUBackend();
+
+    std::shared_ptr<TrafficSignClassifier> sign_classifier;
+    // Used by both halves of the sign classification, which may run
+    // on different threads
+    SignClassificationCache sign_classification_cache;
+    std::mutex sign_classification_cache_mutex;
 
    public:
+    // The backend is chosen by getInferenceBackendType()
     ObjectDetector();
+
+    // False if no inference backend could be created
+    bool isReady();
     std::vector<TrafficObject> detect(const cv::Mat &img, const cv::Mat &original_img);
+
+    // Stages of detect(), to be run separately by a pipeline.
+    // preprocess() is thread-safe. infer() and classifySigns() use
+    // the networks of this detector and must be called from one thread at a time
+    // Write the network input of img into input_data (getInputVolume() floats).
+    // img may be already fitted into getInputSize() (keeping aspect ratio),
+    // in which case it is only padded
+    void preprocess(const cv::Mat &img, float *input_data);
+    std::vector<Detection> infer(const float *input_data, const cv::Mat &img);
+
+    // infer() in two halves, so that the network runs on a frame while the
+    // detections of the previous frame are decoded. submitInference() waits
+    // for one of the kInferenceSlots inference slots and returns it, or -1
+    // on failure. input_data must be kept unchanged until
+    // waitInference() returns. Both must be called in frame order, and may
+    // be called from different threads
+    int submitInference(const float *input_data, const cv::Mat &img);
+    std::vector<Detection> waitInference(int slot);
+    // Free the slot of a frame given up between the two halves
+    void cancelInference(int slot);
+
+    std::vector<TrafficObject> classifySigns(const std::vector<Detection> &detections,
+        const cv::Mat &img, const cv::Mat &original_img);
+    // Set traffic_sign_type of the traffic signs of objects. Signs of
+    // tracked objects (track_id >= 0) go through the classification cache:
+    // call it on every frame, in frame order
+    void classifySigns(std::vector<TrafficObject> &objects,
+        const cv::Mat &img, const cv::Mat &original_img);
+
+    // classifySigns() in two halves, so that the crops of several frames
+    // can be classified in one batch. submitSignClassification() writes
+    // the indices in objects of the signs being classified, which are
+    // batched with other crops queued within max_delay_ms.
+    // waitSignClassification() waits for the result and sets the types of
+    // the signs. Both must be called in frame order, and may be called
+    // from different threads
+    std::future<SignClassificationResult> submitSignClassification(
+        const std::vector<TrafficObject> &objects, const cv::Mat &img, const cv::Mat &original_img,
+        std::vector<size_t> &sign_object_ids, int max_delay_ms = SIGN_CLASSIFICATION_MAX_BATCH_DELAY);
+    void waitSignClassification(std::vector<TrafficObject> &objects,
+        const std::vector<size_t> &sign_object_ids, std::future<SignClassificationResult> &result);
+    // Thread-safe
+    SignClassificationStats getSignClassificationStats();
+
+    // Size of the network input
+    static cv::Size getInputSize();
+    // Number of floats in the network input
+    static size_t getInputVolume();
+
     void drawDetections(const std::vector<TrafficObject> & result,cv::Mat& img);
 
     bool isInStrVector(const std::string &value, const std::vector<std::string> &array);
@@ -0,0 +1,153 @@
+#include "object_tracker.h"
+
+#include <algorithm>
+#include <tuple>
+
+#include "configs/config_object_detection.h"
+
+namespace {
+
+// A possible association of a detection with a track
+struct Match {
+    float iou;
+    int track;
+    int detection;
+};
+
+}  // namespace
+
+void ObjectTracker::predict(Timer::time_point_t time) {
+    size_t n_tracks = track_ids.size();
+    px1.resize(n_tracks);
+    py1.resize(n_tracks);
+    px2.resize(n_tracks);
+    py2.resize(n_tracks);
+    for (size_t i = 0; i < n_tracks; ++i) {
+        float dt = Timer::calcDiff(last_seen_times[i], time) / 1000.0f;
+        px1[i] = x1[i] + vx1[i] * dt;
+        py1[i] = y1[i] + vy1[i] * dt;
+        px2[i] = x2[i] + vx2[i] * dt;
+        py2[i] = y2[i] + vy2[i] * dt;
+    }
+}
+
+void ObjectTracker::addTrack(const TrafficObject &object, Timer::time_point_t time) {
+    x1.push_back(object.bbox.x1);
+    y1.push_back(object.bbox.y1);
+    x2.push_back(object.bbox.x2);
+    y2.push_back(object.bbox.y2);
+    vx1.push_back(0);
+    vy1.push_back(0);
+    vx2.push_back(0);
+    vy2.push_back(0);
+    class_ids.push_back(object.classId);
+    track_ids.push_back(next_track_id++);
+    ages.push_back(1);
+    misses.push_back(0);
+    last_seen_times.push_back(time);
+}
+
+void ObjectTracker::removeTrack(size_t track) {
+    // Swap with the last track: the order of tracks doesn't matter
+    size_t last = track_ids.size() - 1;
+    for (std::vector<float> *values : {&x1, &y1, &x2, &y2, &vx1, &vy1, &vx2, &vy2}) {
+        (*values)[track] = (*values)[last];
+        values->pop_back();
+    }
+    for (std::vector<int> *values : {&class_ids, &track_ids, &ages, &misses}) {
+        (*values)[track] = (*values)[last];
+        values->pop_back();
+    }
+    last_seen_times[track] = last_seen_times[last];
+    last_seen_times.pop_back();
+}
+
+void ObjectTracker::update(std::vector<TrafficObject> &objects, Timer::time_point_t time) {
+    predict(time);
+    int n_tracks = track_ids.size();
+    int n_detections = objects.size();
+
+    // Candidate associations: IoU of each detection with all tracks
+    std::vector<Match> matches;
+    for (int j = 0; j < n_detections; ++j) {
+        const Box &box = objects[j].bbox;
+        float area = (box.x2 - box.x1) * (box.y2 - box.y1);
+        for (int i = 0; i < n_tracks; ++i) {
+            float iw = std::min(box.x2, px2[i]) - std::max(box.x1, px1[i]);
+            float ih = std::min(box.y2, py2[i]) - std::max(box.y1, py1[i]);
+            if (iw <= 0 || ih <= 0 || class_ids[i] != objects[j].classId) continue;
+            float intersection = iw * ih;
+            float track_area = (px2[i] - px1[i]) * (py2[i] - py1[i]);
+            float iou = intersection / (area + track_area - intersection);
+            if (iou >= OBJECT_TRACKER_IOU_THRESHOLD) {
+                matches.push_back({iou, i, j});
+            }
+        }
+    }
+
+    // Greedy association, best IoU first
+    std::sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return std::tie(b.iou, a.track, a.detection) < std::tie(a.iou, b.track, b.detection);
+    });
+    std::vector<bool> track_matched(n_tracks, false);
+    std::vector<bool> detection_matched(n_detections, false);
+    for (const Match &match : matches) {
+        int i = match.track;
+        int j = match.detection;
+        if (track_matched[i] || detection_matched[j]) continue;
+        track_matched[i] = true;
+        detection_matched[j] = true;
+
+        // Velocity measured since the last detection of the track
+        const Box &box = objects[j].bbox;
+        float dt = Timer::calcDiff(last_seen_times[i], time) / 1000.0f;
+        if (dt > 0) {
+            const float a = OBJECT_TRACKER_VELOCITY_SMOOTHING;
+            vx1[i] = a * (box.x1 - x1[i]) / dt + (1 - a) * vx1[i];
+            vy1[i] = a * (box.y1 - y1[i]) / dt + (1 - a) * vy1[i];
+            vx2[i] = a * (box.x2 - x2[i]) / dt + (1 - a) * vx2[i];
+            vy2[i] = a * (box.y2 - y2[i]) / dt + (1 - a) * vy2[i];
+        }
+        x1[i] = box.x1;
+        y1[i] = box.y1;
+        x2[i] = box.x2;
+        y2[i] = box.y2;
+        last_seen_times[i] = time;
+        misses[i] = 0;
+        ++ages[i];
+
+        objects[j].track_id = track_ids[i];
+        objects[j].track_age = ages[i];
+    }
+
+    // Lost tracks. Backwards, as removing a track moves the last one
+    for (int i = n_tracks - 1; i >= 0; --i) {
+        if (track_matched[i]) continue;
+        ++ages[i];
+        if (++misses[i] > OBJECT_TRACKER_MAX_MISSES) {
+            removeTrack(i);
+        }
+    }
+
+    // New tracks
+    for (int j = 0; j < n_detections; ++j) {
+        if (detection_matched[j]) continue;
+        addTrack(objects[j], time);
+        objects[j].track_id = track_ids.back();
+        objects[j].track_age = ages.back();
+    }
+}
+
+void ObjectTracker::reset() {
+    for (std::vector<float> *values : {&x1, &y1, &x2, &y2, &vx1, &vy1, &vx2, &vy2}) {
+        values->clear();
+    }
+    for (std::vector<int> *values : {&class_ids, &track_ids, &ages, &misses}) {
+        values->clear();
+    }
+    last_seen_times.clear();
+}
+
+size_t ObjectTracker::getTrackCount() {
+    return track_ids.size();
+}
@@ -0,0 +1,51 @@
+#ifndef OBJECT_TRACKER_H
+#define OBJECT_TRACKER_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "traffic_object.h"
+#include "utils/timer.h"
+
+// Give the detected objects identities across frames.
+// Each track predicts its box at the time of the new frame with a constant
+// velocity model, then detections are associated to tracks greedily, by
+// decreasing IoU between the predicted and the detected boxes (same class
+// only). Unmatched detections start new tracks. Tracks without detection
+// for more than OBJECT_TRACKER_MAX_MISSES frames are removed.
+// Tracks are stored as a struct of arrays, so that the IoU of a detection
+// with all tracks is computed over contiguous arrays.
+// Not thread-safe: update() must be called in frame order from one thread
+class ObjectTracker {
+   private:
+    // Last detected box of each track
+    std::vector<float> x1, y1, x2, y2;
+    // Velocity of each box coordinate, in pixels per second
+    std::vector<float> vx1, vy1, vx2, vy2;
+    // Box predicted at the time of the frame being updated
+    std::vector<float> px1, py1, px2, py2;
+    std::vector<int> class_ids;
+    std::vector<int> track_ids;
+    std::vector<int> ages;
+    std::vector<int> misses;
+    std::vector<Timer::time_point_t> last_seen_times;
+
+    int next_track_id = 0;
+
+    void predict(Timer::time_point_t time);
+    void addTrack(const TrafficObject &object, Timer::time_point_t time);
+    void removeTrack(size_t track);
+
+   public:
+    // Set track_id and track_age of objects, detected in a frame
+    // captured at time
+    void update(std::vector<TrafficObject> &objects, Timer::time_point_t time);
+
+    // Remove all tracks, e.g. when the input source changes
+    void reset();
+
+    // Number of tracks, including those not detected in the last frames
+    size_t getTrackCount();
+};
+
+#endif
@@ -0,0 +1,90 @@
+#include "sign_classification_cache.h"
+
+#include "configs/config_sign_classification.h"
+
+namespace {
+
+float boxArea(const Box &box) {
+    return (box.x2 - box.x1) * (box.y2 - box.y1);
+}
+
+}  // namespace
+
+void SignClassificationCache::nextFrame() {
+    ++frame;
+    for (auto it = entries.begin(); it != entries.end();) {
+        if (frame - it->second.last_frame > SIGN_CACHE_MAX_FRAMES_UNSEEN) {
+            it = entries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool SignClassificationCache::needsClassification(const TrafficObject &object) {
+    ++n_requests;
+    if (object.track_id < 0) {
+        return true;
+    }
+
+    Entry &entry = entries[object.track_id];
+    entry.last_frame = frame;
+    if (entry.in_flight && frame - entry.request_frame <= SIGN_CACHE_MAX_FRAMES_IN_FLIGHT) {
+        return false;
+    }
+    bool needed = entry.n_votes == 0 ||
+        (getClassId(object) < 0 && entry.n_votes < SIGN_CACHE_MAX_VOTES) ||
+        boxArea(object.bbox) >= SIGN_CACHE_RECLASSIFY_GROWTH * entry.classified_area;
+    if (needed) {
+        entry.in_flight = true;
+        entry.request_frame = frame;
+    }
+    return needed;
+}
+
+void SignClassificationCache::addVote(const TrafficObject &object, int class_id, float confidence) {
+    ++n_classifications;
+    if (object.track_id < 0) {
+        return;
+    }
+
+    Entry &entry = entries[object.track_id];
+    entry.in_flight = false;
+    if (class_id >= 0) {
+        entry.votes[class_id] += confidence;
+    }
+    ++entry.n_votes;
+    entry.classified_area = boxArea(object.bbox);
+    entry.last_frame = frame;
+}
+
+int SignClassificationCache::getClassId(const TrafficObject &object) {
+    auto it = entries.find(object.track_id);
+    if (it == entries.end() || it->second.n_votes == 0) {
+        return -1;
+    }
+
+    // Class with the highest sum of confidences. It is kept if its mean
+    // confidence over all votes is above the classification threshold
+    const Entry &entry = it->second;
+    int best_class_id = -1;
+    float best_votes = 0;
+    for (const auto &vote : entry.votes) {
+        if (vote.second > best_votes) {
+            best_class_id = vote.first;
+            best_votes = vote.second;
+        }
+    }
+    if (best_votes / entry.n_votes < SIGN_CLASSIFICATION_THRESH) {
+        return -1;
+    }
+    return best_class_id;
+}
+
+uint64_t SignClassificationCache::getRequestCount() {
+    return n_requests;
+}
+
+uint64_t SignClassificationCache::getClassificationCount() {
+    return n_classifications;
+}
@@ -0,0 +1,59 @@
+#ifndef SIGN_CLASSIFICATION_CACHE_H
+#define SIGN_CLASSIFICATION_CACHE_H
+
+#include <stdint.h>
+#include <map>
+#include <unordered_map>
+
+#include "traffic_object.h"
+
+// Traffic sign classifications of tracked objects (see ObjectTracker),
+// combined across frames by confidence-weighted voting.
+// A sign is classified again only while its vote is not confident
+// enough (up to SIGN_CACHE_MAX_VOTES times), or when its box has grown a
+// lot since its last classification (a closer sign gives a sharper crop).
+// Otherwise its vote is reused. A track whose crop is still being
+// classified (requested but not voted yet) is not requested again: with
+// batching, a crop may wait for the crops of the next frames. A request
+// not voted within SIGN_CACHE_MAX_FRAMES_IN_FLIGHT frames (e.g. its frame
+// was dropped) is considered lost.
+// Not thread-safe
+class SignClassificationCache {
+   private:
+    struct Entry {
+        std::map<int, float> votes;  // Sum of the confidences of each class id
+        int n_votes = 0;
+        float classified_area = 0;   // Box area at the last classification
+        uint64_t last_frame = 0;     // Last frame where the track was seen
+        bool in_flight = false;      // Classification requested, not voted yet
+        uint64_t request_frame = 0;  // Frame of the last request
+    };
+
+    std::unordered_map<int, Entry> entries;  // By track id
+    uint64_t frame = 0;
+
+    uint64_t n_requests = 0;
+    uint64_t n_classifications = 0;
+
+   public:
+    // Start a new frame. Forget the tracks not seen for a while
+    void nextFrame();
+
+    // True if the sign of a track must be classified on this frame. The
+    // sign is then in flight until addVote() is called for it
+    bool needsClassification(const TrafficObject &object);
+
+    // Add the classification of a sign: class id (-1 if unknown)
+    // and its probability. To be called for every sign for which
+    // needsClassification() returned true, even if classification failed
+    void addVote(const TrafficObject &object, int class_id, float confidence);
+
+    // Class id of a track, -1 if unknown or not confident enough
+    int getClassId(const TrafficObject &object);
+
+    // Number of signs seen, and classified, since the creation of the cache
+    uint64_t getRequestCount();
+    uint64_t getClassificationCount();
+};
+
+#endif
@@ -0,0 +1,194 @@
+// Test and benchmark of the CPU CenterNet decoder (CTdetforward_cpu()).
+// Compare it with a sequential port of the CUDA kernel on random heads:
+// same detections, ranked in a deterministic order, and the top K kept
+// when there are more peaks than max_detections.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <opencv2/opencv.hpp>
+
+#include "ctdet_utils.h"
+#include "ctdetDecoder.h"
+#include "configs/config_object_detection.h"
+
+using namespace std;
+using namespace std::chrono;
+
+static float Logist(float data) { return 1.f / (1.f + std::exp(-data)); }
+
+// CTdetforward_kernel, one thread after the other, then ranked as
+// CTdetforward_cpu() does (probability, class, cell index)
+std::vector<Detection> referenceDecode(const float *hm, const float *reg, const float *wh,
+                                       int w, int h, int classes, int kernel_size, float visthresh) {
+    std::vector<std::pair<Detection, int>> peaks;
+    int padding = (kernel_size - 1) / 2;
+    int stride = w * h;
+    for (int idx = 0; idx < w * h * classes; ++idx) {
+        int grid_x = idx % w;
+        int grid_y = (idx / w) % h;
+        int cls = idx / w / h;
+        int reg_index = idx - cls * stride;
+        float objProb = Logist(hm[idx]);
+        if (objProb <= visthresh) continue;
+        float max = -1;
+        int max_index = 0;
+        for (int l = 0; l < kernel_size; ++l) {
+            for (int m = 0; m < kernel_size; ++m) {
+                int cur_x = -padding + l + grid_x;
+                int cur_y = -padding + m + grid_y;
+                int cur_index = cur_y * w + cur_x + stride * cls;
+                int valid = (cur_x >= 0 && cur_x < w && cur_y >= 0 && cur_y < h);
+                float val = valid ? Logist(hm[cur_index]) : -1;
+                max_index = (val > max) ? cur_index : max_index;
+                max = (val > max) ? val : max;
+            }
+        }
+        if (idx != max_index) continue;
+        Detection det;
+        float c_x = grid_x + reg[reg_index];
+        float c_y = grid_y + reg[reg_index + stride];
+        det.bbox.x1 = (c_x - wh[reg_index] / 2) * 4;
+        det.bbox.y1 = (c_y - wh[reg_index + stride] / 2) * 4;
+        det.bbox.x2 = (c_x + wh[reg_index] / 2) * 4;
+        det.bbox.y2 = (c_y + wh[reg_index + stride] / 2) * 4;
+        det.classId = cls;
+        det.prob = objProb;
+        peaks.push_back(std::make_pair(det, reg_index));
+    }
+
+    std::sort(peaks.begin(), peaks.end(), [](const std::pair<Detection, int> &a, const std::pair<Detection, int> &b) {
+        if (a.first.prob != b.first.prob) return a.first.prob > b.first.prob;
+        if (a.first.classId != b.first.classId) return a.first.classId < b.first.classId;
+        return a.second < b.second;
+    });
+    std::vector<Detection> result;
+    for (const auto &peak : peaks) {
+        result.push_back(peak.first);
+    }
+    return result;
+}
+
+std::vector<Detection> decode(const float *hm, const float *reg, const float *wh,
+                              int w, int h, int classes, int max_detections) {
+    std::vector<float> output(1 + max_detections * sizeof(Detection) / sizeof(float));
+    CTdetforward_cpu(hm, reg, wh, output.data(), w, h, classes, ctdet::kernelSize,
+                     ctdet::visThresh, max_detections);
+    int num_det = static_cast<int>(output[0]);
+    std::vector<Detection> result(&reinterpret_cast<Detection *>(&output[1])[0],
+                                  &reinterpret_cast<Detection *>(&output[1])[num_det]);
+    return result;
+}
+
+bool sameDetection(const Detection &a, const Detection &b) {
+    return a.classId == b.classId && std::abs(a.prob - b.prob) < 1e-6 &&
+        a.bbox.x1 == b.bbox.x1 && a.bbox.y1 == b.bbox.y1 &&
+        a.bbox.x2 == b.bbox.x2 && a.bbox.y2 == b.bbox.y2;
+}
+
+bool sameDetections(const std::vector<Detection> &a, const std::vector<Detection> &b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!sameDetection(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+// Mostly background, with a few blobs and some plateaus of equal values
+void randomHeads(cv::RNG &rng, std::vector<float> &hm, std::vector<float> &reg, std::vector<float> &wh,
+                 int w, int h, int classes, int n_blobs) {
+    hm.resize(classes * w * h);
+    reg.resize(2 * w * h);
+    wh.resize(2 * w * h);
+    for (float &v : hm) v = rng.uniform(-12.f, -2.f);
+    for (float &v : reg) v = rng.uniform(0.f, 1.f);
+    for (float &v : wh) v = rng.uniform(2.f, 30.f);
+    for (int i = 0; i < n_blobs; ++i) {
+        int cls = rng.uniform(0, classes);
+        int cx = rng.uniform(0, w), cy = rng.uniform(0, h);
+        float peak = rng.uniform(-1.f, 6.f);
+        bool plateau = rng.uniform(0, 4) == 0;
+        for (int y = std::max(cy - 3, 0); y < std::min(cy + 4, h); ++y) {
+            for (int x = std::max(cx - 3, 0); x < std::min(cx + 4, w); ++x) {
+                float d = plateau ? std::max(std::abs(x - cx), std::abs(y - cy)) / 2 : std::hypot(x - cx, y - cy);
+                float &v = hm[cls * w * h + y * w + x];
+                v = std::max(v, peak - d);
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{runs           |200   | number of random heads to check }"
+        "{iterations     |500   | number of iterations of the benchmark }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("CPU CenterNet decoder test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    int n_runs = parser.get<int>("runs");
+    int n_iterations = parser.get<int>("iterations");
+    const int w = ctdet::input_w / 4;
+    const int h = ctdet::input_h / 4;
+    const int classes = ctdet::classNum;
+
+    cv::RNG rng(12345);
+    std::vector<float> hm, reg, wh;
+    int n_failed = 0;
+    for (int run = 0; run < n_runs; ++run) {
+        // Sizes which are not a multiple of the SIMD width in some runs
+        int run_w = run % 2 ? w : w - run % 3 - 1;
+        int run_h = run % 3 ? h : h - 5;
+        randomHeads(rng, hm, reg, wh, run_w, run_h, classes, rng.uniform(0, 200));
+
+        std::vector<Detection> expected = referenceDecode(hm.data(), reg.data(), wh.data(),
+            run_w, run_h, classes, ctdet::kernelSize, ctdet::visThresh);
+
+        std::vector<Detection> result = decode(hm.data(), reg.data(), wh.data(), run_w, run_h, classes, ctdet::maxDetections);
+        std::vector<Detection> again = decode(hm.data(), reg.data(), wh.data(), run_w, run_h, classes, ctdet::maxDetections);
+        if (!sameDetections(result, expected) || !sameDetections(result, again)) {
+            cerr << "Run " << run << ": " << result.size() << " detections, expected " << expected.size() << endl;
+            ++n_failed;
+            continue;
+        }
+
+        // Top K
+        int k = expected.size() / 2;
+        std::vector<Detection> top_k = decode(hm.data(), reg.data(), wh.data(), run_w, run_h, classes, k);
+        expected.resize(k);
+        if (!sameDetections(top_k, expected)) {
+            cerr << "Run " << run << ": wrong top " << k << endl;
+            ++n_failed;
+        }
+    }
+    cout << n_runs - n_failed << "/" << n_runs << " runs passed" << endl;
+
+    // Benchmark on a typical frame
+    randomHeads(rng, hm, reg, wh, w, h, classes, 50);
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < n_iterations; ++i) {
+        referenceDecode(hm.data(), reg.data(), wh.data(), w, h, classes, ctdet::kernelSize, ctdet::visThresh);
+    }
+    double reference_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0 / n_iterations;
+
+    begin = steady_clock::now();
+    for (int i = 0; i < n_iterations; ++i) {
+        decode(hm.data(), reg.data(), wh.data(), w, h, classes, ctdet::maxDetections);
+    }
+    double decode_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0 / n_iterations;
+
+    cout << std::fixed << std::setprecision(3);
+    cout << "Heads " << classes << "x" << h << "x" << w << endl;
+    cout << "  sequential kernel: " << reference_ms << " ms/frame" << endl;
+    cout << "  CTdetforward_cpu:  " << decode_ms << " ms/frame (x" << reference_ms / decode_ms << ")" << endl;
+
+    return n_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// Test of ObjectTracker on synthetic boxes (no model needed): association
+// of detections to tracks, prediction of moving boxes with their velocity,
+// and expiry of tracks after OBJECT_TRACKER_MAX_MISSES frames without
+// detection.
+
+#include <chrono>
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "object_tracker.h"
+#include "configs/config_object_detection.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+TrafficObject makeObject(float x, float y, float size, int class_id) {
+    Detection detection;
+    detection.bbox = {x, y, x + size, y + size};
+    detection.classId = class_id;
+    detection.prob = 0.9f;
+    return TrafficObject(detection, "");
+}
+
+Timer::time_point_t frameTime(Timer::time_point_t start, int frame, int frame_interval_ms) {
+    return start + std::chrono::milliseconds(frame * frame_interval_ms);
+}
+
+// Two objects of different classes at the same place, and a third one
+// elsewhere: one track each, kept while they stay in place
+bool testAssociation(Timer::time_point_t start) {
+    bool ok = true;
+    ObjectTracker tracker;
+    std::vector<int> ids;
+    for (int frame = 0; frame < 10; ++frame) {
+        std::vector<TrafficObject> objects = {
+            makeObject(100, 100, 50, 0), makeObject(102, 100, 50, 1), makeObject(300, 200, 40, 0)};
+        // Detection order must not matter
+        if (frame % 2) {
+            std::swap(objects[0], objects[2]);
+        }
+        tracker.update(objects, frameTime(start, frame, 100));
+        if (frame % 2) {
+            std::swap(objects[0], objects[2]);
+        }
+        if (frame == 0) {
+            for (const TrafficObject& object : objects) {
+                ids.push_back(object.track_id);
+            }
+            ok &= check(ids[0] != ids[1] && ids[0] != ids[2] && ids[1] != ids[2],
+                        "one track per object, same place but different class");
+            continue;
+        }
+        for (size_t i = 0; i < objects.size(); ++i) {
+            ok &= check(objects[i].track_id == ids[i], "same track for the same object");
+            ok &= check(objects[i].track_age == frame + 1, "age of the track");
+        }
+    }
+    ok &= check(tracker.getTrackCount() == 3, "three tracks");
+
+    tracker.reset();
+    ok &= check(tracker.getTrackCount() == 0, "no track after reset");
+    return ok;
+}
+
+// A box moving by 30 px per frame: without prediction, its IoU with the
+// last detected box would be 10 / 70, below OBJECT_TRACKER_IOU_THRESHOLD.
+// The first steps are slower, so that the velocity is learnt while the
+// boxes still overlap
+bool testVelocityPrediction(Timer::time_point_t start) {
+    bool ok = true;
+    ObjectTracker tracker;
+    int id = -1;
+    float x = 10;
+    for (int frame = 0; frame < 20; ++frame) {
+        x += frame == 0 ? 0 : frame < 4 ? 15 : 30;
+        std::vector<TrafficObject> objects = {makeObject(x, 50, 40, 2)};
+        tracker.update(objects, frameTime(start, frame, 100));
+        if (frame == 0) {
+            id = objects[0].track_id;
+        }
+        ok &= check(objects[0].track_id == id, "moving object keeps its track");
+    }
+    ok &= check(tracker.getTrackCount() == 1, "one track for the moving object");
+
+    // Prediction uses the time between frames, not the number of frames:
+    // a frame dropped in between still lands on the predicted box
+    x += 60;
+    std::vector<TrafficObject> objects = {makeObject(x, 50, 40, 2)};
+    tracker.update(objects, frameTime(start, 21, 100));
+    ok &= check(objects[0].track_id == id, "moving object after a dropped frame");
+    ok &= check(tracker.getTrackCount() == 1, "still one track after a dropped frame");
+    return ok;
+}
+
+// A track is kept for OBJECT_TRACKER_MAX_MISSES frames without detection,
+// then removed. An object seen again after that starts a new track
+bool testExpiry(Timer::time_point_t start) {
+    bool ok = true;
+    ObjectTracker tracker;
+    std::vector<TrafficObject> objects = {makeObject(100, 100, 50, 0), makeObject(300, 300, 50, 0)};
+    tracker.update(objects, frameTime(start, 0, 100));
+    int id = objects[0].track_id;
+    int frame = 1;
+
+    // Only the second object disappears
+    for (int i = 0; i < OBJECT_TRACKER_MAX_MISSES; ++i, ++frame) {
+        objects = {makeObject(100, 100, 50, 0)};
+        tracker.update(objects, frameTime(start, frame, 100));
+    }
+    ok &= check(tracker.getTrackCount() == 2, "track kept while missed");
+
+    // Back before expiry: same track
+    objects = {makeObject(100, 100, 50, 0), makeObject(300, 300, 50, 0)};
+    tracker.update(objects, frameTime(start, frame++, 100));
+    ok &= check(objects[0].track_id == id, "first object keeps its track");
+    int second_id = objects[1].track_id;
+
+    for (int i = 0; i <= OBJECT_TRACKER_MAX_MISSES; ++i, ++frame) {
+        objects = {makeObject(100, 100, 50, 0)};
+        tracker.update(objects, frameTime(start, frame, 100));
+    }
+    ok &= check(tracker.getTrackCount() == 1, "track removed after max misses");
+
+    objects = {makeObject(100, 100, 50, 0), makeObject(300, 300, 50, 0)};
+    tracker.update(objects, frameTime(start, frame, 100));
+    ok &= check(objects[0].track_id == id, "remaining track kept");
+    ok &= check(objects[1].track_id != second_id && objects[1].track_age == 1,
+                "new track for an object seen again after expiry");
+    ok &= check(tracker.getTrackCount() == 2, "two tracks again");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Object tracker test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    Timer::time_point_t start = Timer::getCurrentTime();
+    bool ok = testAssociation(start);
+    ok &= testVelocityPrediction(start);
+    ok &= testExpiry(start);
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,130 @@
+// Benchmark for the object detection preprocessing (letterbox, normalization,
+// HWC to CHW).
+// Compare the old path (padded canvas, convertTo, split and per channel
+// Mat expressions, new vector per frame) with the fused prepareImage()
+// writing into a reused buffer.
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "ctdet_utils.h"
+#include "configs/config.h"
+#include "configs/config_object_detection.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// prepareImage() before the fused kernel
+std::vector<float> legacyPrepareImage(cv::Mat& img, const bool& forwardFace)
+{
+    int channel = ctdet::channel ;
+    int input_w = ctdet::input_w;
+    int input_h = ctdet::input_h;
+    float scale = cv::min(float(input_w)/img.cols,float(input_h)/img.rows);
+    auto scaleSize = cv::Size(img.cols * scale,img.rows * scale);
+
+    cv::Mat resized;
+    cv::resize(img, resized,scaleSize,0,0);
+
+    cv::Mat cropped = cv::Mat::zeros(input_h,input_w,CV_8UC3);
+    cv::Rect rect((input_w- scaleSize.width)/2, (input_h-scaleSize.height)/2, scaleSize.width,scaleSize.height);
+
+    resized.copyTo(cropped(rect));
+
+    cv::Mat img_float;
+    if(forwardFace)
+        cropped.convertTo(img_float, CV_32FC3, 1.);
+    else
+        cropped.convertTo(img_float, CV_32FC3,1./255.);
+
+    //HWC TO CHW
+    std::vector<cv::Mat> input_channels(channel);
+    cv::split(img_float, input_channels);
+
+    // normalize
+    std::vector<float> result(input_h*input_w*channel);
+    auto data = result.data();
+    int channelLength = input_h * input_w;
+    for (int i = 0; i < channel; ++i) {
+        cv::Mat normed_channel = (input_channels[i]-ctdet::mean[i])/ctdet::std[i];
+        memcpy(data,normed_channel.data,channelLength*sizeof(float));
+        data += channelLength;
+    }
+    return result;
+}
+
+void benchmark(cv::Mat &img, int n_iterations) {
+    size_t volume = ctdet::channel * ctdet::input_h * ctdet::input_w;
+
+    // Warm up and check that both paths give the same input
+    std::vector<float> legacy_result = legacyPrepareImage(img, false);
+    std::vector<float> buffer(volume);
+    prepareImage(img, false, buffer.data());
+    float max_diff = 0;
+    for (size_t i = 0; i < volume; ++i) {
+        max_diff = std::max(max_diff, std::abs(legacy_result[i] - buffer[i]));
+    }
+
+    steady_clock::time_point begin = steady_clock::now();
+    for (int i = 0; i < n_iterations; ++i) {
+        legacy_result = legacyPrepareImage(img, false);
+    }
+    double legacy_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0 / n_iterations;
+
+    begin = steady_clock::now();
+    for (int i = 0; i < n_iterations; ++i) {
+        prepareImage(img, false, buffer.data());
+    }
+    double fused_ms = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1000.0 / n_iterations;
+
+    cout << std::fixed << std::setprecision(3);
+    cout << "Input " << img.cols << "x" << img.rows << endl;
+    cout << "  legacy: " << legacy_ms << " ms/frame" << endl;
+    cout << "  fused:  " << fused_ms << " ms/frame (x" << legacy_ms / fused_ms << ")" << endl;
+    cout << "  max abs diff: " << std::scientific << max_diff << std::fixed << endl;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{input_image    |      | image to preprocess. Random image if empty }"
+        "{width          |1920  | width of the random image }"
+        "{height         |1080  | height of the random image }"
+        "{iterations     |500   | number of iterations }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Object detection preprocessing benchmark");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    std::string input_image = parser.get<std::string>("input_image");
+    int n_iterations = parser.get<int>("iterations");
+
+    cv::Mat img;
+    if (!input_image.empty()) {
+        img = cv::imread(input_image);
+        if (img.empty()) {
+            cerr << "Could not read image: " << input_image << endl;
+            return 1;
+        }
+    } else {
+        img = cv::Mat(parser.get<int>("height"), parser.get<int>("width"), CV_8UC3);
+        cv::randu(img, cv::Scalar::all(0), cv::Scalar::all(255));
+    }
+
+    // Camera image, and the frame image resized by CarStatus
+    benchmark(img, n_iterations);
+    float resize_ratio = (float)IMG_MAX_SIZE / std::max(img.cols, img.rows);
+    if (resize_ratio < 1) {
+        cv::Mat resized;
+        cv::resize(img, resized, cv::Size(), resize_ratio, resize_ratio);
+        benchmark(resized, n_iterations);
+    }
+
+    return 0;
+}
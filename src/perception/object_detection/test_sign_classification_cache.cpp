@@ -0,0 +1,133 @@
+// Test of SignClassificationCache (no model needed): which signs of
+// tracked objects are classified again, with classifications coming back
+// a few frames late as with the batcher, and the ratio of classifications
+// to requests on a synthetic sequence.
+
+#include <deque>
+#include <iostream>
+#include <opencv2/opencv.hpp>
+
+#include "sign_classification_cache.h"
+#include "configs/config_sign_classification.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+TrafficObject makeSign(int track_id, float size) {
+    Detection detection;
+    detection.bbox = {100, 100, 100 + size, 100 + size};
+    detection.classId = 8;
+    detection.prob = 0.9f;
+    TrafficObject object(detection, "");
+    object.track_id = track_id;
+    return object;
+}
+
+bool testReuse() {
+    bool ok = true;
+    SignClassificationCache cache;
+    TrafficObject sign = makeSign(1, 80);
+
+    cache.nextFrame();
+    ok &= check(cache.needsClassification(makeSign(-1, 80)), "untracked sign always classified");
+    ok &= check(cache.needsClassification(sign), "new track classified");
+
+    // Crop still in the batcher: not queued again
+    cache.nextFrame();
+    ok &= check(!cache.needsClassification(sign), "no request while in flight");
+    cache.addVote(sign, 3, 0.95f);
+    ok &= check(cache.getClassId(sign) == 3, "class of the track");
+
+    cache.nextFrame();
+    ok &= check(!cache.needsClassification(sign), "confident vote reused");
+
+    // Closer sign: sharper crop
+    TrafficObject closer = makeSign(1, 80 * 1.3f);
+    cache.nextFrame();
+    ok &= check(cache.needsClassification(closer), "classified again when grown");
+    cache.addVote(closer, 3, 0.9f);
+    cache.nextFrame();
+    ok &= check(!cache.needsClassification(closer), "reused after growing");
+    return ok;
+}
+
+bool testUnconfident() {
+    bool ok = true;
+    SignClassificationCache cache;
+    TrafficObject sign = makeSign(2, 80);
+    int n_classifications = 0;
+    for (int i = 0; i < 2 * SIGN_CACHE_MAX_VOTES; ++i) {
+        cache.nextFrame();
+        if (cache.needsClassification(sign)) {
+            ++n_classifications;
+            cache.addVote(sign, 1 + i % 2, 0.6f);
+        }
+    }
+    ok &= check(cache.getClassId(sign) == -1, "unconfident votes give no class");
+    ok &= check(n_classifications == SIGN_CACHE_MAX_VOTES, "unconfident sign classified up to max votes");
+    return ok;
+}
+
+bool testLostRequest() {
+    bool ok = true;
+    SignClassificationCache cache;
+    TrafficObject sign = makeSign(3, 80);
+    cache.nextFrame();
+    ok &= check(cache.needsClassification(sign), "new track classified");
+    // Never voted, e.g. its frame was dropped
+    for (int i = 0; i < SIGN_CACHE_MAX_FRAMES_IN_FLIGHT; ++i) {
+        cache.nextFrame();
+        ok &= check(!cache.needsClassification(sign), "no request while in flight");
+    }
+    cache.nextFrame();
+    ok &= check(cache.needsClassification(sign), "lost request classified again");
+    return ok;
+}
+
+// A sign tracked for 100 frames, with classifications coming back
+// `latency` frames after their request
+bool testRatio(int latency) {
+    bool ok = true;
+    SignClassificationCache cache;
+    std::deque<std::pair<int, TrafficObject>> in_flight;  // Frame of the vote, sign
+    const int n_frames = 100;
+    for (int frame = 0; frame < n_frames; ++frame) {
+        cache.nextFrame();
+        TrafficObject sign = makeSign(4, 70 + frame / 5);
+        if (cache.needsClassification(sign)) {
+            in_flight.push_back(std::make_pair(frame + latency, sign));
+        }
+        while (!in_flight.empty() && in_flight.front().first <= frame) {
+            cache.addVote(in_flight.front().second, 5, 0.95f);
+            in_flight.pop_front();
+        }
+    }
+    double ratio = static_cast<double>(cache.getClassificationCount()) / cache.getRequestCount();
+    cout << "Latency " << latency << " frames: " << cache.getClassificationCount() << " classifications for "
+         << cache.getRequestCount() << " requests (ratio " << ratio << ")" << endl;
+    ok &= check(cache.getRequestCount() == n_frames, "one request per frame");
+    // First classification, then once when the box area has grown by
+    // SIGN_CACHE_RECLASSIFY_GROWTH (from 70 px to 89 px wide)
+    ok &= check(cache.getClassificationCount() == 2, "classifications reused across frames");
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Sign classification cache test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    bool ok = testReuse();
+    ok &= testUnconfident();
+    ok &= testLostRequest();
+    ok &= testRatio(0);
+    ok &= testRatio(3);
+
+    return reportTestResult(ok);
+}
@@ -14,6 +14,11 @@ class TrafficObject {
     float distance_to_my_car = -1;
     std::string traffic_sign_type{""}; // Extended type. For traffic sign
 
+    // Set by ObjectTracker: same id for the same object across frames,
+    // and number of frames since the track started. -1 and 0 if not tracked
+    int track_id = -1;
+    int track_age = 0;
+
     TrafficObject(const Detection &detection, std::string traffic_sign_type) : 
     bbox(detection.bbox), classId(detection.classId), prob(detection.prob), traffic_sign_type(traffic_sign_type) {}
 };
@@ -0,0 +1,158 @@
+#include "sign_classification_batcher.h"
+
+#include <iostream>
+
+#include "../../common/uff_models/classification_net/classification_net.h"
+#include "perception/common/inference/async_inference.h"
+
+SignClassificationBatcher::SignClassificationBatcher(std::shared_ptr<ClassificationNet> model, int batch_size) :
+    model(model), batch_size(batch_size) {
+    worker = std::thread(&SignClassificationBatcher::workerLoop, this);
+}
+
+SignClassificationBatcher::~SignClassificationBatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    queue_changed.notify_all();
+    worker.join();
+}
+
+std::future<SignClassificationResult> SignClassificationBatcher::classify(
+    const std::vector<cv::Mat> &crops, int max_delay_ms) {
+
+    std::shared_ptr<Request> request = std::make_shared<Request>();
+    std::future<SignClassificationResult> future = request->promise.get_future();
+    if (crops.empty()) {
+        request->promise.set_value(SignClassificationResult());
+        return future;
+    }
+
+    request->result.class_ids.resize(crops.size(), -1);
+    request->result.confidences.resize(crops.size(), 0);
+    request->n_remaining = crops.size();
+    clock_t::time_point deadline = clock_t::now() + std::chrono::milliseconds(max_delay_ms);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < crops.size(); ++i) {
+            queue.push_back({request, i, crops[i], deadline});
+        }
+        stats.n_crops += crops.size();
+    }
+    queue_changed.notify_all();
+    return future;
+}
+
+SignClassificationBatcherStats SignClassificationBatcher::getStats() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+// Must be called with the mutex locked
+bool SignClassificationBatcher::isBatchReady(clock_t::time_point now) {
+    if (queue.empty()) return false;
+    if (!running || queue.size() >= static_cast<size_t>(batch_size)) return true;
+    for (const Item &item : queue) {
+        if (item.deadline <= now) return true;
+    }
+    return false;
+}
+
+void SignClassificationBatcher::workerLoop() {
+    // Up to kInferenceSlots batches in flight: the next batch is
+    // prepared while the network runs on the previous one
+    std::deque<Batch> in_flight;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        if (isBatchReady(clock_t::now())) {
+            if (in_flight.size() == kInferenceSlots) {
+                lock.unlock();
+                waitBatch(in_flight);
+                lock.lock();
+                continue;
+            }
+
+            // Oldest crops first
+            Batch batch;
+            while (!queue.empty() && batch.items.size() < static_cast<size_t>(batch_size)) {
+                batch.items.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+            ++stats.n_batches;
+            if (batch.items.size() == static_cast<size_t>(batch_size)) {
+                ++stats.n_full_batches;
+            }
+            in_flight.push_back(std::move(batch));
+
+            lock.unlock();
+            submitBatch(in_flight);
+            lock.lock();
+            continue;
+        }
+
+        // Nothing to submit yet: deliver the results of running batches
+        if (!in_flight.empty()) {
+            lock.unlock();
+            waitBatch(in_flight);
+            lock.lock();
+            continue;
+        }
+
+        if (queue.empty()) {
+            if (!running) break;
+            queue_changed.wait(lock);
+        } else {
+            clock_t::time_point deadline = queue.front().deadline;
+            for (const Item &item : queue) {
+                deadline = std::min(deadline, item.deadline);
+            }
+            queue_changed.wait_until(lock, deadline);
+        }
+    }
+}
+
+// Submit the last batch of in_flight. On failure, its crops are
+// delivered as unknown and it is removed
+void SignClassificationBatcher::submitBatch(std::deque<Batch> &in_flight) {
+    Batch &batch = in_flight.back();
+    std::vector<cv::Mat> crops;
+    crops.reserve(batch.items.size());
+    for (const Item &item : batch.items) {
+        crops.push_back(item.crop);
+    }
+
+    if (!model->submit(crops)) {
+        std::cerr << "Error on running traffic sign classification model." << std::endl;
+        for (Item &item : batch.items) {
+            deliver(item, -1, 0);
+        }
+        in_flight.pop_back();
+    }
+}
+
+// Wait for the oldest batch of in_flight and deliver its results
+void SignClassificationBatcher::waitBatch(std::deque<Batch> &in_flight) {
+    Batch batch = std::move(in_flight.front());
+    in_flight.pop_front();
+
+    std::vector<int> labels;
+    std::vector<float> confidences;
+    if (!model->wait(labels, 0, &confidences)) {
+        std::cerr << "Error on running traffic sign classification model." << std::endl;
+    }
+    for (size_t i = 0; i < batch.items.size(); ++i) {
+        bool has_result = i < labels.size() && i < confidences.size();
+        deliver(batch.items[i], has_result ? labels[i] : -1, has_result ? confidences[i] : 0);
+    }
+}
+
+void SignClassificationBatcher::deliver(Item &item, int class_id, float confidence) {
+    Request &request = *item.request;
+    request.result.class_ids[item.index] = class_id;
+    request.result.confidences[item.index] = confidence;
+    if (--request.n_remaining == 0) {
+        request.promise.set_value(std::move(request.result));
+    }
+}
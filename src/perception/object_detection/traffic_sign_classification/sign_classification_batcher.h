@@ -0,0 +1,92 @@
+#ifndef SIGN_CLASSIFICATION_BATCHER_H
+#define SIGN_CLASSIFICATION_BATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <opencv2/core.hpp>
+
+struct ClassificationNet;
+
+// Classification of the crops of one request: class id (-1 if inference
+// failed) and probability of each crop, in the order of the crops
+struct SignClassificationResult {
+    std::vector<int> class_ids;
+    std::vector<float> confidences;
+};
+
+// Statistics of a batcher
+struct SignClassificationBatcherStats {
+    uint64_t n_crops = 0;
+    uint64_t n_batches = 0;
+    uint64_t n_full_batches = 0;  // Batches run because they were full
+};
+
+// Dynamic batching of traffic sign classification: crops of any number of
+// requests (frames, cameras) are queued and run together by a worker
+// thread. A batch is run when it is full, or when the oldest queued crop
+// has waited for its maximum delay. Results are delivered through the
+// future of each request.
+// Thread-safe. The network is only used by the worker thread
+class SignClassificationBatcher {
+   private:
+    typedef std::chrono::steady_clock clock_t;
+
+    struct Request {
+        std::promise<SignClassificationResult> promise;
+        SignClassificationResult result;
+        size_t n_remaining;
+    };
+
+    // A queued crop: index in its request
+    struct Item {
+        std::shared_ptr<Request> request;
+        size_t index;
+        cv::Mat crop;
+        clock_t::time_point deadline;
+    };
+
+    // A submitted batch
+    struct Batch {
+        std::vector<Item> items;
+    };
+
+    std::shared_ptr<ClassificationNet> model;
+    int batch_size;
+
+    std::deque<Item> queue;
+    std::mutex mutex;
+    std::condition_variable queue_changed;
+    bool running = true;
+    SignClassificationBatcherStats stats;
+
+    std::thread worker;
+
+    void workerLoop();
+    bool isBatchReady(clock_t::time_point now);
+    void submitBatch(std::deque<Batch> &in_flight);
+    void waitBatch(std::deque<Batch> &in_flight);
+    static void deliver(Item &item, int class_id, float confidence);
+
+   public:
+    // model must accept batches of up to batch_size crops
+    SignClassificationBatcher(std::shared_ptr<ClassificationNet> model, int batch_size);
+    // Run the queued crops, then stop the worker
+    ~SignClassificationBatcher();
+
+    SignClassificationBatcher(const SignClassificationBatcher &) = delete;
+    SignClassificationBatcher &operator=(const SignClassificationBatcher &) = delete;
+
+    // Queue crops, to be classified within max_delay_ms milliseconds
+    // (plus inference time). 0 runs them as soon as the worker is free
+    std::future<SignClassificationResult> classify(const std::vector<cv::Mat> &crops, int max_delay_ms);
+
+    SignClassificationBatcherStats getStats();
+};
+
+#endif
@@ -12,6 +12,7 @@ TrafficSignClassifier::TrafficSignClassifier() {
     params.nClasses = SIGN_CLASSIFICATION_N_CLASSES;
     params.uffFilePath = SIGN_CLASSIFICATION_MODEL;
     params.engineFilePath = SIGN_CLASSIFICATION_TENSORRT_PLAN;
+    params.cpuModelFilePath = SIGN_CLASSIFICATION_CPU_MODEL;
     params.classListFile = SIGN_CLASSIFICATION_CLASS_LIST;
     params.forceRebuildEngine = SIGN_CLASSIFICATION_FORCE_REBUILD_ENGINE;
     params.inputTensorNames.push_back(SIGN_CLASSIFICATION_INPUT_NODE);
@@ -22,34 +23,25 @@ TrafficSignClassifier::TrafficSignClassifier() {
     gLogger.reportTestStart(test);
 
     model = std::make_shared<ClassificationNet>(params);
+    ready = model->isReady();
+    batcher = std::unique_ptr<SignClassificationBatcher>(
+        new SignClassificationBatcher(model, params.batchSize));
 }
 
-std::vector<int> TrafficSignClassifier::getSignIds(const std::vector<cv::Mat>& input_imgs, bool filter_sign_by_confidence) {
+std::vector<int> TrafficSignClassifier::getSignIds(const std::vector<cv::Mat>& input_imgs, bool filter_sign_by_confidence,
+                                                   std::vector<float>* confidences) {
 
-    std::vector<int> labels;
-    if (input_imgs.empty()) return labels;
-
-    int n_images = input_imgs.size();
-    int n_batchs = ceil(static_cast<float>(n_images) / params.batchSize);
-    for (int batch = 0; batch < n_batchs; ++batch) {
-
-        std::vector<int> batch_labels;
-        int begin_id = batch * params.batchSize;
-        int end_id = batch * params.batchSize + params.batchSize;
-        if (end_id > n_images) {
-            end_id = batch * params.batchSize + n_images - batch * params.batchSize;
-        }
-        std::vector<cv::Mat>::const_iterator first = input_imgs.begin() + begin_id;
-        std::vector<cv::Mat>::const_iterator last = input_imgs.begin() + end_id;
-        std::vector<cv::Mat> inputs(first, last);
-
-        if (!model->infer(inputs, batch_labels, filter_sign_by_confidence ? SIGN_CLASSIFICATION_THRESH : 0)) {
-            cerr << "Error on running traffic sign classification model." << endl;
+    SignClassificationResult result = classify(input_imgs, 0).get();
+    std::vector<int> &labels = result.class_ids;
+    if (filter_sign_by_confidence) {
+        for (size_t i = 0; i < labels.size(); ++i) {
+            if (result.confidences[i] < SIGN_CLASSIFICATION_THRESH) {
+                labels[i] = -1;
+            }
         }
-
-        labels.reserve(labels.size() + distance(batch_labels.begin(),batch_labels.end()));
-        labels.insert(labels.end(), batch_labels.begin(), batch_labels.end());
-
+    }
+    if (confidences) {
+        confidences->insert(confidences->end(), result.confidences.begin(), result.confidences.end());
     }
 
     assert(input_imgs.size() == labels.size());
@@ -68,6 +60,15 @@ std::vector<int> TrafficSignClassifier::getSignIds(const std::vector<cv::Mat>& i
     return labels;
 }
 
+std::future<SignClassificationResult> TrafficSignClassifier::classify(const std::vector<cv::Mat>& input_imgs,
+                                                                     int max_delay_ms) {
+    return batcher->classify(input_imgs, max_delay_ms);
+}
+
+SignClassificationBatcherStats TrafficSignClassifier::getBatcherStats() {
+    return batcher->getStats();
+}
+
 std::vector<std::string> TrafficSignClassifier::getSignNames(const std::vector<cv::Mat>& input_imgs) {
     std::vector<int> ids = getSignIds(input_imgs);
     return getSignNames(ids);
@@ -9,19 +9,33 @@
 
 #include "configs/config_sign_classification.h"
 #include "../../common/uff_models/classification_net/classification_net.h"
+#include "sign_classification_batcher.h"
 
 class TrafficSignClassifier {
 
    private:
     UffModelParams params;
     std::shared_ptr<ClassificationNet> model;
+    // Runs all inferences of model
+    std::unique_ptr<SignClassificationBatcher> batcher;
 
    public:
     bool ready = false;
 
     TrafficSignClassifier();
 
-    std::vector<int> getSignIds(const std::vector<cv::Mat>& input_img, bool filter_sign_by_confidence=true);
+    // Class id of each image, -1 if below SIGN_CLASSIFICATION_THRESH when
+    // filtering by confidence. The probability of each class id is
+    // written to confidences if not null
+    // Blocks until the images are classified, without batching them
+    // with other requests
+    std::vector<int> getSignIds(const std::vector<cv::Mat>& input_img, bool filter_sign_by_confidence=true,
+                                std::vector<float>* confidences=nullptr);
+    // Asynchronous classification, batched with the crops of other calls
+    // (other frames or cameras) queued within max_delay_ms. Thread-safe
+    std::future<SignClassificationResult> classify(const std::vector<cv::Mat>& input_imgs,
+                                                   int max_delay_ms=SIGN_CLASSIFICATION_MAX_BATCH_DELAY);
+    SignClassificationBatcherStats getBatcherStats();
     std::vector<std::string> getSignNames(const std::vector<cv::Mat>& input_imgs);
     std::vector<std::string> getSignNames(std::vector<int>& class_ids);
     std::string getSignName(int class_id);
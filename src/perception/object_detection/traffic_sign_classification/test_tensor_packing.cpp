@@ -0,0 +1,90 @@
+// Test of resizeImageToTensor() (no model needed): compare it with
+// cv::resize + packImageToTensor() on crops (ROIs of a larger image) of
+// odd sizes, crops smaller than the network input (upscaled, as most sign
+// crops are), 1-pixel-wide and 1-pixel-high crops, and downscaled crops.
+// Values may only differ by the rounding of cv::resize to 8 bits.
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "tensor_packing.h"
+#include "utils/test_utils.h"
+
+using namespace std;
+
+// Max difference between both paths, in pixel values
+float compare(const cv::Mat& crop, cv::Size size, bool swap_rb, float scale, float offset) {
+    // Two tensors in the batch, to check batch_index too
+    size_t volume = 3 * size.area();
+    std::vector<float> fused(2 * volume, -1000), expected(2 * volume, 1000);
+    resizeImageToTensor(crop, size, fused.data(), 1, swap_rb, scale, offset);
+
+    cv::Mat resized;
+    cv::resize(crop, resized, size);
+    packImageToTensor(resized, expected.data(), 1, swap_rb, scale, offset);
+
+    float max_diff = 0;
+    for (size_t i = volume; i < 2 * volume; ++i) {
+        max_diff = std::max(max_diff, std::abs(fused[i] - expected[i]) / scale);
+    }
+    // The first tensor of the batch is untouched
+    for (size_t i = 0; i < volume; ++i) {
+        if (fused[i] != -1000) {
+            return 1000;
+        }
+    }
+    return max_diff;
+}
+
+int main(int argc, char** argv) {
+    const std::string keys =
+        "{help h usage ? |      | print this message   }";
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Tensor packing test");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    cv::Mat image(300, 400, CV_8UC3);
+    cv::RNG rng(1234);
+    rng.fill(image, cv::RNG::UNIFORM, 0, 256);
+
+    struct Case {
+        cv::Rect roi;
+        cv::Size size;
+        const char* name;
+    };
+    const Case cases[] = {
+        {cv::Rect(10, 20, 37, 53), cv::Size(64, 64), "odd crop size"},
+        {cv::Rect(3, 4, 33, 47), cv::Size(63, 65), "odd crop and output sizes"},
+        {cv::Rect(5, 5, 20, 30), cv::Size(64, 64), "upscaled crop"},
+        {cv::Rect(350, 250, 50, 50), cv::Size(64, 64), "upscaled crop at the image corner"},
+        {cv::Rect(100, 100, 1, 40), cv::Size(64, 64), "1-pixel-wide crop"},
+        {cv::Rect(7, 9, 40, 1), cv::Size(64, 64), "1-pixel-high crop"},
+        {cv::Rect(0, 0, 1, 1), cv::Size(64, 64), "1-pixel crop"},
+        {cv::Rect(50, 60, 200, 150), cv::Size(64, 64), "downscaled crop"},
+        {cv::Rect(0, 0, 400, 300), cv::Size(384, 384), "whole image"},
+    };
+
+    bool ok = true;
+    for (const Case& c : cases) {
+        cv::Mat crop = image(c.roi);
+        float diff = std::max(compare(crop, c.size, true, 1.0f / 255, 0),
+                              compare(crop, c.size, false, 2.0f, -127.5f));
+        // The ROI is read in place: same as a continuous copy of it
+        diff = std::max(diff, compare(crop.clone(), c.size, true, 1.0f / 255, 0));
+        cout << c.name << " " << c.roi.width << "x" << c.roi.height << " to "
+             << c.size.width << "x" << c.size.height << ": max difference " << diff << endl;
+        if (diff > 1.0f) {
+            cerr << "FAILED: " << c.name << endl;
+            ok = false;
+        }
+    }
+
+    return reportTestResult(ok);
+}
@@ -0,0 +1,124 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+// What a queue does when an item is pushed while it is full
+enum QueuePolicy {
+    // Keep only the newest item. Queued items are dropped on every push
+    // (lowest latency: a stage always works on the freshest frame)
+    kQueueLatestWins,
+    // Drop the oldest queued item to make room
+    kQueueDropOldest,
+    // Block the producer until there is room (no frame is dropped)
+    kQueueBlock
+};
+
+// Thread-safe FIFO queue with a maximum size and a drop policy
+template <typename T>
+class BoundedQueue {
+   private:
+    std::deque<T> items;
+    size_t capacity;
+    QueuePolicy policy;
+    bool closed = false;
+    size_t max_size = 0;
+
+    std::mutex mtx;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+   public:
+    BoundedQueue(size_t capacity, QueuePolicy policy) :
+        capacity(capacity > 0 ? capacity : 1), policy(policy) {}
+
+    // Push an item. Items dropped to make room are appended to dropped.
+    // Return false if the queue is closed (the item is not queued)
+    bool push(T item, std::vector<T> &dropped) {
+        std::unique_lock<std::mutex> lck(mtx);
+        if (policy == kQueueBlock) {
+            not_full.wait(lck, [this]() { return closed || items.size() < capacity; });
+        }
+        if (closed) {
+            return false;
+        }
+
+        if (policy == kQueueLatestWins) {
+            while (!items.empty()) {
+                dropped.push_back(std::move(items.front()));
+                items.pop_front();
+            }
+        } else if (policy == kQueueDropOldest) {
+            while (items.size() >= capacity) {
+                dropped.push_back(std::move(items.front()));
+                items.pop_front();
+            }
+        }
+
+        items.push_back(std::move(item));
+        max_size = std::max(max_size, items.size());
+        lck.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // Block until an item is available.
+    // Return false if the queue is closed and empty
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lck(mtx);
+        not_empty.wait(lck, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = std::move(items.front());
+        items.pop_front();
+        lck.unlock();
+        not_full.notify_one();
+        return true;
+    }
+
+    // Reject new items and wake up all waiting threads.
+    // Queued items can still be popped
+    void close() {
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            closed = true;
+        }
+        not_empty.notify_all();
+        not_full.notify_all();
+    }
+
+    // Accept items again after close()
+    void reopen() {
+        std::lock_guard<std::mutex> guard(mtx);
+        closed = false;
+    }
+
+    // Remove and return all queued items
+    std::vector<T> clear() {
+        std::vector<T> removed;
+        {
+            std::lock_guard<std::mutex> guard(mtx);
+            for (T &item : items) removed.push_back(std::move(item));
+            items.clear();
+        }
+        not_full.notify_all();
+        return removed;
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> guard(mtx);
+        return items.size();
+    }
+
+    size_t getMaxSize() {
+        std::lock_guard<std::mutex> guard(mtx);
+        return max_size;
+    }
+};
+
+#endif
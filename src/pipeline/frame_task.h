@@ -0,0 +1,45 @@
+#ifndef FRAME_TASK_H
+#define FRAME_TASK_H
+
+#include <future>
+#include <vector>
+
+#include "sensors/frame.h"
+#include "sensors/preprocess_cache.h"
+#include "perception/object_detection/traffic_object.h"
+#include "perception/object_detection/traffic_sign_classification/sign_classification_batcher.h"
+#include "utils/timer.h"
+
+// A frame flowing through the stages of a pipeline, with the
+// intermediate results of each stage
+struct FrameTask {
+    FramePtr frame;
+
+    // Wall time when the task entered the pipeline
+    Timer::time_point_t begin_time;
+
+    // Preprocess: network input (CHW, normalized), shared
+    // through the preprocessing cache of CarStatus
+    TensorPtr input_data;
+
+    // Object detection: inference slot of the frame while the network runs
+    // on it, then boxes in the coordinates of frame->image
+    int inference_slot = -1;
+    std::vector<Detection> detections;
+
+    // Tracking, then sign classification and distance estimation
+    std::vector<TrafficObject> objects;
+
+    // Sign classification: indices in objects of the signs being
+    // classified, and their result, given by the batcher a few frames later
+    std::vector<size_t> sign_object_ids;
+    std::future<SignClassificationResult> sign_classification;
+
+    // Collision check
+    bool is_collision_warning = false;
+
+    explicit FrameTask(FramePtr frame) :
+        frame(frame), begin_time(Timer::getWallTime()) {}
+};
+
+#endif
@@ -0,0 +1,85 @@
+#include "model_loader.h"
+
+using namespace std;
+
+namespace {
+
+template <typename Model>
+std::shared_ptr<Model> waitModel(const std::shared_future<std::shared_ptr<Model>> &model, int timeout) {
+    if (!model.valid()) {
+        return nullptr;
+    }
+    if (timeout < 0) {
+        model.wait();
+    } else if (model.wait_for(std::chrono::milliseconds(timeout)) != std::future_status::ready) {
+        return nullptr;
+    }
+    return model.get();
+}
+
+}  // namespace
+
+ModelLoader::ModelLoader() {
+    start_time = Timer::getWallTime();
+
+    // Each model gets its own thread: their loading is mostly waiting
+    // for the disk and for TensorRT, which run in parallel
+    object_detector = std::async(std::launch::async, [this]() {
+        std::shared_ptr<ObjectDetector> model = std::make_shared<ObjectDetector>();
+        object_detector_load_time = Timer::calcWallTimePassed(start_time);
+        cout << "Object detector loaded in " << object_detector_load_time << " ms" << endl;
+        return model;
+    }).share();
+
+    #ifndef DISABLE_LANE_DETECTOR
+    lane_detector = std::async(std::launch::async, [this]() {
+        std::shared_ptr<LaneDetector> model = std::make_shared<LaneDetector>();
+        lane_detector_load_time = Timer::calcWallTimePassed(start_time);
+        cout << "Lane detector loaded in " << lane_detector_load_time << " ms" << endl;
+        return model;
+    }).share();
+    #endif
+}
+
+ModelLoader::~ModelLoader() {
+    // The loading threads use this object
+    if (object_detector.valid()) object_detector.wait();
+    if (lane_detector.valid()) lane_detector.wait();
+}
+
+std::shared_ptr<ObjectDetector> ModelLoader::getObjectDetector() {
+    return waitModel(object_detector, 0);
+}
+
+std::shared_ptr<LaneDetector> ModelLoader::getLaneDetector() {
+    return waitModel(lane_detector, 0);
+}
+
+std::shared_ptr<ObjectDetector> ModelLoader::waitObjectDetector(int timeout) {
+    return waitModel(object_detector, timeout);
+}
+
+std::shared_ptr<LaneDetector> ModelLoader::waitLaneDetector(int timeout) {
+    return waitModel(lane_detector, timeout);
+}
+
+void ModelLoader::setFirstDetection() {
+    if (time_to_first_detection >= 0) return;
+    Timer::time_duration_t not_set = -1;
+    Timer::time_duration_t elapsed = Timer::calcWallTimePassed(start_time);
+    if (time_to_first_detection.compare_exchange_strong(not_set, elapsed)) {
+        cout << "Time to first detection: " << elapsed << " ms" << endl;
+    }
+}
+
+Timer::time_duration_t ModelLoader::getObjectDetectorLoadTime() {
+    return object_detector_load_time;
+}
+
+Timer::time_duration_t ModelLoader::getLaneDetectorLoadTime() {
+    return lane_detector_load_time;
+}
+
+Timer::time_duration_t ModelLoader::getTimeToFirstDetection() {
+    return time_to_first_detection;
+}
@@ -0,0 +1,58 @@
+#ifndef MODEL_LOADER_H
+#define MODEL_LOADER_H
+
+#include <atomic>
+#include <future>
+#include <iostream>
+#include <memory>
+
+#include "configs/config.h"
+#include "utils/timer.h"
+
+#include "perception/lane_detection/lane_detector.h"
+#include "perception/object_detection/object_detector.h"
+
+// Load the perception models in parallel, each one on its own startup
+// thread, so that the UI and the capture start without waiting for them.
+// Until a model is loaded, its feature is "warming up": get*() return nullptr.
+// Also measures the startup: load time of each model and time from the
+// creation of the loader to the first completed object detection
+class ModelLoader {
+   private:
+    Timer::time_point_t start_time;
+
+    std::shared_future<std::shared_ptr<ObjectDetector>> object_detector;
+    std::shared_future<std::shared_ptr<LaneDetector>> lane_detector;
+
+    std::atomic<Timer::time_duration_t> object_detector_load_time = {-1};
+    std::atomic<Timer::time_duration_t> lane_detector_load_time = {-1};
+    std::atomic<Timer::time_duration_t> time_to_first_detection = {-1};
+
+   public:
+    // Start loading all models. The lane detector is not loaded
+    // when DISABLE_LANE_DETECTOR is defined
+    ModelLoader();
+
+    // Wait for the models still loading
+    ~ModelLoader();
+
+    // Loaded model, or nullptr while it is warming up
+    std::shared_ptr<ObjectDetector> getObjectDetector();
+    std::shared_ptr<LaneDetector> getLaneDetector();
+
+    // Wait up to timeout ms for a model (forever if timeout < 0).
+    // Return nullptr on timeout, or if the model is never loaded
+    std::shared_ptr<ObjectDetector> waitObjectDetector(int timeout = -1);
+    std::shared_ptr<LaneDetector> waitLaneDetector(int timeout = -1);
+
+    // Called for every completed object detection.
+    // Only the first call is recorded
+    void setFirstDetection();
+
+    // Startup metrics in ms, -1 if not happened yet
+    Timer::time_duration_t getObjectDetectorLoadTime();
+    Timer::time_duration_t getLaneDetectorLoadTime();
+    Timer::time_duration_t getTimeToFirstDetection();
+};
+
+#endif
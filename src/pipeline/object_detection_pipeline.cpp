@@ -0,0 +1,203 @@
+#include "object_detection_pipeline.h"
+
+using namespace std;
+
+ObjectDetectionPipeline::ObjectDetectionPipeline(
+    std::shared_ptr<ModelLoader> model_loader,
+    std::shared_ptr<CarStatus> car_status,
+    CollisionWarningController *collision_warning) :
+    model_loader(model_loader), car_status(car_status),
+    collision_warning(collision_warning), traffic_sign_monitor(car_status) {
+
+    car_status_start_time = car_status->getStartTime();
+    tracker_start_time = car_status_start_time;
+
+    // Registered now, so that lockstep replay waits for this pipeline
+    // from the first frame
+    consumer_id = car_status->registerFrameConsumer();
+
+    // The networks of the object detector are not thread-safe:
+    // detection and sign classification have one worker each.
+    // The object_detection stage starts the network on a frame and goes on
+    // with the next frame: detection_results waits for the detections and
+    // decodes them while the network runs on the next frame.
+    // Signs are classified by a batcher: the sign_classification stage
+    // queues the crops of a frame and goes on with the next frame, so that
+    // the crops of consecutive frames can be run as one batch.
+    // sign_results waits for them
+    scheduler.addStage("preprocess",
+        [this](FrameTask &task) { return preprocess(task); },
+        OD_PIPELINE_PREPROCESS_WORKERS, OD_PIPELINE_PREPROCESS_QUEUE_SIZE, OD_PIPELINE_PREPROCESS_QUEUE_POLICY);
+    scheduler.addStage("object_detection",
+        [this](FrameTask &task) { return detectObjects(task); },
+        1, OD_PIPELINE_DETECTION_QUEUE_SIZE, OD_PIPELINE_DETECTION_QUEUE_POLICY);
+    // Frames in flight hold an inference slot: never drop them
+    scheduler.addStage("detection_results",
+        [this](FrameTask &task) { return waitDetections(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, kQueueBlock);
+    scheduler.addStage("tracking",
+        [this](FrameTask &task) { return trackObjects(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, OD_PIPELINE_POSTPROCESS_QUEUE_POLICY);
+    scheduler.addStage("sign_classification",
+        [this](FrameTask &task) { return classifySigns(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, OD_PIPELINE_POSTPROCESS_QUEUE_POLICY);
+    scheduler.addStage("distance_estimation",
+        [this](FrameTask &task) { return estimateDistances(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, OD_PIPELINE_POSTPROCESS_QUEUE_POLICY);
+    scheduler.addStage("sign_results",
+        [this](FrameTask &task) { return waitSigns(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, OD_PIPELINE_POSTPROCESS_QUEUE_POLICY);
+    scheduler.addStage("collision_check",
+        [this](FrameTask &task) { return checkCollision(task); },
+        1, OD_PIPELINE_POSTPROCESS_QUEUE_SIZE, OD_PIPELINE_POSTPROCESS_QUEUE_POLICY);
+
+    // Every frame leaving the pipeline (processed or dropped) is
+    // acknowledged, so that lockstep replay never waits for a dropped frame
+    scheduler.setDoneCallback([this](const FrameTaskPtr &task, bool completed) {
+        if (task->inference_slot >= 0) {
+            object_detector->cancelInference(task->inference_slot);
+        }
+        this->car_status->setFrameProcessed(consumer_id, task->frame->frame_id);
+    });
+}
+
+ObjectDetectionPipeline::~ObjectDetectionPipeline() {
+    stop();
+}
+
+void ObjectDetectionPipeline::setResultCallback(ResultCallback callback) {
+    result_callback = callback;
+}
+
+void ObjectDetectionPipeline::start() {
+    if (running) return;
+    running = true;
+    scheduler.start();
+    capture_thread = std::thread(&ObjectDetectionPipeline::captureThread, this);
+}
+
+void ObjectDetectionPipeline::stop() {
+    if (!running) return;
+    running = false;
+    capture_thread.join();
+    scheduler.stop(true);
+}
+
+void ObjectDetectionPipeline::captureThread(ObjectDetectionPipeline *pipeline) {
+    // Warming up: frames published meanwhile are not processed
+    while (pipeline->running && !pipeline->object_detector) {
+        pipeline->object_detector = pipeline->model_loader->waitObjectDetector(OD_PIPELINE_MAX_FRAME_WAIT);
+    }
+
+    uint64_t processed_frame_id = 0;
+    while (pipeline->running) {
+        // Wake up regularly to check whether the pipeline is stopped
+        FramePtr frame = pipeline->car_status->waitForFrame(processed_frame_id, OD_PIPELINE_MAX_FRAME_WAIT);
+        if (!frame) continue;
+        processed_frame_id = frame->frame_id;
+        pipeline->scheduler.push(std::make_shared<FrameTask>(frame));
+    }
+}
+
+bool ObjectDetectionPipeline::preprocess(FrameTask &task) {
+    // The letterbox is made from the cached image fitted into the network
+    // input. For frames not larger than the input, it is the frame itself
+    std::shared_ptr<PreprocessCache> cache = car_status->getPreprocessCache();
+    const FramePtr &frame = task.frame;
+    task.input_data = cache->getTensor(frame, "object_detection", ObjectDetector::getInputVolume(),
+        [this, &cache, &frame](float *input_data) {
+        object_detector->preprocess(
+            cache->getResized(frame, ObjectDetector::getInputSize(), kResizeKeepAspectRatio), input_data);
+    });
+    return true;
+}
+
+bool ObjectDetectionPipeline::detectObjects(FrameTask &task) {
+    // Waits while two frames are in flight. The input is kept by the task
+    // until the network is done with it
+    task.inference_slot = object_detector->submitInference(task.input_data->data(), task.frame->image);
+    if (task.inference_slot < 0) {
+        cerr << "Error on running object detection model." << endl;
+        task.input_data.reset();
+    }
+    return true;
+}
+
+bool ObjectDetectionPipeline::waitDetections(FrameTask &task) {
+    if (task.inference_slot >= 0) {
+        task.detections = object_detector->waitInference(task.inference_slot);
+        task.inference_slot = -1;
+    }
+    task.input_data.reset();
+    return true;
+}
+
+bool ObjectDetectionPipeline::classifySigns(FrameTask &task) {
+    // Tracked signs reuse their previous classifications.
+    // In lockstep replay, the next frame is only published once this one
+    // is done: its crops can't join the batch, so don't wait for them
+    int max_delay_ms = car_status->isLockstepReplay() ? 0 : SIGN_CLASSIFICATION_MAX_BATCH_DELAY;
+    task.sign_classification = object_detector->submitSignClassification(
+        task.objects, task.frame->image, task.frame->original_image, task.sign_object_ids, max_delay_ms);
+    return true;
+}
+
+bool ObjectDetectionPipeline::waitSigns(FrameTask &task) {
+    object_detector->waitSignClassification(task.objects, task.sign_object_ids, task.sign_classification);
+
+    // Reset traffic sign monitor if car status has changed
+    // (In case of changing simulation)
+    if (car_status_start_time != car_status->getStartTime()) {
+        cout << "CarStatus has been reset!" << endl;
+        car_status_start_time = car_status->getStartTime();
+        traffic_sign_monitor = TrafficSignMonitor(car_status);
+    }
+    traffic_sign_monitor.updateTrafficSign(task.objects, task.frame->capture_time);
+    return true;
+}
+
+bool ObjectDetectionPipeline::trackObjects(FrameTask &task) {
+    // Objects of another simulation are not the same ones
+    if (tracker_start_time != car_status->getStartTime()) {
+        tracker_start_time = car_status->getStartTime();
+        object_tracker.reset();
+    }
+    task.objects.clear();
+    for (const Detection &detection : task.detections) {
+        task.objects.push_back(TrafficObject(detection, ""));
+    }
+    object_tracker.update(task.objects, task.frame->capture_time);
+    return true;
+}
+
+bool ObjectDetectionPipeline::estimateDistances(FrameTask &task) {
+    if (SHOW_DISTANCES) {
+        collision_warning->calculateDistance(task.frame->image, task.objects);
+    }
+    return true;
+}
+
+bool ObjectDetectionPipeline::checkCollision(FrameTask &task) {
+    task.is_collision_warning = collision_warning->isInDangerSituation(task.frame->image.size(), task.objects);
+
+    car_status->setObjectDetectionTime(Timer::calcWallTimePassed(task.begin_time));
+    car_status->setDetectedObjects(task.objects);
+    model_loader->setFirstDetection();
+    car_status->setCollisionWarning(task.is_collision_warning);
+
+    if (result_callback) {
+        result_callback(task);
+    }
+    return true;
+}
+
+std::vector<PipelineStageStats> ObjectDetectionPipeline::getStats() {
+    return scheduler.getStats();
+}
+
+SignClassificationStats ObjectDetectionPipeline::getSignClassificationStats() {
+    if (!object_detector) {
+        return SignClassificationStats();
+    }
+    return object_detector->getSignClassificationStats();
+}
@@ -0,0 +1,81 @@
+#ifndef OBJECT_DETECTION_PIPELINE_H
+#define OBJECT_DETECTION_PIPELINE_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "configs/config.h"
+#include "perception/object_detection/object_detector.h"
+#include "perception/object_detection/object_tracker.h"
+#include "sensors/car_status.h"
+#include "ui/warnings/collision_warning_controller.h"
+#include "ui/warnings/traffic_sign_monitor.h"
+
+#include "model_loader.h"
+#include "pipeline_scheduler.h"
+
+// Object detection as a staged pipeline fed by CarStatus frames:
+// capture -> preprocess -> object detection -> detection results -> tracking
+// -> sign classification -> distance estimation -> sign results
+// -> collision check.
+// Frames are only taken once the object detector is loaded.
+// Queue sizes, policies and worker counts are set in configs/config.h
+class ObjectDetectionPipeline {
+   public:
+    // Called by the last stage for every completed frame
+    typedef std::function<void(const FrameTask &task)> ResultCallback;
+
+   private:
+    std::shared_ptr<ModelLoader> model_loader;
+    // Set by the capture thread when loaded, before taking the first frame
+    std::shared_ptr<ObjectDetector> object_detector;
+    std::shared_ptr<CarStatus> car_status;
+    CollisionWarningController *collision_warning;
+
+    TrafficSignMonitor traffic_sign_monitor;
+    Timer::time_point_t car_status_start_time;
+
+    // Used by the tracking stage only
+    ObjectTracker object_tracker;
+    Timer::time_point_t tracker_start_time;
+
+    PipelineScheduler scheduler;
+    ResultCallback result_callback;
+    int consumer_id;
+
+    std::thread capture_thread;
+    std::atomic<bool> running = {false};
+
+    static void captureThread(ObjectDetectionPipeline *pipeline);
+
+    bool preprocess(FrameTask &task);
+    bool detectObjects(FrameTask &task);
+    bool waitDetections(FrameTask &task);
+    bool trackObjects(FrameTask &task);
+    bool classifySigns(FrameTask &task);
+    bool estimateDistances(FrameTask &task);
+    bool waitSigns(FrameTask &task);
+    bool checkCollision(FrameTask &task);
+
+   public:
+    ObjectDetectionPipeline(std::shared_ptr<ModelLoader> model_loader,
+        std::shared_ptr<CarStatus> car_status,
+        CollisionWarningController *collision_warning);
+    ~ObjectDetectionPipeline();
+
+    void setResultCallback(ResultCallback callback);
+
+    // Start taking frames from CarStatus
+    void start();
+
+    // Stop taking frames, finish queued frames and stop all workers
+    void stop();
+
+    std::vector<PipelineStageStats> getStats();
+    // Empty until the object detector is loaded
+    SignClassificationStats getSignClassificationStats();
+};
+
+#endif
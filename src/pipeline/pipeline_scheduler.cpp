@@ -0,0 +1,127 @@
+#include "pipeline_scheduler.h"
+
+PipelineScheduler::~PipelineScheduler() {
+    stop(false);
+}
+
+void PipelineScheduler::addStage(const std::string &name, StageFunction function, int n_workers,
+    size_t queue_capacity, QueuePolicy policy) {
+    if (is_running) {
+        std::cerr << "Cannot add pipeline stage " << name << " while running" << std::endl;
+        return;
+    }
+    stages.emplace_back(new Stage(name, function, std::max(1, n_workers), queue_capacity, policy));
+}
+
+void PipelineScheduler::setDoneCallback(DoneCallback callback) {
+    done_callback = callback;
+}
+
+void PipelineScheduler::start() {
+    if (is_running) return;
+    is_running = true;
+    // Queues closed by a previous stop() are empty: take tasks again
+    for (auto &stage : stages) {
+        stage->queue.reopen();
+    }
+    for (size_t i = 0; i < stages.size(); ++i) {
+        for (int j = 0; j < stages[i]->n_workers; ++j) {
+            stages[i]->workers.emplace_back(&PipelineScheduler::workerLoop, this, i);
+        }
+    }
+}
+
+bool PipelineScheduler::push(const FrameTaskPtr &task) {
+    if (stages.empty()) {
+        finishTask(task, true);
+        return true;
+    }
+    return pushToStage(0, task);
+}
+
+bool PipelineScheduler::pushToStage(size_t stage_id, const FrameTaskPtr &task) {
+    Stage &stage = *stages[stage_id];
+    std::vector<FrameTaskPtr> dropped;
+    bool queued = stage.queue.push(task, dropped);
+
+    stage.n_dropped += dropped.size();
+    for (const FrameTaskPtr &dropped_task : dropped) {
+        finishTask(dropped_task, false);
+    }
+
+    if (!queued) {
+        ++stage.n_dropped;
+        finishTask(task, false);
+    }
+    return queued;
+}
+
+void PipelineScheduler::workerLoop(size_t stage_id) {
+    Stage &stage = *stages[stage_id];
+    FrameTaskPtr task;
+    while (stage.queue.pop(task)) {
+
+        Timer::time_point_t begin_time = Timer::getWallTime();
+        bool success = stage.function(*task);
+        stage.processing_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+            Timer::getWallTime() - begin_time).count();
+        ++stage.n_processed;
+
+        if (!success) {
+            ++stage.n_failed;
+            finishTask(task, false);
+        } else if (stage_id + 1 < stages.size()) {
+            pushToStage(stage_id + 1, task);
+        } else {
+            finishTask(task, true);
+        }
+        task.reset();
+    }
+}
+
+void PipelineScheduler::finishTask(const FrameTaskPtr &task, bool completed) {
+    if (done_callback) {
+        done_callback(task, completed);
+    }
+}
+
+void PipelineScheduler::stop(bool drain) {
+    if (!is_running) return;
+
+    // Stages are stopped in order, so that tasks still flowing from a
+    // stopped stage can be queued into the next ones when draining
+    for (auto &stage : stages) {
+        if (!drain) {
+            std::vector<FrameTaskPtr> removed = stage->queue.clear();
+            stage->n_dropped += removed.size();
+            for (const FrameTaskPtr &task : removed) {
+                finishTask(task, false);
+            }
+        }
+        stage->queue.close();
+        for (std::thread &worker : stage->workers) {
+            worker.join();
+        }
+        stage->workers.clear();
+    }
+
+    is_running = false;
+}
+
+std::vector<PipelineStageStats> PipelineScheduler::getStats() {
+    std::vector<PipelineStageStats> stats;
+    for (auto &stage : stages) {
+        PipelineStageStats stage_stats;
+        stage_stats.name = stage->name;
+        stage_stats.n_workers = stage->n_workers;
+        stage_stats.n_processed = stage->n_processed;
+        stage_stats.n_dropped = stage->n_dropped;
+        stage_stats.n_failed = stage->n_failed;
+        if (stage_stats.n_processed > 0) {
+            stage_stats.avg_processing_time = stage->processing_time_us / 1000.0 / stage_stats.n_processed;
+        }
+        stage_stats.max_queue_size = stage->queue.getMaxSize();
+        stats.push_back(stage_stats);
+    }
+    return stats;
+}
@@ -0,0 +1,94 @@
+#ifndef PIPELINE_SCHEDULER_H
+#define PIPELINE_SCHEDULER_H
+
+#include <atomic>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bounded_queue.h"
+#include "frame_task.h"
+#include "utils/timer.h"
+
+typedef std::shared_ptr<FrameTask> FrameTaskPtr;
+
+// Statistics of a pipeline stage
+struct PipelineStageStats {
+    std::string name;
+    int n_workers = 0;
+    uint64_t n_processed = 0;  // Tasks processed by this stage
+    uint64_t n_dropped = 0;    // Tasks dropped by the queue policy of this stage
+    uint64_t n_failed = 0;     // Tasks for which the stage function returned false
+    double avg_processing_time = 0;  // ms
+    size_t max_queue_size = 0;
+};
+
+// Run frames through a chain of stages. Each stage has an input queue
+// (bounded, with a drop policy) and its own worker threads.
+// Stages with more than one worker may reorder frames.
+class PipelineScheduler {
+   public:
+    // Process a task. Return false to drop it (it won't reach the next stages)
+    typedef std::function<bool(FrameTask &task)> StageFunction;
+
+    // Called once for every task leaving the pipeline: completed after
+    // the last stage, or not completed if it was dropped or failed
+    typedef std::function<void(const FrameTaskPtr &task, bool completed)> DoneCallback;
+
+   private:
+    struct Stage {
+        std::string name;
+        StageFunction function;
+        int n_workers;
+        BoundedQueue<FrameTaskPtr> queue;
+        std::vector<std::thread> workers;
+        std::atomic<uint64_t> n_processed = {0};
+        std::atomic<uint64_t> n_dropped = {0};
+        std::atomic<uint64_t> n_failed = {0};
+        std::atomic<long long> processing_time_us = {0};
+
+        Stage(const std::string &name, StageFunction function, int n_workers,
+            size_t queue_capacity, QueuePolicy policy) :
+            name(name), function(function), n_workers(n_workers),
+            queue(queue_capacity, policy) {}
+    };
+
+    std::vector<std::unique_ptr<Stage>> stages;
+    DoneCallback done_callback;
+    bool is_running = false;
+
+    void workerLoop(size_t stage_id);
+    bool pushToStage(size_t stage_id, const FrameTaskPtr &task);
+    void finishTask(const FrameTaskPtr &task, bool completed);
+
+   public:
+    PipelineScheduler() {}
+    ~PipelineScheduler();
+
+    PipelineScheduler(const PipelineScheduler &) = delete;
+    PipelineScheduler &operator=(const PipelineScheduler &) = delete;
+
+    // Append a stage. Must be called before start()
+    void addStage(const std::string &name, StageFunction function, int n_workers = 1,
+        size_t queue_capacity = 1, QueuePolicy policy = kQueueLatestWins);
+
+    void setDoneCallback(DoneCallback callback);
+
+    // Start worker threads of all stages. Can be called again after stop()
+    void start();
+
+    // Push a task into the first stage.
+    // Return false if the pipeline is stopped
+    bool push(const FrameTaskPtr &task);
+
+    // Stop all workers. If drain is true, queued tasks are processed
+    // first. Otherwise they are dropped
+    void stop(bool drain = true);
+
+    std::vector<PipelineStageStats> getStats();
+};
+
+#endif
@@ -2,15 +2,16 @@
 
 using namespace std;
 
-CarStatus::CarStatus() {
+CarStatus::CarStatus() :
+    preprocess_cache(std::make_shared<PreprocessCache>(PREPROCESS_CACHE_MAX_FRAMES)) {
     std::lock_guard<std::mutex> guard(start_time_mutex);
-    start_time = Timer::getCurrentTime();
+    start_time = Timer::getWallTime();
 }
 
 void CarStatus::reset() {
     {
         std::lock_guard<std::mutex> guard(start_time_mutex);
-        start_time = Timer::getCurrentTime();
+        start_time = Timer::getWallTime();
     }
     {
         std::lock_guard<std::mutex> guard2(speed_limit_mutex);
@@ -21,7 +22,6 @@ void CarStatus::reset() {
     // Reset image
     setDetectedLaneLines(std::vector<LaneLine>());
     setDetectedObjects(std::vector<TrafficObject>());
-    cv::Mat current_img = getCurrentImage();
     cv::Mat black_image(240, 320, CV_8UC3, cv::Scalar(0, 0, 0));
     cv::putText(black_image, "Loading...", cv::Point2f(50,100), cv::FONT_HERSHEY_PLAIN, 1.2,  cv::Scalar(255,255,255));
     setCurrentImage(black_image);
@@ -34,27 +34,116 @@ Timer::time_point_t CarStatus::getStartTime() {
     return start_time;
 }
 
-void CarStatus::setCurrentImage(const cv::Mat &img) {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
+FramePtr CarStatus::setCurrentImage(const cv::Mat &img) {
+    return setCurrentImage(img, Timer::getCurrentTime());
+}
+
+FramePtr CarStatus::setCurrentImage(const cv::Mat &img, Timer::time_point_t capture_time) {
     cv::Mat resized = resizeByMaxSize(img, IMG_MAX_SIZE);
-    current_img = resized;
-    img.copyTo(current_img_origin_size);
+    FramePtr frame;
+    {
+        // Ids follow the publishing order, even with several publishers
+        std::lock_guard<std::mutex> publish_guard(publish_mutex);
+        frame = std::make_shared<const Frame>(last_frame_id + 1, capture_time, resized, img);
+        current_frame.publish(frame);
+        std::lock_guard<std::mutex> guard(new_frame_mutex);
+        last_frame_id = frame->frame_id;
+    }
+    new_frame_cv.notify_all();
+    return frame;
+}
+
+FramePtr CarStatus::getCurrentFrame() {
+    return current_frame.load();
+}
+
+uint64_t CarStatus::getLastFrameId() {
+    return last_frame_id;
+}
+
+FramePtr CarStatus::waitForFrame(uint64_t processed_frame_id, Timer::time_duration_t timeout) {
+    std::unique_lock<std::mutex> lck(new_frame_mutex);
+    auto has_new_frame = [this, processed_frame_id]() {
+        return last_frame_id > processed_frame_id;
+    };
+    if (timeout < 0) {
+        new_frame_cv.wait(lck, has_new_frame);
+    } else if (!new_frame_cv.wait_for(lck, std::chrono::milliseconds(timeout), has_new_frame)) {
+        return nullptr;
+    }
+    lck.unlock();
+    return getCurrentFrame();
+}
+
+int CarStatus::registerFrameConsumer() {
+    std::lock_guard<std::mutex> guard(frame_consumers_mutex);
+    consumer_processed_frame_ids.push_back(0);
+    return consumer_processed_frame_ids.size() - 1;
+}
+
+void CarStatus::setFrameProcessed(int consumer_id, uint64_t frame_id) {
+    {
+        std::lock_guard<std::mutex> guard(frame_consumers_mutex);
+        // Frames may be acknowledged out of order (dropped frames)
+        consumer_processed_frame_ids[consumer_id] = std::max(
+            consumer_processed_frame_ids[consumer_id], frame_id);
+    }
+    frame_processed_cv.notify_all();
+}
+
+bool CarStatus::waitForFrameConsumers(uint64_t frame_id, Timer::time_duration_t timeout,
+    int except_consumer_id) {
+    std::unique_lock<std::mutex> lck(frame_consumers_mutex);
+    auto all_processed = [this, frame_id, except_consumer_id]() {
+        for (size_t i = 0; i < consumer_processed_frame_ids.size(); ++i) {
+            if (static_cast<int>(i) != except_consumer_id &&
+                consumer_processed_frame_ids[i] < frame_id) return false;
+        }
+        return true;
+    };
+    if (timeout < 0) {
+        frame_processed_cv.wait(lck, all_processed);
+        return true;
+    }
+    return frame_processed_cv.wait_for(lck, std::chrono::milliseconds(timeout), all_processed);
+}
+
+void CarStatus::setLockstepReplay(bool lockstep) {
+    lockstep_replay = lockstep;
+}
+
+bool CarStatus::isLockstepReplay() {
+    return lockstep_replay;
+}
+
+std::shared_ptr<PreprocessCache> CarStatus::getPreprocessCache() {
+    return preprocess_cache;
 }
 
 cv::Mat CarStatus::getCurrentImage() {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
-    return current_img.clone();
+    FramePtr frame = getCurrentFrame();
+    if (!frame) return cv::Mat();
+    return frame->image.clone();
 }
 
 void CarStatus::getCurrentImage(cv::Mat &image) {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
-    return current_img.copyTo(image);
+    FramePtr frame = getCurrentFrame();
+    if (!frame) {
+        image.release();
+        return;
+    }
+    frame->image.copyTo(image);
 }
 
 void CarStatus::getCurrentImage(cv::Mat &image, cv::Mat &original_image) {
-    std::lock_guard<std::mutex> guard(current_img_mutex);
-    current_img.copyTo(image);
-    current_img_origin_size.copyTo(original_image);
+    FramePtr frame = getCurrentFrame();
+    if (!frame) {
+        image.release();
+        original_image.release();
+        return;
+    }
+    frame->image.copyTo(image);
+    frame->original_image.copyTo(original_image);
 }
 
 
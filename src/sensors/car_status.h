@@ -2,6 +2,7 @@
 #define CAR_STATUS_H
 
 #include <mutex>
+#include <condition_variable>
 #include <opencv2/opencv.hpp>
 #include <string>
 #include <vector>
@@ -13,6 +14,9 @@
 
 #include "sensors/collision_warning_status.h"
 #include "sensors/speed_limit.h"
+#include "sensors/frame.h"
+#include "sensors/frame_exchange.h"
+#include "sensors/preprocess_cache.h"
 
 #include "utils/timer.h"
 
@@ -24,10 +28,28 @@ class CarStatus {
     Timer::time_point_t start_time;
     std::mutex start_time_mutex;
 
-    // Current image
-    cv::Mat current_img;
-    cv::Mat current_img_origin_size;
-    std::mutex current_img_mutex;
+    // Current frame. Readers never lock and never copy images.
+    // Publishers (the capture thread, reset()) are serialized by
+    // publish_mutex, which also numbers the frames in publishing order
+    FrameExchange current_frame;
+    std::mutex publish_mutex;
+    std::atomic<uint64_t> last_frame_id = {0};
+
+    // Notify waiting workers when a new frame arrives
+    std::mutex new_frame_mutex;
+    std::condition_variable new_frame_cv;
+
+    // Last frame id processed by each registered consumer.
+    // Used by offline replay to publish a frame only after
+    // all consumers are done with the previous one
+    std::vector<uint64_t> consumer_processed_frame_ids;
+    std::mutex frame_consumers_mutex;
+    std::condition_variable frame_processed_cv;
+    std::atomic<bool> lockstep_replay = {false};
+
+    // Resized images and network inputs of the latest frames,
+    // shared by lane detection and object detection
+    std::shared_ptr<PreprocessCache> preprocess_cache;
 
     // Lane detection result
     cv::Mat lane_line_mask;
@@ -65,10 +87,48 @@ class CarStatus {
     void reset();
     Timer::time_point_t getStartTime();
 
-    void setCurrentImage(const cv::Mat &img);
-    void getCurrentImage(cv::Mat &image, cv::Mat &original_image);
+    // Publish a new frame. The frame keeps a reference to the buffer of img,
+    // so the caller must not write into img after calling this function
+    // (read each captured frame into a new cv::Mat)
+    FramePtr setCurrentImage(const cv::Mat &img);
+    FramePtr setCurrentImage(const cv::Mat &img, Timer::time_point_t capture_time);
+
+    // Get the latest frame without copying images. Return nullptr if
+    // no frame has been published
+    FramePtr getCurrentFrame();
+    uint64_t getLastFrameId();
+
+    // Block until a frame newer than processed_frame_id is published,
+    // then return the latest frame.
+    // Return nullptr if timeout (ms) passes first. timeout < 0: wait forever
+    FramePtr waitForFrame(uint64_t processed_frame_id, Timer::time_duration_t timeout = -1);
+
+    // Register a processing thread which must consume every frame during
+    // lockstep replay. Return the consumer id used in setFrameProcessed()
+    int registerFrameConsumer();
+
+    // Called by a consumer after it has finished processing a frame
+    void setFrameProcessed(int consumer_id, uint64_t frame_id);
+
+    // Block until all registered consumers have processed frame_id.
+    // A consumer using the results of the others on frame_id gives its own
+    // id as except_consumer_id.
+    // Return false if timeout (ms) passes first. timeout < 0: wait forever
+    bool waitForFrameConsumers(uint64_t frame_id, Timer::time_duration_t timeout = -1,
+        int except_consumer_id = -1);
+
+    // Set by the producer while a lockstep replay is running.
+    // Consumers should not throttle themselves in this mode
+    void setLockstepReplay(bool lockstep);
+    bool isLockstepReplay();
+
+    std::shared_ptr<PreprocessCache> getPreprocessCache();
+
+    // Get a writable copy of the current image
+    // (for drawing on it). Prefer getCurrentFrame() for reading
     cv::Mat getCurrentImage();
-    void getCurrentImage(cv::Mat &image); // Better performance
+    void getCurrentImage(cv::Mat &image);
+    void getCurrentImage(cv::Mat &image, cv::Mat &original_image);
 
     void setDetectedObjects(const std::vector<TrafficObject> &objects);
     std::vector<TrafficObject> getDetectedObjects();
@@ -0,0 +1,36 @@
+#ifndef FRAME_H
+#define FRAME_H
+
+#include <stdint.h>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+#include "utils/timer.h"
+
+// A camera frame shared between processing threads.
+// A frame is immutable after being published by CarStatus, so readers
+// can hold a reference to it instead of copying the images.
+// Never write into image or original_image of a published frame.
+struct Frame {
+
+    // Monotonically increasing id. 0 means "no frame"
+    uint64_t frame_id = 0;
+
+    // Time when the frame was captured
+    Timer::time_point_t capture_time;
+
+    // Image resized by IMG_MAX_SIZE (used for processing and displaying)
+    cv::Mat image;
+
+    // Image with the original size (used to crop traffic signs)
+    cv::Mat original_image;
+
+    Frame(uint64_t frame_id, Timer::time_point_t capture_time,
+        const cv::Mat &image, const cv::Mat &original_image) :
+        frame_id(frame_id), capture_time(capture_time),
+        image(image), original_image(original_image) {}
+};
+
+typedef std::shared_ptr<const Frame> FramePtr;
+
+#endif
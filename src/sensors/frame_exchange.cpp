@@ -0,0 +1,45 @@
+#include "frame_exchange.h"
+
+#include <thread>
+
+void FrameExchange::publish(FramePtr frame) {
+    int latest = latest_slot.load();
+    while (true) {
+        for (int i = 0; i < N_SLOTS; ++i) {
+            int n_readers = 0;
+            if (i != latest && slots[i].n_readers.compare_exchange_strong(n_readers, WRITING)) {
+                // The previous frame of the slot is released here, unless
+                // a reader still holds it
+                slots[i].frame = std::move(frame);
+                slots[i].n_readers.store(0);
+                latest_slot.store(i);
+                return;
+            }
+        }
+        // Both other slots are pinned: readers only hold them while
+        // copying a pointer
+        std::this_thread::yield();
+    }
+}
+
+FramePtr FrameExchange::load() const {
+    while (true) {
+        int i = latest_slot.load();
+        if (i < 0) {
+            return nullptr;
+        }
+        Slot& slot = slots[i];
+        int n_readers = slot.n_readers.load();
+        // A slot is only written once it is no longer the latest one:
+        // reload the latest slot
+        if (n_readers == WRITING) {
+            continue;
+        }
+        if (!slot.n_readers.compare_exchange_weak(n_readers, n_readers + 1)) {
+            continue;
+        }
+        FramePtr frame = slot.frame;
+        slot.n_readers.fetch_sub(1);
+        return frame;
+    }
+}
@@ -0,0 +1,40 @@
+#ifndef FRAME_EXCHANGE_H
+#define FRAME_EXCHANGE_H
+
+#include <atomic>
+
+#include "sensors/frame.h"
+
+// Latest published frame, exchanged without locks between one writer
+// and any number of readers (triple buffer).
+// The writer puts each new frame into a slot that is neither the latest
+// one nor being read, then makes it the latest. Readers only pin a slot
+// while copying its FramePtr (one reference count increment), so the
+// writer never waits on image processing, and readers never wait for
+// the writer: a reader meeting a slot being written reloads the latest
+// slot, which is never written.
+// Single writer: publish() must not be called from two threads at once
+class FrameExchange {
+   private:
+    static constexpr int N_SLOTS = 3;
+    // Readers count of a slot being written
+    static constexpr int WRITING = -1;
+
+    struct Slot {
+        FramePtr frame;
+        // Readers copying frame, or WRITING
+        std::atomic<int> n_readers = {0};
+    };
+    mutable Slot slots[N_SLOTS];
+
+    // Slot of the latest frame. -1 before the first frame
+    std::atomic<int> latest_slot = {-1};
+
+   public:
+    void publish(FramePtr frame);
+
+    // Latest frame. nullptr if no frame has been published
+    FramePtr load() const;
+};
+
+#endif
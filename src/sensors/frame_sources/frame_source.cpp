@@ -0,0 +1,37 @@
+#include "frame_source.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "utils/filesystem_include.h"
+
+#include "image_sequence_source.h"
+#include "raw_frame_source.h"
+#include "v4l2_source.h"
+#include "video_file_source.h"
+
+namespace {
+
+bool isNumber(const std::string &s) {
+    return !s.empty() && std::all_of(s.begin(), s.end(), ::isdigit);
+}
+
+bool endsWith(const std::string &s, const std::string &suffix) {
+    return s.size() >= suffix.size() &&
+        s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+std::shared_ptr<FrameSource> createFrameSource(const std::string &source) {
+    if (isNumber(source)) {
+        return std::make_shared<V4L2Source>("/dev/video" + source);
+    } else if (source.rfind("/dev/video", 0) == 0) {
+        return std::make_shared<V4L2Source>(source);
+    } else if (fs::is_directory(source)) {
+        return std::make_shared<ImageSequenceSource>(source);
+    } else if (endsWith(source, RAW_FRAME_FILE_EXTENSION)) {
+        return std::make_shared<RawFrameSource>(source);
+    }
+    return std::make_shared<VideoFileSource>(source);
+}
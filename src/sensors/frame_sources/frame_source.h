@@ -0,0 +1,50 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <memory>
+#include <string>
+#include <opencv2/opencv.hpp>
+
+// Interface of all frame inputs (cameras, video files, image folders,
+// raw frame files). Frames read from a source are published to CarStatus.
+class FrameSource {
+   public:
+    virtual ~FrameSource() {}
+
+    // Open the source. Return false on failure
+    virtual bool open() = 0;
+    virtual void close() = 0;
+    virtual bool isOpened() = 0;
+
+    // Read the next frame.
+    // Each call returns a new buffer (frames are shared by reference after
+    // being published), so never pass a Mat that is still in use.
+    // Return false at the end of the stream or on error
+    virtual bool read(cv::Mat &frame) = 0;
+
+    // Timestamp of the last read frame (ms from the beginning of the stream)
+    virtual double getTimestamp() = 0;
+
+    // A live source produces frames on its own clock (camera).
+    // Other sources can be read as fast as the consumer wants
+    virtual bool isLive() { return false; }
+
+    // Frame rate and number of frames. Return -1 if unknown
+    virtual double getFPS() { return -1; }
+    virtual int getFrameCount() { return -1; }
+
+    // Move to a frame. Return false if not supported
+    virtual bool seek(int frame_id) { return false; }
+
+    virtual std::string getName() = 0;
+};
+
+// Create a frame source from a description:
+//   - A number or /dev/videoX: V4L2 camera (OpenCV capture if the camera
+//     can't be used through V4L2 directly)
+//   - A folder: PNG/JPG image sequence (sorted by file name)
+//   - A file with RAW_FRAME_FILE_EXTENSION: memory-mapped raw frames
+//   - Other files: video file
+std::shared_ptr<FrameSource> createFrameSource(const std::string &source);
+
+#endif
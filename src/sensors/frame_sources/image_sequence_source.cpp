@@ -0,0 +1,72 @@
+#include "image_sequence_source.h"
+
+#include <algorithm>
+
+#include "utils/filesystem_include.h"
+
+ImageSequenceSource::ImageSequenceSource(const std::string &folder_path, double fps)
+    : folder_path(folder_path), fps(fps) {}
+
+bool ImageSequenceSource::open() {
+    image_paths.clear();
+    next_image_id = 0;
+
+    if (!fs::is_directory(folder_path)) {
+        return false;
+    }
+
+    for (auto &p : fs::directory_iterator(folder_path)) {
+        std::string extension = p.path().extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        if (extension == ".png" || extension == ".jpg" || extension == ".jpeg") {
+            image_paths.push_back(p.path().string());
+        }
+    }
+    std::sort(image_paths.begin(), image_paths.end());
+
+    is_opened = !image_paths.empty();
+    return is_opened;
+}
+
+void ImageSequenceSource::close() {
+    image_paths.clear();
+    is_opened = false;
+}
+
+bool ImageSequenceSource::isOpened() {
+    return is_opened;
+}
+
+bool ImageSequenceSource::read(cv::Mat &frame) {
+    if (next_image_id >= image_paths.size()) {
+        return false;
+    }
+    frame = cv::imread(image_paths[next_image_id]);
+    ++next_image_id;
+    return !frame.empty();
+}
+
+double ImageSequenceSource::getTimestamp() {
+    if (next_image_id == 0) return 0;
+    return (next_image_id - 1) * 1000.0 / fps;
+}
+
+double ImageSequenceSource::getFPS() {
+    return fps;
+}
+
+int ImageSequenceSource::getFrameCount() {
+    return static_cast<int>(image_paths.size());
+}
+
+bool ImageSequenceSource::seek(int frame_id) {
+    if (frame_id < 0 || frame_id >= static_cast<int>(image_paths.size())) {
+        return false;
+    }
+    next_image_id = frame_id;
+    return true;
+}
+
+std::string ImageSequenceSource::getName() {
+    return folder_path;
+}
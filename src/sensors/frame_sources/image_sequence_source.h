@@ -0,0 +1,34 @@
+#ifndef IMAGE_SEQUENCE_SOURCE_H
+#define IMAGE_SEQUENCE_SOURCE_H
+
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+// Read PNG/JPG images from a folder, sorted by file name
+class ImageSequenceSource : public FrameSource {
+   private:
+    std::string folder_path;
+    std::vector<std::string> image_paths;
+    size_t next_image_id = 0;
+    double fps;
+    bool is_opened = false;
+
+   public:
+    // fps is used to generate timestamps
+    explicit ImageSequenceSource(const std::string &folder_path, double fps = 30);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() override;
+    bool read(cv::Mat &frame) override;
+    double getTimestamp() override;
+    double getFPS() override;
+    int getFrameCount() override;
+    bool seek(int frame_id) override;
+    std::string getName() override;
+};
+
+#endif
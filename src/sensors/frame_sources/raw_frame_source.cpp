@@ -0,0 +1,198 @@
+#include "raw_frame_source.h"
+
+#include <string.h>
+
+namespace {
+
+size_t alignSize(size_t size) {
+    return (size + RAW_FRAME_FILE_ALIGNMENT - 1) / RAW_FRAME_FILE_ALIGNMENT * RAW_FRAME_FILE_ALIGNMENT;
+}
+
+// Allocator of Mats pointing into a mapped raw frame file.
+// Each Mat holds a reference to the mapping, which is released together
+// with the last Mat using it.
+class MappedFrameAllocator : public cv::MatAllocator {
+   public:
+    // New allocations (never requested for wrapped frames) use the default allocator
+    cv::UMatData *allocate(int dims, const int *sizes, int type, void *data,
+                           size_t *step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage_flags) const override {
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+    }
+
+    bool allocate(cv::UMatData *u, cv::AccessFlag access_flags,
+                  cv::UMatUsageFlags usage_flags) const override {
+        return cv::Mat::getStdAllocator()->allocate(u, access_flags, usage_flags);
+    }
+
+    void deallocate(cv::UMatData *u) const override {
+        if (u == nullptr) return;
+        delete static_cast<std::shared_ptr<MappedFile> *>(u->userdata);
+        delete u;
+    }
+
+    cv::Mat wrap(const std::shared_ptr<MappedFile> &mapped_file, const char *data,
+                 int rows, int cols, int type, size_t size) const {
+        cv::Mat frame(rows, cols, type, const_cast<char *>(data));
+        cv::UMatData *u = new cv::UMatData(this);
+        u->data = u->origdata = reinterpret_cast<uchar *>(const_cast<char *>(data));
+        u->size = size;
+        u->refcount = 1;
+        u->userdata = new std::shared_ptr<MappedFile>(mapped_file);
+        frame.u = u;
+        frame.allocator = this;
+        return frame;
+    }
+};
+
+// Never destroyed: wrapped frames may outlive static objects
+const MappedFrameAllocator *getMappedFrameAllocator() {
+    static const MappedFrameAllocator *allocator = new MappedFrameAllocator();
+    return allocator;
+}
+
+}  // namespace
+
+RawFrameSource::RawFrameSource(const std::string &file_path)
+    : file_path(file_path) {}
+
+bool RawFrameSource::open() {
+    close();
+
+    std::shared_ptr<MappedFile> file = std::make_shared<MappedFile>();
+    if (!file->open(file_path)) {
+        return false;
+    }
+
+    if (file->getSize() < sizeof(RawFrameFileHeader)) {
+        std::cerr << "Invalid raw frame file: " << file_path << std::endl;
+        return false;
+    }
+    memcpy(&header, file->getData(), sizeof(RawFrameFileHeader));
+
+    if (strncmp(header.magic, RAW_FRAME_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != RAW_FRAME_FILE_VERSION) {
+        std::cerr << "Invalid raw frame file: " << file_path << std::endl;
+        return false;
+    }
+
+    size_t timestamps_offset = alignSize(sizeof(RawFrameFileHeader)) + header.n_frames * header.frame_stride;
+    if (file->getSize() < timestamps_offset + header.n_frames * sizeof(double)) {
+        std::cerr << "Truncated raw frame file: " << file_path << std::endl;
+        return false;
+    }
+
+    timestamps = reinterpret_cast<const double *>(file->getData() + timestamps_offset);
+    file->adviseSequential();
+    mapped_file = file;
+    next_frame_id = 0;
+    return true;
+}
+
+void RawFrameSource::close() {
+    // Frames still in use keep their own reference to the mapping
+    mapped_file.reset();
+    timestamps = nullptr;
+}
+
+bool RawFrameSource::isOpened() {
+    return mapped_file != nullptr;
+}
+
+bool RawFrameSource::read(cv::Mat &frame) {
+    if (!mapped_file || next_frame_id >= header.n_frames) {
+        return false;
+    }
+
+    const char *data = mapped_file->getData() + alignSize(sizeof(RawFrameFileHeader))
+        + next_frame_id * header.frame_stride;
+    frame = getMappedFrameAllocator()->wrap(mapped_file, data,
+        header.height, header.width, header.type, header.frame_size);
+    ++next_frame_id;
+    return true;
+}
+
+double RawFrameSource::getTimestamp() {
+    if (timestamps == nullptr || next_frame_id == 0) return 0;
+    return timestamps[next_frame_id - 1];
+}
+
+double RawFrameSource::getFPS() {
+    return header.fps;
+}
+
+int RawFrameSource::getFrameCount() {
+    if (!mapped_file) return -1;
+    return static_cast<int>(header.n_frames);
+}
+
+bool RawFrameSource::seek(int frame_id) {
+    if (!mapped_file || frame_id < 0 || frame_id >= static_cast<int>(header.n_frames)) {
+        return false;
+    }
+    next_frame_id = frame_id;
+    return true;
+}
+
+std::string RawFrameSource::getName() {
+    return file_path;
+}
+
+
+RawFrameWriter::~RawFrameWriter() {
+    close();
+}
+
+bool RawFrameWriter::open(const std::string &file_path, int width, int height, int type, double fps) {
+    close();
+
+    file.open(file_path, std::ios::binary | std::ios::out | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Could not create raw frame file: " << file_path << std::endl;
+        return false;
+    }
+
+    memset(&header, 0, sizeof(header));
+    strncpy(header.magic, RAW_FRAME_FILE_MAGIC, sizeof(header.magic));
+    header.version = RAW_FRAME_FILE_VERSION;
+    header.width = width;
+    header.height = height;
+    header.type = type;
+    header.frame_size = static_cast<uint64_t>(width) * height * CV_ELEM_SIZE(type);
+    header.frame_stride = alignSize(header.frame_size);
+    header.n_frames = 0;
+    header.fps = fps;
+    timestamps.clear();
+
+    // Header is rewritten with the final number of frames on close()
+    std::vector<char> padded_header(alignSize(sizeof(RawFrameFileHeader)), 0);
+    memcpy(padded_header.data(), &header, sizeof(header));
+    file.write(padded_header.data(), padded_header.size());
+    return static_cast<bool>(file);
+}
+
+bool RawFrameWriter::write(const cv::Mat &frame, double timestamp) {
+    if (!file.is_open() || frame.rows != header.height ||
+        frame.cols != header.width || frame.type() != header.type) {
+        return false;
+    }
+
+    cv::Mat continuous_frame = frame.isContinuous() ? frame : frame.clone();
+    file.write(reinterpret_cast<const char *>(continuous_frame.data), header.frame_size);
+
+    static const char padding[RAW_FRAME_FILE_ALIGNMENT] = {0};
+    file.write(padding, header.frame_stride - header.frame_size);
+
+    timestamps.push_back(timestamp);
+    ++header.n_frames;
+    return static_cast<bool>(file);
+}
+
+void RawFrameWriter::close() {
+    if (!file.is_open()) return;
+
+    file.write(reinterpret_cast<const char *>(timestamps.data()), timestamps.size() * sizeof(double));
+    file.seekp(0);
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.close();
+}
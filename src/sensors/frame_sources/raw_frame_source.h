@@ -0,0 +1,81 @@
+#ifndef RAW_FRAME_SOURCE_H
+#define RAW_FRAME_SOURCE_H
+
+#include <stdint.h>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+#include "utils/mapped_file.h"
+
+#define RAW_FRAME_FILE_EXTENSION ".frames"
+#define RAW_FRAME_FILE_MAGIC "OADSRAW"
+#define RAW_FRAME_FILE_VERSION 1
+#define RAW_FRAME_FILE_ALIGNMENT 4096
+
+// Raw frame file layout:
+//   - RawFrameFileHeader, padded to RAW_FRAME_FILE_ALIGNMENT
+//   - n_frames frames, each padded to RAW_FRAME_FILE_ALIGNMENT
+//   - n_frames timestamps (double, ms)
+// Frames are stored as continuous pixel rows (no decoding needed).
+struct RawFrameFileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    int32_t type;  // OpenCV type. Ex: CV_8UC3
+    uint64_t frame_size;
+    uint64_t frame_stride;
+    uint64_t n_frames;
+    double fps;
+};
+
+// Replay a raw frame file through a read-only memory mapping.
+// Frames point directly into the mapping (no decoding, no copy) and
+// keep the mapping alive while they are referenced.
+class RawFrameSource : public FrameSource {
+   private:
+    std::string file_path;
+    std::shared_ptr<MappedFile> mapped_file;
+    RawFrameFileHeader header;
+    const double *timestamps = nullptr;
+    size_t next_frame_id = 0;
+
+   public:
+    explicit RawFrameSource(const std::string &file_path);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() override;
+    bool read(cv::Mat &frame) override;
+    double getTimestamp() override;
+    double getFPS() override;
+    int getFrameCount() override;
+    bool seek(int frame_id) override;
+    std::string getName() override;
+};
+
+// Record frames into a raw frame file, for example to convert a
+// video into a file that can be replayed without decoding
+class RawFrameWriter {
+   private:
+    std::ofstream file;
+    RawFrameFileHeader header;
+    std::vector<double> timestamps;
+
+   public:
+    ~RawFrameWriter();
+
+    bool open(const std::string &file_path, int width, int height, int type, double fps);
+
+    // All frames must have the size and type given in open()
+    bool write(const cv::Mat &frame, double timestamp);
+
+    // Write timestamps and the final header
+    void close();
+};
+
+#endif
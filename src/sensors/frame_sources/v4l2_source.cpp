@@ -0,0 +1,268 @@
+#include "v4l2_source.h"
+
+#include <algorithm>
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+
+// ioctl() retried when interrupted by a signal
+int xioctl(int fd, unsigned long request, void *arg) {
+    int r;
+    do {
+        r = ioctl(fd, request, arg);
+    } while (r == -1 && errno == EINTR);
+    return r;
+}
+
+}  // namespace
+
+V4L2Source::V4L2Source(const std::string &device_path, int width, int height)
+    : device_path(device_path), width(width), height(height) {}
+
+V4L2Source::~V4L2Source() {
+    close();
+}
+
+bool V4L2Source::open() {
+    close();
+    if (openV4L2()) {
+        return true;
+    }
+    std::cerr << "Falling back to OpenCV capture for " << device_path << std::endl;
+    return openCapture();
+}
+
+bool V4L2Source::openV4L2() {
+    fd = ::open(device_path.c_str(), O_RDWR | O_NONBLOCK);
+    if (fd < 0) {
+        std::cerr << "Could not open camera " << device_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    if (!initDevice() || !initBuffers()) {
+        close();
+        return false;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_STREAMON, &type) < 0) {
+        std::cerr << "Could not start streaming from " << device_path << ": " << strerror(errno) << std::endl;
+        close();
+        return false;
+    }
+
+    first_timestamp = -1;
+    timestamp = 0;
+    return true;
+}
+
+bool V4L2Source::openCapture() {
+    // /dev/videoX by index, so that OpenCV picks its default backend
+    const std::string prefix = "/dev/video";
+    std::string index = device_path.substr(std::min(prefix.size(), device_path.size()));
+    bool is_index = device_path.rfind(prefix, 0) == 0 && !index.empty() &&
+        index.find_first_not_of("0123456789") == std::string::npos;
+    bool opened = is_index ? capture.open(std::stoi(index)) : capture.open(device_path);
+    if (!opened) {
+        std::cerr << "Could not open camera " << device_path << std::endl;
+        return false;
+    }
+    capture.set(cv::CAP_PROP_FRAME_WIDTH, width);
+    capture.set(cv::CAP_PROP_FRAME_HEIGHT, height);
+    capture_start_time = std::chrono::steady_clock::now();
+    timestamp = 0;
+    return true;
+}
+
+bool V4L2Source::readCapture(cv::Mat &frame) {
+    // A new Mat, as the previous frame may still be in use
+    frame = cv::Mat();
+    if (!capture.read(frame) || frame.empty()) {
+        return false;
+    }
+    timestamp = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - capture_start_time).count();
+    return true;
+}
+
+bool V4L2Source::initDevice() {
+    v4l2_capability cap;
+    memset(&cap, 0, sizeof(cap));
+    if (xioctl(fd, VIDIOC_QUERYCAP, &cap) < 0 ||
+        !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ||
+        !(cap.capabilities & V4L2_CAP_STREAMING)) {
+        std::cerr << device_path << " is not a streaming capture device" << std::endl;
+        return false;
+    }
+
+    // Prefer YUYV (cheap conversion), fall back to MJPEG
+    const uint32_t formats[] = {V4L2_PIX_FMT_YUYV, V4L2_PIX_FMT_MJPEG};
+    for (uint32_t format : formats) {
+        v4l2_format fmt;
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        fmt.fmt.pix.width = width;
+        fmt.fmt.pix.height = height;
+        fmt.fmt.pix.pixelformat = format;
+        fmt.fmt.pix.field = V4L2_FIELD_ANY;
+        if (xioctl(fd, VIDIOC_S_FMT, &fmt) == 0 && fmt.fmt.pix.pixelformat == format) {
+            pixel_format = format;
+            width = fmt.fmt.pix.width;
+            height = fmt.fmt.pix.height;
+            bytes_per_line = fmt.fmt.pix.bytesperline;
+            break;
+        }
+    }
+
+    if (pixel_format == 0) {
+        std::cerr << device_path << " supports neither YUYV nor MJPEG" << std::endl;
+        return false;
+    }
+
+    v4l2_streamparm parm;
+    memset(&parm, 0, sizeof(parm));
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(fd, VIDIOC_G_PARM, &parm) == 0 &&
+        parm.parm.capture.timeperframe.numerator > 0) {
+        fps = static_cast<double>(parm.parm.capture.timeperframe.denominator)
+            / parm.parm.capture.timeperframe.numerator;
+    }
+
+    return true;
+}
+
+bool V4L2Source::initBuffers() {
+    v4l2_requestbuffers req;
+    memset(&req, 0, sizeof(req));
+    req.count = V4L2_SOURCE_N_BUFFERS;
+    req.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    req.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_REQBUFS, &req) < 0 || req.count < 2) {
+        std::cerr << "Could not allocate capture buffers on " << device_path << std::endl;
+        return false;
+    }
+
+    buffers.resize(req.count);
+    for (uint32_t i = 0; i < req.count; ++i) {
+        v4l2_buffer buf;
+        memset(&buf, 0, sizeof(buf));
+        buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.index = i;
+        if (xioctl(fd, VIDIOC_QUERYBUF, &buf) < 0) {
+            std::cerr << "Could not query capture buffer on " << device_path << std::endl;
+            return false;
+        }
+
+        void *data = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, buf.m.offset);
+        if (data == MAP_FAILED) {
+            std::cerr << "Could not map capture buffer on " << device_path << std::endl;
+            return false;
+        }
+        buffers[i].data = data;
+        buffers[i].length = buf.length;
+
+        if (xioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+            std::cerr << "Could not queue capture buffer on " << device_path << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void V4L2Source::releaseBuffers() {
+    for (MappedBuffer &buffer : buffers) {
+        if (buffer.data != nullptr) {
+            munmap(buffer.data, buffer.length);
+        }
+    }
+    buffers.clear();
+}
+
+void V4L2Source::close() {
+    capture.release();
+    if (fd < 0) return;
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    xioctl(fd, VIDIOC_STREAMOFF, &type);
+    releaseBuffers();
+    ::close(fd);
+    fd = -1;
+    pixel_format = 0;
+}
+
+bool V4L2Source::isOpened() {
+    return fd >= 0 || capture.isOpened();
+}
+
+bool V4L2Source::read(cv::Mat &frame) {
+    if (capture.isOpened()) return readCapture(frame);
+    if (fd < 0) return false;
+
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    int r;
+    do {
+        r = poll(&pfd, 1, V4L2_SOURCE_READ_TIMEOUT);
+    } while (r == -1 && errno == EINTR);
+    if (r <= 0) {
+        std::cerr << "Timeout when reading from " << device_path << std::endl;
+        return false;
+    }
+
+    v4l2_buffer buf;
+    memset(&buf, 0, sizeof(buf));
+    buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    buf.memory = V4L2_MEMORY_MMAP;
+    if (xioctl(fd, VIDIOC_DQBUF, &buf) < 0) {
+        std::cerr << "Could not read from " << device_path << ": " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    // Convert straight from the driver buffer into a new image.
+    // A new Mat is allocated because the previous frame may still be in use
+    const MappedBuffer &buffer = buffers[buf.index];
+    if (pixel_format == V4L2_PIX_FMT_YUYV) {
+        // Rows may be padded by the driver
+        size_t step = bytes_per_line > 0 ? bytes_per_line : cv::Mat::AUTO_STEP;
+        cv::Mat yuyv(height, width, CV_8UC2, buffer.data, step);
+        frame = cv::Mat();
+        cv::cvtColor(yuyv, frame, cv::COLOR_YUV2BGR_YUYV);
+    } else {
+        cv::Mat jpeg(1, buf.bytesused, CV_8UC1, buffer.data);
+        frame = cv::imdecode(jpeg, cv::IMREAD_COLOR);
+    }
+
+    double buffer_timestamp = buf.timestamp.tv_sec * 1000.0 + buf.timestamp.tv_usec / 1000.0;
+    if (first_timestamp < 0) first_timestamp = buffer_timestamp;
+    timestamp = buffer_timestamp - first_timestamp;
+
+    if (xioctl(fd, VIDIOC_QBUF, &buf) < 0) {
+        std::cerr << "Could not queue capture buffer on " << device_path << std::endl;
+        return false;
+    }
+
+    return !frame.empty();
+}
+
+double V4L2Source::getTimestamp() {
+    return timestamp;
+}
+
+double V4L2Source::getFPS() {
+    if (capture.isOpened()) return capture.get(cv::CAP_PROP_FPS);
+    return fps;
+}
+
+std::string V4L2Source::getName() {
+    return device_path;
+}
@@ -0,0 +1,66 @@
+#ifndef V4L2_SOURCE_H
+#define V4L2_SOURCE_H
+
+#include <stdint.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+#define V4L2_SOURCE_N_BUFFERS 4
+#define V4L2_SOURCE_READ_TIMEOUT 1000  // ms
+
+// Capture frames from a V4L2 camera using memory-mapped driver buffers.
+// Each frame is converted directly from the driver buffer into a new
+// BGR image (YUYV or MJPEG), then the buffer is given back to the driver.
+// Cameras that can't be used this way (other pixel formats such as NV12
+// or Bayer, devices without streaming I/O, Jetson CSI cameras...) are
+// opened with cv::VideoCapture instead, as before V4L2 capture was added.
+class V4L2Source : public FrameSource {
+   private:
+    struct MappedBuffer {
+        void *data = nullptr;
+        size_t length = 0;
+    };
+
+    std::string device_path;
+    int width;
+    int height;
+    int fd = -1;
+    uint32_t pixel_format = 0;
+    uint32_t bytes_per_line = 0;
+    std::vector<MappedBuffer> buffers;
+    double fps = -1;
+    double timestamp = 0;
+    double first_timestamp = -1;
+
+    // Fallback when V4L2 capture can't be set up
+    cv::VideoCapture capture;
+    std::chrono::steady_clock::time_point capture_start_time;
+
+    bool initDevice();
+    bool initBuffers();
+    void releaseBuffers();
+    bool openV4L2();
+    bool openCapture();
+    bool readCapture(cv::Mat &frame);
+
+   public:
+    // device: /dev/videoX. Width and height are requested from the driver,
+    // which may choose the nearest supported size
+    explicit V4L2Source(const std::string &device_path, int width = 1280, int height = 720);
+    ~V4L2Source();
+
+    bool open() override;
+    void close() override;
+    bool isOpened() override;
+    bool read(cv::Mat &frame) override;
+    double getTimestamp() override;
+    bool isLive() override { return true; }
+    double getFPS() override;
+    std::string getName() override;
+};
+
+#endif
@@ -0,0 +1,45 @@
+#include "video_file_source.h"
+
+VideoFileSource::VideoFileSource(const std::string &video_path)
+    : video_path(video_path) {}
+
+bool VideoFileSource::open() {
+    timestamp = 0;
+    return capture.open(video_path);
+}
+
+void VideoFileSource::close() {
+    capture.release();
+}
+
+bool VideoFileSource::isOpened() {
+    return capture.isOpened();
+}
+
+bool VideoFileSource::read(cv::Mat &frame) {
+    if (!capture.read(frame) || frame.empty()) {
+        return false;
+    }
+    timestamp = capture.get(cv::CAP_PROP_POS_MSEC);
+    return true;
+}
+
+double VideoFileSource::getTimestamp() {
+    return timestamp;
+}
+
+double VideoFileSource::getFPS() {
+    return capture.get(cv::CAP_PROP_FPS);
+}
+
+int VideoFileSource::getFrameCount() {
+    return static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT));
+}
+
+bool VideoFileSource::seek(int frame_id) {
+    return capture.set(cv::CAP_PROP_POS_FRAMES, frame_id);
+}
+
+std::string VideoFileSource::getName() {
+    return video_path;
+}
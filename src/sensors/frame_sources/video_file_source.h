@@ -0,0 +1,30 @@
+#ifndef VIDEO_FILE_SOURCE_H
+#define VIDEO_FILE_SOURCE_H
+
+#include <string>
+#include <opencv2/opencv.hpp>
+
+#include "frame_source.h"
+
+// Read frames from a video file using OpenCV
+class VideoFileSource : public FrameSource {
+   private:
+    std::string video_path;
+    cv::VideoCapture capture;
+    double timestamp = 0;
+
+   public:
+    explicit VideoFileSource(const std::string &video_path);
+
+    bool open() override;
+    void close() override;
+    bool isOpened() override;
+    bool read(cv::Mat &frame) override;
+    double getTimestamp() override;
+    double getFPS() override;
+    int getFrameCount() override;
+    bool seek(int frame_id) override;
+    std::string getName() override;
+};
+
+#endif
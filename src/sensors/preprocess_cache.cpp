@@ -0,0 +1,126 @@
+#include "preprocess_cache.h"
+
+PreprocessCache::PreprocessCache(size_t max_frames) :
+    max_frames(max_frames), tensor_pool(std::make_shared<TensorPool>()) {
+    // Tensors of cached frames, plus the ones still used by models
+    tensor_pool->max_buffers = 2 * max_frames;
+}
+
+PreprocessCache::TensorPool::~TensorPool() {
+    for (std::vector<float> *buffer : buffers) {
+        delete buffer;
+    }
+}
+
+template <typename T>
+T PreprocessCache::getOrCompute(uint64_t frame_id,
+    std::map<std::string, std::shared_future<T>> Entry::*results,
+    const std::string &key, const std::function<T()> &compute) {
+
+    std::promise<T> promise;
+    std::shared_future<T> result;
+    bool is_owner = false;
+    {
+        std::lock_guard<std::mutex> guard(entries_mutex);
+        std::map<std::string, std::shared_future<T>> &frame_results = entries[frame_id].*results;
+        auto it = frame_results.find(key);
+        if (it != frame_results.end()) {
+            // Already computed or being computed by another thread
+            result = it->second;
+        } else {
+            result = promise.get_future().share();
+            frame_results[key] = result;
+            is_owner = true;
+        }
+
+        // Drop the oldest frames. Threads waiting on a dropped result
+        // still hold its shared state
+        while (entries.size() > max_frames) {
+            entries.erase(entries.begin());
+        }
+    }
+
+    // Compute outside of the lock, so that other frames and other
+    // results are not blocked
+    if (is_owner) {
+        try {
+            promise.set_value(compute());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    return result.get();
+}
+
+cv::Mat PreprocessCache::getResized(const FramePtr &frame, cv::Size size, ResizeMode mode) {
+    if (mode == kResizeKeepAspectRatio) {
+        size = getFittedSize(frame->image.size(), size);
+    }
+    if (frame->image.size() == size) {
+        return frame->image;
+    }
+
+    std::string key = (mode == kResizeStretch ? "stretch_" : "fit_")
+        + std::to_string(size.width) + "x" + std::to_string(size.height);
+    std::function<cv::Mat()> resize = [&frame, size]() {
+        cv::Mat resized;
+        cv::resize(frame->image, resized, size);
+        return resized;
+    };
+    return getOrCompute(frame->frame_id, &Entry::images, key, resize);
+}
+
+TensorPtr PreprocessCache::getTensor(const FramePtr &frame, const std::string &name,
+    size_t size, const std::function<void(float *)> &fill) {
+    std::function<TensorPtr()> make_tensor = [this, size, &fill]() {
+        return makePooledTensor(size, fill);
+    };
+    return getOrCompute(frame->frame_id, &Entry::tensors, name, make_tensor);
+}
+
+TensorPtr PreprocessCache::makePooledTensor(size_t size, const std::function<void(float *)> &fill) {
+    std::vector<float> *buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> guard(tensor_pool->mutex);
+        for (size_t i = 0; i < tensor_pool->buffers.size(); ++i) {
+            if (tensor_pool->buffers[i]->size() == size) {
+                buffer = tensor_pool->buffers[i];
+                tensor_pool->buffers.erase(tensor_pool->buffers.begin() + i);
+                break;
+            }
+        }
+    }
+    if (!buffer) {
+        buffer = new std::vector<float>(size);
+    }
+
+    // Return the buffer to the pool when the last user releases the tensor
+    std::weak_ptr<TensorPool> weak_pool = tensor_pool;
+    TensorPtr tensor(buffer, [weak_pool](const std::vector<float> *released) {
+        std::vector<float> *buffer = const_cast<std::vector<float> *>(released);
+        std::shared_ptr<TensorPool> pool = weak_pool.lock();
+        if (pool) {
+            std::lock_guard<std::mutex> guard(pool->mutex);
+            if (pool->buffers.size() < pool->max_buffers) {
+                pool->buffers.push_back(buffer);
+                return;
+            }
+        }
+        delete buffer;
+    });
+
+    fill(buffer->data());
+    return tensor;
+}
+
+void PreprocessCache::clear() {
+    std::lock_guard<std::mutex> guard(entries_mutex);
+    entries.clear();
+}
+
+cv::Size PreprocessCache::getFittedSize(cv::Size image_size, cv::Size size) {
+    // Same rounding as the letterbox of object detection (prepareImage())
+    float scale = cv::min(float(size.width) / image_size.width, float(size.height) / image_size.height);
+    return cv::Size(image_size.width * scale, image_size.height * scale);
+}
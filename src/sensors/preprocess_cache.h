@@ -0,0 +1,80 @@
+#ifndef PREPROCESS_CACHE_H
+#define PREPROCESS_CACHE_H
+
+#include <stdint.h>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "sensors/frame.h"
+
+enum ResizeMode {
+    kResizeStretch,          // Resize to the exact target size
+    kResizeKeepAspectRatio,  // Fit into the target size (no padding)
+};
+
+// Network input tensor shared between threads. Never modified after creation
+typedef std::shared_ptr<const std::vector<float>> TensorPtr;
+
+// Preprocessing results of the latest frames, keyed by frame id.
+// Each resized image and each model input tensor is computed once per frame,
+// by the first thread asking for it. Other threads asking for the same
+// result wait for it instead of computing it again.
+// Resized images are made from Frame::image, which is the intermediate
+// shared by all models (the camera image is only resized once, by CarStatus).
+// Results are immutable: never write into a returned image or tensor.
+class PreprocessCache {
+   private:
+    struct Entry {
+        std::map<std::string, std::shared_future<cv::Mat>> images;
+        std::map<std::string, std::shared_future<TensorPtr>> tensors;
+    };
+
+    // Frame id -> entry. Only the newest max_frames entries are kept
+    std::map<uint64_t, Entry> entries;
+    std::mutex entries_mutex;
+    size_t max_frames;
+
+    // Buffers of released tensors, reused for the next frames so that
+    // no tensor is allocated per frame once the pipeline is running.
+    // Shared with the deleters of tensors, which may outlive the cache
+    struct TensorPool {
+        std::vector<std::vector<float> *> buffers;
+        std::mutex mutex;
+        size_t max_buffers;
+        ~TensorPool();
+    };
+    std::shared_ptr<TensorPool> tensor_pool;
+
+    TensorPtr makePooledTensor(size_t size, const std::function<void(float *)> &fill);
+
+    template <typename T>
+    T getOrCompute(uint64_t frame_id,
+        std::map<std::string, std::shared_future<T>> Entry::*results,
+        const std::string &key, const std::function<T()> &compute);
+
+   public:
+    explicit PreprocessCache(size_t max_frames);
+
+    // Get the image of a frame resized to size.
+    // Return frame->image itself if it already has the requested size
+    cv::Mat getResized(const FramePtr &frame, cv::Size size, ResizeMode mode);
+
+    // Get a model input tensor of a frame. fill is only called if the
+    // tensor named name has not been made for this frame yet.
+    // It writes size floats into a buffer reused from released tensors
+    TensorPtr getTensor(const FramePtr &frame, const std::string &name,
+        size_t size, const std::function<void(float *)> &fill);
+
+    void clear();
+
+    // Size of an image fitted into size by kResizeKeepAspectRatio
+    static cv::Size getFittedSize(cv::Size image_size, cv::Size size);
+};
+
+#endif
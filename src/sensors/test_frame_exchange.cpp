@@ -0,0 +1,200 @@
+// Benchmark for exchanging camera frames between the capture thread and
+// the processing threads.
+// Compare the old exchange (one mutex, deep copies on write and on every read)
+// with CarStatus frames (immutable frames shared by reference, through a
+// lock-free FrameExchange). Readers of CarStatus frames must also see
+// frame ids in increasing order.
+
+#include <iostream>
+#include <iomanip>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <functional>
+#include <opencv2/opencv.hpp>
+
+#include "car_status.h"
+
+using namespace std;
+using namespace std::chrono;
+
+struct ExchangeStats {
+    std::atomic<long long> n_copied_bytes = {0};
+    std::atomic<long long> n_lock_acquisitions = {0};
+    std::atomic<long long> lock_wait_ns = {0};
+    std::atomic<long long> max_lock_wait_ns = {0};
+
+    void addLockWait(steady_clock::time_point begin) {
+        long long wait_ns = duration_cast<nanoseconds>(steady_clock::now() - begin).count();
+        lock_wait_ns += wait_ns;
+        ++n_lock_acquisitions;
+        long long max_wait = max_lock_wait_ns;
+        while (wait_ns > max_wait && !max_lock_wait_ns.compare_exchange_weak(max_wait, wait_ns));
+    }
+
+    void addCopy(const cv::Mat &img) {
+        n_copied_bytes += img.total() * img.elemSize();
+    }
+};
+
+// Frame exchange used before CarStatus published immutable frames
+class LegacyFrameExchange {
+    cv::Mat current_img;
+    cv::Mat current_img_origin_size;
+    std::mutex current_img_mutex;
+
+   public:
+    void setCurrentImage(const cv::Mat &img, CarStatus &car_status, ExchangeStats &stats) {
+        steady_clock::time_point begin = steady_clock::now();
+        std::lock_guard<std::mutex> guard(current_img_mutex);
+        stats.addLockWait(begin);
+        current_img = car_status.resizeByMaxSize(img, IMG_MAX_SIZE);
+        img.copyTo(current_img_origin_size);
+        stats.addCopy(img);
+    }
+
+    void getCurrentImage(cv::Mat &image, ExchangeStats &stats) {
+        steady_clock::time_point begin = steady_clock::now();
+        std::lock_guard<std::mutex> guard(current_img_mutex);
+        stats.addLockWait(begin);
+        current_img.copyTo(image);
+        stats.addCopy(current_img);
+    }
+
+    void getCurrentImage(cv::Mat &image, cv::Mat &original_image, ExchangeStats &stats) {
+        steady_clock::time_point begin = steady_clock::now();
+        std::lock_guard<std::mutex> guard(current_img_mutex);
+        stats.addLockWait(begin);
+        current_img.copyTo(image);
+        current_img_origin_size.copyTo(original_image);
+        stats.addCopy(current_img);
+        stats.addCopy(current_img_origin_size);
+    }
+};
+
+// Run a producer at a fixed frame rate and the 3 consumers of the main window:
+// object detection (image + original image), lane detection (image)
+// and video grabber (image, then draw on it)
+void runBenchmark(const std::string &name, int width, int height, int fps, int duration_ms,
+    std::function<void(const cv::Mat&)> produce,
+    std::function<void()> read_both,
+    std::function<void()> read_image,
+    std::function<void()> read_for_display,
+    ExchangeStats &stats) {
+
+    std::atomic<bool> running = {true};
+    std::atomic<long long> n_frames = {0};
+
+    cv::Mat source(height, width, CV_8UC3);
+    cv::randu(source, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    std::thread producer([&]() {
+        steady_clock::time_point next_frame_time = steady_clock::now();
+        while (running) {
+            // Stand-in for the camera: each frame is read into a new buffer
+            cv::Mat frame = source.clone();
+            produce(frame);
+            ++n_frames;
+            next_frame_time += microseconds(1000000 / fps);
+            std::this_thread::sleep_until(next_frame_time);
+        }
+    });
+
+    std::vector<std::thread> consumers;
+    consumers.emplace_back([&]() { while (running) read_both(); });
+    consumers.emplace_back([&]() { while (running) read_image(); });
+    consumers.emplace_back([&]() { while (running) read_for_display(); });
+
+    std::this_thread::sleep_for(milliseconds(duration_ms));
+    running = false;
+    producer.join();
+    for (auto &consumer : consumers) consumer.join();
+
+    double frame_bytes = static_cast<double>(width) * height * 3;
+    double n = std::max(1LL, n_frames.load());
+    cout << "=== " << name << " ===" << endl;
+    cout << "Frames: " << n_frames << endl;
+    cout << "Copies per frame (full frame equivalents): " << std::fixed << std::setprecision(2)
+         << stats.n_copied_bytes / frame_bytes / n << endl;
+    cout << "Lock acquisitions per frame: " << stats.n_lock_acquisitions / n << endl;
+    cout << "Lock wait per frame: " << stats.lock_wait_ns / n / 1000.0 << " us" << endl;
+    cout << "Max lock wait: " << stats.max_lock_wait_ns / 1000.0 << " us" << endl;
+}
+
+int main(int argc, char** argv) {
+
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{width          |1280  | frame width }"
+        "{height         |720   | frame height }"
+        "{fps            |30    | frame rate of the producer }"
+        "{duration       |5000  | duration of each benchmark (ms) }"
+        ;
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Frame exchange benchmark");
+    if (parser.has("help")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    int width = parser.get<int>("width");
+    int height = parser.get<int>("height");
+    int fps = parser.get<int>("fps");
+    int duration = parser.get<int>("duration");
+
+    // Old exchange: every reader copies, readers spin on the same mutex
+    {
+        CarStatus car_status;
+        LegacyFrameExchange exchange;
+        ExchangeStats stats;
+        runBenchmark("Mutex + deep copies", width, height, fps, duration,
+            [&](const cv::Mat &frame) { exchange.setCurrentImage(frame, car_status, stats); },
+            [&]() { cv::Mat image, original_image; exchange.getCurrentImage(image, original_image, stats); },
+            [&]() { cv::Mat image; exchange.getCurrentImage(image, stats); },
+            [&]() { cv::Mat image; exchange.getCurrentImage(image, stats); },
+            stats);
+    }
+
+    // CarStatus frames: readers take a reference to an immutable frame.
+    // Only the video grabber copies, because it draws on the image
+    std::atomic<long long> n_out_of_order = {0};
+    {
+        CarStatus car_status;
+        ExchangeStats stats;
+        auto read_frame = [&]() {
+            steady_clock::time_point begin = steady_clock::now();
+            FramePtr frame = car_status.getCurrentFrame();
+            stats.addLockWait(begin);
+            // Each consumer runs in its own thread
+            thread_local uint64_t last_frame_id = 0;
+            if (frame) {
+                if (frame->frame_id < last_frame_id) {
+                    ++n_out_of_order;
+                }
+                last_frame_id = frame->frame_id;
+            }
+            return frame;
+        };
+        runBenchmark("Shared immutable frames", width, height, fps, duration,
+            [&](const cv::Mat &frame) { car_status.setCurrentImage(frame); },
+            [&]() { read_frame(); },
+            [&]() { read_frame(); },
+            [&]() {
+                FramePtr frame = read_frame();
+                if (frame) {
+                    cv::Mat draw_frame = frame->image.clone();
+                    stats.addCopy(draw_frame);
+                }
+            },
+            stats);
+    }
+
+    if (n_out_of_order > 0) {
+        cerr << "FAILED: " << n_out_of_order << " frames read out of order" << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,83 @@
+// Read all frames of a frame source and print the read throughput.
+// Optionally convert the source into a raw frame file, which can be
+// replayed without decoding:
+//   ./test_frame_source --source=drive.mp4 --output=drive.frames
+//   ./test_frame_source --source=drive.frames
+
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+
+#include "frame_sources/frame_source.h"
+#include "frame_sources/raw_frame_source.h"
+
+using namespace std;
+using namespace std::chrono;
+
+int main(int argc, char** argv) {
+
+    const std::string keys =
+        "{help h usage ? |      | print this message   }"
+        "{source         |      | camera id, /dev/videoX, video file, image folder or .frames file }"
+        "{output         |      | write frames into a raw frame file (" RAW_FRAME_FILE_EXTENSION ") }"
+        "{max_frames     |-1    | stop after this number of frames }"
+        ;
+
+    cv::CommandLineParser parser(argc, argv, keys);
+    parser.about("Frame source benchmark");
+    if (parser.has("help") || !parser.has("source")) {
+        parser.printMessage();
+        return 0;
+    }
+
+    std::string output = parser.get<std::string>("output");
+    int max_frames = parser.get<int>("max_frames");
+
+    std::shared_ptr<FrameSource> source = createFrameSource(parser.get<std::string>("source"));
+    if (!source->open()) {
+        cerr << "Could not open " << source->getName() << endl;
+        return 1;
+    }
+
+    RawFrameWriter writer;
+    bool writer_opened = false;
+
+    long long n_frames = 0;
+    double n_bytes = 0;
+    steady_clock::time_point begin = steady_clock::now();
+
+    cv::Mat frame;
+    while (max_frames < 0 || n_frames < max_frames) {
+        frame = cv::Mat();
+        if (!source->read(frame)) break;
+
+        if (!output.empty()) {
+            if (!writer_opened) {
+                double fps = source->getFPS() > 0 ? source->getFPS() : 30;
+                if (!writer.open(output, frame.cols, frame.rows, frame.type(), fps)) {
+                    return 1;
+                }
+                writer_opened = true;
+            }
+            writer.write(frame, source->getTimestamp());
+        }
+
+        ++n_frames;
+        n_bytes += frame.total() * frame.elemSize();
+    }
+
+    double elapsed = duration_cast<microseconds>(steady_clock::now() - begin).count() / 1e6;
+    writer.close();
+    source->close();
+
+    cout << "Source: " << source->getName() << endl;
+    cout << "Frames: " << n_frames << endl;
+    cout << "Time: " << std::fixed << std::setprecision(3) << elapsed << " s" << endl;
+    if (elapsed > 0) {
+        cout << "FPS: " << n_frames / elapsed << endl;
+        cout << "Throughput: " << n_bytes / elapsed / (1 << 20) << " MB/s" << endl;
+    }
+
+    return 0;
+}
@@ -4,7 +4,7 @@
 
 using namespace cv;
 
-MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode)
+MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode, std::string camera_source)
     : QMainWindow(parent), ui(new Ui::MainWindow), is_simulation_mode(is_simulation_mode) {
     ui->setupUi(this);
 
@@ -25,7 +25,9 @@ MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode)
 
     car_status = std::make_shared<CarStatus>();
     camera_model = std::make_shared<CameraModel>();
-    object_detector = std::make_shared<ObjectDetector>();
+
+    // Models load in the background while the UI and the capture start
+    model_loader = std::make_shared<ModelLoader>();
 
     // Camera calibration wizard
     this->camera_wizard = std::make_shared<CameraWizard>(this->car_status);
@@ -37,10 +39,6 @@ MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode)
     connect(this->camera_wizard.get(), SIGNAL(updateCameraModel(float, float, float, float, float, float, float, float, float, float, float, float)), this, SLOT(updateCameraModel(float, float, float, float, float, float, float, float, float, float, float, float)));
 
 
-    #ifndef DISABLE_LANE_DETECTOR
-    lane_detector = std::make_shared<LaneDetector>();
-    #endif
-
     #ifndef DISABLE_GPS_READER
     car_gps_reader = std::make_shared<CarGPSReader>();
     #endif
@@ -53,21 +51,19 @@ MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode)
 
     // Start image capturing thread
     if (!is_simulation_mode) {
-        std::thread camera_thread(&MainWindow::cameraCaptureThread, car_status);
+        std::thread camera_thread(&MainWindow::cameraCaptureThread,
+            createFrameSource(camera_source), car_status);
         camera_thread.detach();
     }
 
-    // Start processing threads
-    std::thread od_thread(&MainWindow::objectDetectionThread, 
-        object_detector,
-        car_status,
-        collision_warning.get()
-        );
-    od_thread.detach();
+    // Start processing threads. They wait for their model
+    object_detection_pipeline = std::make_shared<ObjectDetectionPipeline>(
+        model_loader, car_status, collision_warning.get());
+    object_detection_pipeline->start();
 
 #ifndef DISABLE_LANE_DETECTOR
     std::thread ld_thread(&MainWindow::laneDetectionThread, 
-        lane_detector,
+        model_loader,
         car_status,
         this);
     ld_thread.detach();
@@ -87,23 +83,38 @@ MainWindow::MainWindow(QWidget *parent, bool is_simulation_mode)
 }
 
 
-void MainWindow::cameraCaptureThread(std::shared_ptr<CarStatus> car_status) {
-    cv::VideoCapture video;
-    if (!video.open(0)) {
+void MainWindow::cameraCaptureThread(std::shared_ptr<FrameSource> frame_source, std::shared_ptr<CarStatus> car_status) {
+    if (!frame_source->open()) {
         QMessageBox::critical(
             nullptr, "Camera Error",
             "Could not read from camera");
         return;
     }
+
+    // Sources other than cameras are played at their own frame rate
+    double fps = frame_source->getFPS();
+    bool need_pacing = !frame_source->isLive() && fps > 0;
+    Timer::time_point_t next_frame_time = Timer::getWallTime();
     
     while (true) {
+        // Read into a new buffer each time, as the published frame
+        // keeps referencing this one
         Mat frame;
-        video >> frame;
-        if (frame.empty()) {
+        if (!frame_source->read(frame)) {
+            if (!frame_source->isLive()) {
+                break;
+            }
             continue;
         }
         car_status->setCurrentImage(frame);
+
+        if (need_pacing) {
+            next_frame_time += std::chrono::microseconds(static_cast<long long>(1e6 / fps));
+            std::this_thread::sleep_until(next_frame_time);
+        }
     }
+
+    frame_source->close();
 }
 
 
@@ -129,8 +140,16 @@ void MainWindow::updateCameraModel(
 
 void MainWindow::warningMonitorThread(std::shared_ptr<CarStatus> car_status, MainWindow *main_window) {
 
+    uint64_t processed_frame_id = 0;
     while (true) {
 
+        // Warnings only change when new results arrive, which happens
+        // at most once per frame. Wake up periodically to repeat alerts
+        FramePtr frame = car_status->waitForFrame(processed_frame_id, WARNING_MONITOR_MAX_INTERVAL);
+        if (frame) {
+            processed_frame_id = frame->frame_id;
+        }
+
         // Calibration warning
         if (!main_window->camera_model->isCalibrated()) {
             main_window->ui->warningText->setText(QString("Warning: Camera hasn't been calibrated yet. Please calibrate your camera to enable safety features."));
@@ -179,87 +198,53 @@ void MainWindow::warningMonitorThread(std::shared_ptr<CarStatus> car_status, Mai
             main_window->setLastLaneDepartureWarningTime(Timer::getCurrentTime());
         }
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
     }
     
 }
 
-void MainWindow::objectDetectionThread(
-    std::shared_ptr<ObjectDetector> object_detector,
-    std::shared_ptr<CarStatus> car_status,
-    CollisionWarningController *collision_warning) {
-        
-    cv::Mat image;
-    cv::Mat original_image;
-
-    Timer::time_point_t car_status_start_time = car_status->getStartTime();
-    TrafficSignMonitor traffic_sign_monitor(car_status);
-
-    while (true) {
-
-        // Reset traffic sign monitor if car status has changed
-        // (In case of changing simulation)
-        if (car_status_start_time != car_status->getStartTime()) {
-            cout << "CarStatus has been reset!" << endl;
-            car_status_start_time = car_status->getStartTime();
-            traffic_sign_monitor = TrafficSignMonitor(car_status);
-        }
-
-        car_status->getCurrentImage(image, original_image);
-
-        if (image.empty()) {
-            continue;
-        }
-
-        Timer::time_point_t begin_time = Timer::getCurrentTime();
-        std::vector<TrafficObject> objects = object_detector->detect(image, original_image);
-        car_status->setObjectDetectionTime(Timer::calcTimePassed(begin_time));
-        traffic_sign_monitor.updateTrafficSign(objects);
-
-        if (SHOW_DISTANCES) {
-            collision_warning->calculateDistance(image, objects);
-        }
-
-        car_status->setDetectedObjects(objects);
-
-        // Collision warning
-        car_status->setCollisionWarning(collision_warning->isInDangerSituation(image.size(), objects));
-        
-    }
-}
-
 void MainWindow::laneDetectionThread(
-    std::shared_ptr<LaneDetector> lane_detector, std::shared_ptr<CarStatus> car_status, MainWindow *main_window) {
-    cv::Mat clone_img;
+    std::shared_ptr<ModelLoader> model_loader, std::shared_ptr<CarStatus> car_status, MainWindow *main_window) {
+    FramePtr frame;
+    uint64_t processed_frame_id = 0;
     bool lane_departure;
+    std::vector<LaneLine> detected_lines;
+
+    // Warming up
+    std::shared_ptr<LaneDetector> lane_detector = model_loader->waitLaneDetector();
+    int consumer_id = car_status->registerFrameConsumer();
     while (true) {
 
-        car_status->getCurrentImage(clone_img);
-        if (clone_img.empty()) {
-            continue;
-        }
+        // Block until a frame we haven't processed is available
+        frame = car_status->waitForFrame(processed_frame_id);
+        processed_frame_id = frame->frame_id;
+        const cv::Mat &img = frame->image;
 
         // Don't analyze lane when turning signal is activated
-        if (Timer::calcTimePassed(car_status->getLastActivatedTurningSignalTime()) <= 5000) {
+        if (Timer::calcDiff(car_status->getLastActivatedTurningSignalTime(), frame->capture_time) <= 5000) {
             main_window->is_lane_departure_warning = false;
+            lane_detector->resetTracking();
             car_status->setDetectedLaneLines(std::vector<LaneLine>(), cv::Mat(), cv::Mat(), cv::Mat());
+            car_status->setFrameProcessed(consumer_id, processed_frame_id);
             continue;
         }
 
+        Timer::time_point_t begin_time = Timer::getWallTime();
+
+        // Network input shared with other models through the preprocessing cache
+        cv::Mat model_input = car_status->getPreprocessCache()->getResized(
+            frame, lane_detector->getInputSize(), kResizeStretch);
+
         #if defined (DEBUG_LANE_DETECTOR_SHOW_LINES)  || defined (DEBUG_LANE_DETECTOR_SHOW_LINE_MASK)
         cv::Mat lane_line_mask;
         cv::Mat detected_line_img;
         cv::Mat reduced_line_img;
 
-        Timer::time_point_t begin_time = Timer::getCurrentTime();
-        std::vector<LaneLine> detected_lines = lane_detector->detectLaneLines(clone_img, lane_line_mask, detected_line_img, reduced_line_img, lane_departure);
-        car_status->setLaneDetectionTime(Timer::calcTimePassed(begin_time));
+        detected_lines = lane_detector->detectLaneLines(img, lane_line_mask, detected_line_img, reduced_line_img, lane_departure, model_input, frame->capture_time);
+        car_status->setLaneDetectionTime(Timer::calcWallTimePassed(begin_time));
         car_status->setDetectedLaneLines(detected_lines, lane_line_mask, detected_line_img, reduced_line_img);
         #else
-        Timer::time_point_t begin_time = Timer::getCurrentTime();
-        std::vector<LaneLine> detected_lines = lane_detector->detectLaneLines(clone_img, lane_departure);
-        car_status->setLaneDetectionTime(Timer::calcTimePassed(begin_time));
+        lane_detector->detectLaneLines(img, detected_lines, lane_departure, model_input, frame->capture_time);
+        car_status->setLaneDetectionTime(Timer::calcWallTimePassed(begin_time));
         car_status->setDetectedLaneLines(detected_lines);
         #endif 
 
@@ -269,8 +254,7 @@ void MainWindow::laneDetectionThread(
             main_window->is_lane_departure_warning = false;
         }
 
-        this_thread::sleep_for(chrono::milliseconds(80));
-
+        car_status->setFrameProcessed(consumer_id, processed_frame_id);
     }
 }
 
@@ -301,13 +285,13 @@ void MainWindow::carPropReaderThread(
 MainWindow::~MainWindow() { delete ui; }
 
 void MainWindow::playAudio(std::string audio_file) {
-    if (!is_mute && (Timer::calcTimePassed(last_audio_time) > 2000
+    if (!is_mute && (Timer::calcWallTimePassed(last_audio_time) > 2000
         || last_audio_file != audio_file)
     ) {
         // Play a silent sound first to give HDMI enough time to 
         // start audio service
         system(("canberra-gtk-play -f sounds/silent.wav;canberra-gtk-play -f sounds/" + audio_file + " &").c_str());
-        last_audio_time = Timer::getCurrentTime();
+        last_audio_time = Timer::getWallTime();
         last_audio_file = audio_file;
     }
 }
@@ -325,7 +309,7 @@ void MainWindow::closeEvent(QCloseEvent *event) {
 void MainWindow::startVideoGrabber() {
 
     Mat draw_frame;
-    Timer::time_point_t last_fps_show = Timer::getCurrentTime();
+    Timer::time_point_t last_fps_show = Timer::getWallTime();
     Timer::time_duration_t object_detection_time =
          car_status->getObjectDetectionTime();
     Timer::time_duration_t lane_detection_time =
@@ -333,12 +317,18 @@ void MainWindow::startVideoGrabber() {
 
 
     int frame_ids = 0;
+    uint64_t shown_frame_id = 0;
     while (true) {
 
-        // Processing
-        car_status->getCurrentImage(draw_frame);
+        // Only redraw when a new frame arrives. Wait for a short time
+        // so that UI events are still processed regularly
+        FramePtr frame = car_status->waitForFrame(shown_frame_id, VIDEO_GRABBER_MAX_FRAME_WAIT);
+
+        if (frame) {
+            shown_frame_id = frame->frame_id;
 
-        if (!draw_frame.empty()) {
+            // Copy because we draw on this image
+            frame->image.copyTo(draw_frame);
 
             #ifndef DISABLE_LANE_DETECTOR
             std::vector<LaneLine> detected_lane_lines = car_status->getDetectedLaneLines();
@@ -364,8 +354,8 @@ void MainWindow::startVideoGrabber() {
                         cv::Mat rgb_lane_result =
                             cv::Mat::zeros(draw_frame.size(), CV_8UC3);
 
-                        rgb_lane_result.setTo(Scalar(255, 255, 255), lane_line_mask_copy > 0.5);
-                        draw_frame.setTo(Scalar(0, 0, 0), lane_line_mask_copy > 0.5);
+                        rgb_lane_result.setTo(Scalar(255, 255, 255), lane_line_mask_copy > 127);
+                        draw_frame.setTo(Scalar(0, 0, 0), lane_line_mask_copy > 127);
                         
                         cv::imwrite(std::to_string(frame_ids) + "-lanemask.png", rgb_lane_result);
 
@@ -402,12 +392,12 @@ void MainWindow::startVideoGrabber() {
 
             #ifdef DEBUG_SHOW_FPS
 
-                if (Timer::calcTimePassed(last_fps_show) > 1000) {
+                if (Timer::calcWallTimePassed(last_fps_show) > 1000) {
                     object_detection_time =
                         car_status->getObjectDetectionTime();
                     lane_detection_time =
                         car_status->getLaneDetectionTime();
-                    last_fps_show = Timer::getCurrentTime();
+                    last_fps_show = Timer::getWallTime();
                 }
 
                 cv::putText(draw_frame, "Object detection: " +  std::to_string(object_detection_time) + " ms", Point2f(10,10), FONT_HERSHEY_PLAIN, 0.8,  Scalar(0,0,255,255), 1.5);
@@ -419,13 +409,29 @@ void MainWindow::startVideoGrabber() {
             #endif
             
 
+            std::shared_ptr<ObjectDetector> object_detector = model_loader->getObjectDetector();
             std::vector<TrafficObject> detected_objects = car_status->getDetectedObjects();
 
-            if (!detected_objects.empty()) {
+            if (object_detector && !detected_objects.empty()) {
                 object_detector->drawDetections(
                     detected_objects, draw_frame);
             }
 
+            // Features whose model is still loading
+            std::string warming_up;
+            if (!object_detector) {
+                warming_up += " object detection";
+            }
+            #ifndef DISABLE_LANE_DETECTOR
+            if (!model_loader->getLaneDetector()) {
+                warming_up += " lane detection";
+            }
+            #endif
+            if (!warming_up.empty()) {
+                cv::putText(draw_frame, "Warming up:" + warming_up, Point2f(10, draw_frame.rows - 10),
+                    FONT_HERSHEY_PLAIN, 1.2, Scalar(0, 255, 255), 1);
+            }
+
             // Show speed sign
             MaxSpeedLimit speed_limit = getSpeedLimit();
             if (speed_limit.speed_limit > 0) {
@@ -29,11 +29,14 @@
 
 #include "perception/lane_detection/lane_detector.h"
 #include "perception/object_detection/object_detector.h"
+#include "pipeline/model_loader.h"
+#include "pipeline/object_detection_pipeline.h"
 
 #include "sensors/car_gps_reader.h"
 #include "sensors/car_status.h"
 #include "sensors/speed_limit.h"
 #include "sensors/can_reader.h"
+#include "sensors/frame_sources/frame_source.h"
 
 #include "ui/input_source.h"
 #include "simulation/simulation.h"
@@ -56,7 +59,7 @@ class MainWindow : public QMainWindow {
     Q_OBJECT
 
    public:
-    explicit MainWindow(QWidget *parent = 0, bool is_simulation_mode=false);
+    explicit MainWindow(QWidget *parent = 0, bool is_simulation_mode=false, std::string camera_source="0");
     ~MainWindow();
     void startVideoGrabber();
     void refreshCams();
@@ -86,13 +89,16 @@ class MainWindow : public QMainWindow {
 
     QGraphicsPixmapItem pixmap;
 
-    // Processors
-    std::shared_ptr<ObjectDetector> object_detector;
-    std::shared_ptr<LaneDetector> lane_detector;
+    // Processors. The models are loaded in the background:
+    // get them from model_loader
+    std::shared_ptr<ModelLoader> model_loader;
     std::shared_ptr<CarGPSReader> car_gps_reader;
     std::shared_ptr<CollisionWarningController> collision_warning;
     std::shared_ptr<CANReader> can_reader;
 
+    // Declared after the processors it uses, so that it is stopped first
+    std::shared_ptr<ObjectDetectionPipeline> object_detection_pipeline;
+
 
     MaxSpeedLimit speed_limit;
     std::mutex speed_limit_mutex;
@@ -121,12 +127,9 @@ class MainWindow : public QMainWindow {
 
    private:
 
-    static void cameraCaptureThread(std::shared_ptr<CarStatus>);
-    static void objectDetectionThread(
-        std::shared_ptr<ObjectDetector> object_detector, std::shared_ptr<CarStatus> ,
-        CollisionWarningController *collision_warning);
+    static void cameraCaptureThread(std::shared_ptr<FrameSource>, std::shared_ptr<CarStatus>);
     static void laneDetectionThread(
-        std::shared_ptr<LaneDetector> lane_detector, std::shared_ptr<CarStatus>, MainWindow *);
+        std::shared_ptr<ModelLoader> model_loader, std::shared_ptr<CarStatus>, MainWindow *);
     static void carPropReaderThread(
         std::shared_ptr<CarGPSReader> car_gps_reader,
         std::shared_ptr<CANReader> can_reader,
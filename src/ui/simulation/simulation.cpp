@@ -1,6 +1,7 @@
 #include "simulation.h"
 #include "configs/config.h"
 #include "ui_simulation.h"
+#include "sensors/frame_sources/raw_frame_source.h"
 
 using namespace std;
 using namespace cv;
@@ -77,126 +78,13 @@ void Simulation::shutdown() {
 
 int Simulation::readSimulationData(std::string video_path, std::string data_file_path, SimulationData &sim_data) {
 
-    sim_data = SimulationData();
-
-    cout << video_path << endl;
-
-    // Open video
-    if (!sim_data.capture.open(video_path)) {
+    if (::readSimulationData(video_path, data_file_path, sim_data, camera_model) != 0) {
         QMessageBox::critical(
             NULL, "Video path",
             "Could not open video file");
         return 1;
     }
 
-    // Get FPS
-    float fps = sim_data.capture.get(cv::CAP_PROP_FPS);
-    int n_frames = sim_data.capture.get(cv::CAP_PROP_FRAME_COUNT);
-    cout << "Number of video frames: " << n_frames << endl;
-
-    // Read data file
-    std::ifstream data_file(data_file_path);
-
-    std::string line;
-    while (std::getline(data_file, line)) {
-
-        if (line == "VideoProps") { // Video props
-            std::string line;
-            while (std::getline(data_file, line)) {
-                if (line != "---") { // End of this block
-                    std::string prop_name;
-                    std::string prop_value;
-                    std::istringstream iss(line);
-                    iss >> prop_name >> prop_value;
-                    if (prop_name == "playing_speed") {
-                        sim_data.playing_fps = std::stof(prop_value);
-                    } else if (prop_name == "begin_frame") {
-                        sim_data.begin_frame = std::stoi(prop_value);
-                    } else if (prop_name == "end_frame") {
-                        sim_data.end_frame = std::stoi(prop_value);
-                    }
-                } else {
-                    break;
-                }
-            } 
-        } else if (line == "CarSpeed") {
-
-            // Skip the first line
-            std::getline(data_file, line);
-
-            if (sim_data.begin_frame < 0) {
-                sim_data.begin_frame = 0;
-            }
-            if (sim_data.end_frame < 0) {
-                sim_data.end_frame = n_frames - 1;
-            }
-            if (sim_data.playing_fps < 0) {
-                sim_data.playing_fps = fps;
-            }
-
-            sim_data.sim_frames.reserve(sim_data.end_frame + 1);
-
-            std::string line;
-            while (std::getline(data_file, line)) {
-                if (line != "---") { // End of this block
-                    int begin_frame;
-                    int end_frame;
-                    float speed;
-                    int turning_left, turning_right;
-                    std::istringstream iss(line);
-                    iss >> begin_frame >> end_frame >> speed >> turning_left >> turning_right;
-                    sim_data.sim_frames.push_back(
-                        SimFrameData(begin_frame, end_frame, speed, turning_left, turning_right));
-
-                    assert(begin_frame <= end_frame);
-
-                    for (size_t i = begin_frame; i <= end_frame; ++i) {
-                        sim_data.sim_frames[i].car_speed = speed;
-                        sim_data.sim_frames[i].turning_left = turning_left;
-                        sim_data.sim_frames[i].turning_right = turning_right;
-                    }
-                    
-                } else {
-                    break;
-                }
-            }
-        } else if (line == "CameraCalibration") {
-
-            float car_width; float carpet_width; 
-            float car_to_carpet_distance; float carpet_length;
-            float tl_x; float tl_y;
-            float tr_x; float tr_y;
-            float br_x; float br_y;
-            float bl_x; float bl_y;
-
-            std::string line;
-            data_file >> line >> car_width;
-            data_file >> line >> carpet_width;
-            data_file >> line >> car_to_carpet_distance;
-            data_file >> line >> carpet_length;
-            data_file >> line >> tl_x >> line >> tl_y;
-            data_file >> line >> tr_x >> line >> tr_y;
-            data_file >> line >> br_x >> line >> br_y;
-            data_file >> line >> bl_x >> line >> bl_y;
-
-            camera_model->updateCameraModel(
-                car_width, carpet_width, car_to_carpet_distance, carpet_length,
-                tl_x, tl_y, tr_x, tr_y, br_x, br_y, bl_x, bl_y);
-
-        }
-
-        if (sim_data.begin_frame < 0) {
-            sim_data.begin_frame = 0;
-        }
-        if (sim_data.end_frame < 0) {
-            sim_data.end_frame = n_frames - 1;
-        }
-        if (sim_data.playing_fps < 0) {
-            sim_data.playing_fps = fps;
-        }
-
-    }
-
     return 0;
 
 } 
@@ -217,44 +105,70 @@ void Simulation::playingThread(Simulation * this_ptr) {
         return;
     }
 
-    cv::Mat frame;
     size_t current_frame_id = 0;
 
     // Set begin frame
     if (sim_data.begin_frame != 0) {
         current_frame_id = sim_data.begin_frame;
-        sim_data.capture.set(cv::CAP_PROP_POS_FRAMES, sim_data.begin_frame);
+        sim_data.source->seek(sim_data.begin_frame);
     }
 
     // Reset car status
     this_ptr->car_status->reset();
 
+    // Time based decisions follow the video, not the replay speed
+    ReplayClock replay_clock(sim_data.playing_fps);
+
+    bool lockstep = this_ptr->isLockstepReplay();
+    this_ptr->car_status->setLockstepReplay(lockstep);
+    Timer::time_point_t replay_begin_time = Timer::getWallTime();
+    size_t n_replayed_frames = 0;
+
     while (this_ptr->isPlaying()) {
         
         if (current_frame_id > sim_data.end_frame) {
             break;
         }
 
-        this_ptr->setCarStatus(sim_data.sim_frames[current_frame_id].car_speed,
-                sim_data.sim_frames[current_frame_id].turning_left,
-                sim_data.sim_frames[current_frame_id].turning_right
-            );
-        
         this_ptr->playing_thread_running = true;
-        sim_data.capture >> frame;
 
-        // If the frame is empty, break immediately
-        if (frame.empty())
+        // Read into a new buffer each time, as the published frame
+        // keeps referencing this one
+        cv::Mat frame;
+
+        // If no frame can be read, break immediately
+        if (!sim_data.source->read(frame))
             break;
 
-        this_ptr->car_status->setCurrentImage(frame);
+        replay_clock.setFrameTimestamp(sim_data.source->getTimestamp());
 
-        std::this_thread::sleep_for(std::chrono::microseconds(int(1.0 / sim_data.playing_fps * 1e6)));
+        if (current_frame_id < sim_data.sim_frames.size()) {
+            this_ptr->setCarStatus(sim_data.sim_frames[current_frame_id].car_speed,
+                    sim_data.sim_frames[current_frame_id].turning_left,
+                    sim_data.sim_frames[current_frame_id].turning_right
+                );
+        }
+        FramePtr published_frame = this_ptr->car_status->setCurrentImage(frame);
+
+        if (lockstep) {
+            // Publish the next frame as soon as all perception threads
+            // are done with this one. Never sleep
+            while (this_ptr->isPlaying() &&
+                !this_ptr->car_status->waitForFrameConsumers(published_frame->frame_id, LOCKSTEP_REPLAY_MAX_WAIT));
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(int(1.0 / sim_data.playing_fps * 1e6)));
+        }
 
         ++current_frame_id;
+        ++n_replayed_frames;
     }
 
-    sim_data.capture.release();
+    Timer::time_duration_t replay_time = Timer::calcWallTimePassed(replay_begin_time);
+    cout << "Replayed " << n_replayed_frames << " frames in " << replay_time << " ms ("
+         << n_replayed_frames * 1000.0 / std::max<Timer::time_duration_t>(replay_time, 1) << " FPS)" << endl;
+
+    this_ptr->car_status->setLockstepReplay(false);
+    sim_data.source->close();
     this_ptr->playing_thread_running = false;
 
 }
@@ -264,7 +178,7 @@ void Simulation::selectVideoBtnClicked() {
     stopPlaying();
 
     QString video_file = QFileDialog::getOpenFileName(this,
-    tr("Open Video File"), "", tr("Video Files (*.avi *.mp4 *.mov)"));
+    tr("Open Video File"), "", tr("Video Files (*.avi *.mp4 *.mov *" RAW_FRAME_FILE_EXTENSION ")"));
 
     setVideoPath(video_file.toUtf8().constData());
 
@@ -367,6 +281,14 @@ std::string Simulation::getDataFilePath() {
 }
 
 
+void Simulation::setLockstepReplay(bool lockstep) {
+    lockstep_replay = lockstep;
+}
+
+bool Simulation::isLockstepReplay() {
+    return lockstep_replay;
+}
+
 bool Simulation::isPlaying() {
     return is_playing;
 }
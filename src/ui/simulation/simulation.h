@@ -48,6 +48,7 @@ class Simulation : public QWidget, private Ui::Simulation {
     std::atomic<float> car_speed = {0.0};
     std::atomic<bool> is_playing = {false};
     std::atomic<bool> playing_thread_running = {false};
+    std::atomic<bool> lockstep_replay = {false};
     std::mutex path_mutex;
     std::string video_path;
     std::string data_file_path;
@@ -68,6 +69,12 @@ class Simulation : public QWidget, private Ui::Simulation {
     void setCarSpeed(float);
     void setCarStatus(float speed, bool turning_left, bool turning_right);
 
+    // Lockstep replay: publish a frame only after all perception threads
+    // have processed the previous one, without sleeping between frames.
+    // Otherwise frames are played at the frame rate of the video
+    void setLockstepReplay(bool lockstep);
+    bool isLockstepReplay();
+
    private slots:
     void selectVideoBtnClicked();
     void selectDataFileBtnClicked();
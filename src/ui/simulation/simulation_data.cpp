@@ -0,0 +1,167 @@
+#include "simulation_data.h"
+
+#include <assert.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "perception/camera_model/camera_model.h"
+
+using namespace std;
+
+int readSimulationData(const std::string &video_path, const std::string &data_file_path,
+    SimulationData &sim_data, std::shared_ptr<CameraModel> camera_model) {
+
+    sim_data = SimulationData();
+
+    cout << video_path << endl;
+
+    // Open video (or any other frame source)
+    sim_data.source = createFrameSource(video_path);
+    if (!sim_data.source->open()) {
+        cerr << "Could not open video file: " << video_path << endl;
+        return 1;
+    }
+
+    // Get FPS
+    float fps = sim_data.source->getFPS();
+    int n_frames = sim_data.source->getFrameCount();
+    cout << "Number of video frames: " << n_frames << endl;
+
+    // Read data file
+    std::ifstream data_file(data_file_path);
+
+    std::string line;
+    while (std::getline(data_file, line)) {
+
+        if (line == "VideoProps") { // Video props
+            std::string line;
+            while (std::getline(data_file, line)) {
+                if (line != "---") { // End of this block
+                    std::string prop_name;
+                    std::string prop_value;
+                    std::istringstream iss(line);
+                    iss >> prop_name >> prop_value;
+                    if (prop_name == "playing_speed") {
+                        sim_data.playing_fps = std::stof(prop_value);
+                    } else if (prop_name == "begin_frame") {
+                        sim_data.begin_frame = std::stoi(prop_value);
+                    } else if (prop_name == "end_frame") {
+                        sim_data.end_frame = std::stoi(prop_value);
+                    }
+                } else {
+                    break;
+                }
+            } 
+        } else if (line == "CarSpeed") {
+
+            // Skip the first line
+            std::getline(data_file, line);
+
+            if (sim_data.begin_frame < 0) {
+                sim_data.begin_frame = 0;
+            }
+            if (sim_data.end_frame < 0) {
+                sim_data.end_frame = n_frames - 1;
+            }
+            if (sim_data.playing_fps < 0) {
+                sim_data.playing_fps = fps;
+            }
+
+            // One entry per frame, so that frames can be looked up by id
+            sim_data.sim_frames.reserve(sim_data.end_frame + 1);
+            for (int i = 0; i <= sim_data.end_frame; ++i) {
+                sim_data.sim_frames.push_back(SimFrameData(i, i, 0, false, false));
+            }
+
+            std::string line;
+            while (std::getline(data_file, line)) {
+                if (line != "---") { // End of this block
+                    int begin_frame;
+                    int end_frame;
+                    float speed;
+                    int turning_left, turning_right;
+                    std::istringstream iss(line);
+                    iss >> begin_frame >> end_frame >> speed >> turning_left >> turning_right;
+
+                    assert(begin_frame <= end_frame);
+                    while (sim_data.sim_frames.size() <= end_frame) {
+                        sim_data.sim_frames.push_back(
+                            SimFrameData(sim_data.sim_frames.size(), sim_data.sim_frames.size(), 0, false, false));
+                    }
+
+                    for (size_t i = begin_frame; i <= end_frame; ++i) {
+                        sim_data.sim_frames[i].car_speed = speed;
+                        sim_data.sim_frames[i].turning_left = turning_left;
+                        sim_data.sim_frames[i].turning_right = turning_right;
+                    }
+                    
+                } else {
+                    break;
+                }
+            }
+        } else if (line == "CameraCalibration") {
+
+            float car_width; float carpet_width; 
+            float car_to_carpet_distance; float carpet_length;
+            float tl_x; float tl_y;
+            float tr_x; float tr_y;
+            float br_x; float br_y;
+            float bl_x; float bl_y;
+
+            std::string line;
+            data_file >> line >> car_width;
+            data_file >> line >> carpet_width;
+            data_file >> line >> car_to_carpet_distance;
+            data_file >> line >> carpet_length;
+            data_file >> line >> tl_x >> line >> tl_y;
+            data_file >> line >> tr_x >> line >> tr_y;
+            data_file >> line >> br_x >> line >> br_y;
+            data_file >> line >> bl_x >> line >> bl_y;
+
+            camera_model->updateCameraModel(
+                car_width, carpet_width, car_to_carpet_distance, carpet_length,
+                tl_x, tl_y, tr_x, tr_y, br_x, br_y, bl_x, bl_y);
+
+        }
+
+        if (sim_data.begin_frame < 0) {
+            sim_data.begin_frame = 0;
+        }
+        if (sim_data.end_frame < 0) {
+            sim_data.end_frame = n_frames - 1;
+        }
+        if (sim_data.playing_fps < 0) {
+            sim_data.playing_fps = fps;
+        }
+
+    }
+
+    return 0;
+
+}
+
+
+ReplayClock::ReplayClock(double fps) : fps(fps) {
+    start_time = Timer::getWallTime();
+    Timer::useVirtualClock(start_time);
+}
+
+ReplayClock::~ReplayClock() {
+    Timer::useSystemClock();
+}
+
+void ReplayClock::setFrameTimestamp(double timestamp) {
+    if (first_timestamp < 0) {
+        first_timestamp = timestamp;
+        last_timestamp = timestamp;
+    } else if (timestamp <= last_timestamp && fps > 0) {
+        // Some backends don't report timestamps
+        timestamp = last_timestamp + 1000.0 / fps;
+    }
+    last_timestamp = std::max(timestamp, last_timestamp);
+
+    std::chrono::microseconds offset(static_cast<long long>((last_timestamp - first_timestamp) * 1000));
+    Timer::setVirtualTime(start_time + std::chrono::duration_cast<Timer::time_point_t::duration>(offset));
+}
@@ -3,8 +3,13 @@
 
 #include <vector>
 #include <atomic>
+#include <memory>
+#include <string>
 #include <opencv2/opencv.hpp>
 
+#include "sensors/frame_sources/frame_source.h"
+#include "utils/timer.h"
+
 struct SimFrameData {
     int begin_frame;
     int end_frame;
@@ -21,10 +26,40 @@ struct SimulationData {
     int begin_frame = -1;
     int end_frame = -1;
 
-    cv::VideoCapture capture;
+    std::shared_ptr<FrameSource> source;
     std::vector<SimFrameData> sim_frames;
 
 };
 
+// Drive the virtual clock (see Timer::useVirtualClock()) by the
+// timestamps of replayed frames, so that time based warnings behave
+// the same at any replay speed. The clock follows the newest published
+// frame: see Timer::useVirtualClock() for when it is exact.
+// The system clock is restored when this object is destroyed
+class ReplayClock {
+   private:
+    Timer::time_point_t start_time;
+    double fps;
+    double first_timestamp = -1;
+    double last_timestamp = -1;
+
+   public:
+    // fps is used when the source has no usable timestamps
+    explicit ReplayClock(double fps);
+    ~ReplayClock();
+
+    // Move the clock to a frame (timestamp in ms, from FrameSource::getTimestamp()).
+    // Call before publishing the frame
+    void setFrameTimestamp(double timestamp);
+};
+
+class CameraModel;
+
+// Open the frame source of a simulation and read its data file
+// (video props, car speed per frame, camera calibration).
+// The camera model is updated if the data file has a calibration block.
+// Return 0 on success, 1 if the frame source could not be opened
+int readSimulationData(const std::string &video_path, const std::string &data_file_path,
+    SimulationData &sim_data, std::shared_ptr<CameraModel> camera_model);
 
 #endif
\ No newline at end of file
@@ -48,28 +48,28 @@ std::string TrafficSignMonitor::getLargestSign(const std::vector<TrafficObject>
 
 // Update traffic sign
 // Passing sign name if a traffic sign was found
-void TrafficSignMonitor::updateTrafficSign(const std::vector<TrafficObject> &traffic_objects) {
+void TrafficSignMonitor::updateTrafficSign(const std::vector<TrafficObject> &traffic_objects, Timer::time_point_t time) {
 
     std::string sign_type = getLargestSign(traffic_objects);
 
     // Traffic sign -> No traffic sign
     if (sign_existing && sign_type == "") {
-        last_no_traffic_sign_time = Timer::getCurrentTime();
+        last_no_traffic_sign_time = time;
         sign_existing = false;
 
     // No traffic sign -> Traffic sign
     } else if (!sign_existing && sign_type != "") {
-        last_traffic_sign_time = Timer::getCurrentTime();
+        last_traffic_sign_time = time;
         last_traffic_sign = sign_type;
         sign_existing = true;
     
     } else if (sign_existing) {
 
         if (sign_type != last_traffic_sign) {
-            last_traffic_sign_time = Timer::getCurrentTime();
+            last_traffic_sign_time = time;
             last_traffic_sign = sign_type;
         } else {
-            Timer::time_duration_t traffic_sign_time = Timer::calcTimePassed(last_traffic_sign_time);
+            Timer::time_duration_t traffic_sign_time = Timer::calcDiff(last_traffic_sign_time, time);
             if (traffic_sign_time > 200 && traffic_sign_time < 10000) {    
                 // cout << sign_type << endl;     
                 triggerSignStatus(sign_type);
@@ -78,7 +78,7 @@ void TrafficSignMonitor::updateTrafficSign(const std::vector<TrafficObject> &tra
 
     } else {
 
-        Timer::time_duration_t no_traffic_sign_time =  Timer::calcTimePassed(last_no_traffic_sign_time);
+        Timer::time_duration_t no_traffic_sign_time =  Timer::calcDiff(last_no_traffic_sign_time, time);
         if (no_traffic_sign_time > 1000 && no_traffic_sign_time < 10000) {
             last_traffic_sign = "";
             sign_existing = false;
@@ -26,8 +26,9 @@ class TrafficSignMonitor {
     std::string getLargestSign(const std::vector<TrafficObject> &traffic_objects);
 
     // Update traffic sign
-    // Passing sign name if a traffic sign was found
-    void updateTrafficSign(const std::vector<TrafficObject> &traffic_objects);
+    // Passing sign name if a traffic sign was found.
+    // time: capture time of the frame of traffic_objects
+    void updateTrafficSign(const std::vector<TrafficObject> &traffic_objects, Timer::time_point_t time);
 
     void triggerSignStatus(std::string sign_type);
 
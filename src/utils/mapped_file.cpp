@@ -0,0 +1,68 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <iostream>
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string &file_path) {
+    close();
+
+    int fd = ::open(file_path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Could not open file: " << file_path << std::endl;
+        return false;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0 || file_stat.st_size == 0) {
+        std::cerr << "Could not read file size: " << file_path << std::endl;
+        ::close(fd);
+        return false;
+    }
+
+    void *mapped = mmap(nullptr, file_stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    // The mapping stays valid after closing the file descriptor
+    ::close(fd);
+
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Could not map file: " << file_path << std::endl;
+        return false;
+    }
+
+    data = mapped;
+    size = file_stat.st_size;
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        munmap(data, size);
+        data = nullptr;
+        size = 0;
+    }
+}
+
+bool MappedFile::isOpened() const {
+    return data != nullptr;
+}
+
+const char *MappedFile::getData() const {
+    return static_cast<const char *>(data);
+}
+
+size_t MappedFile::getSize() const {
+    return size;
+}
+
+void MappedFile::adviseSequential() {
+    if (data != nullptr) {
+        madvise(data, size, MADV_SEQUENTIAL);
+    }
+}
@@ -0,0 +1,34 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <string>
+
+// Read-only memory mapping of a whole file.
+// The content is paged in by the kernel on access instead of being
+// copied into a heap buffer.
+class MappedFile {
+   private:
+    void *data = nullptr;
+    size_t size = 0;
+
+   public:
+    MappedFile() {}
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // Map a file. Return false on failure
+    bool open(const std::string &file_path);
+    void close();
+    bool isOpened() const;
+
+    const char *getData() const;
+    size_t getSize() const;
+
+    // Tell the kernel the file will be read sequentially
+    void adviseSequential();
+};
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef TEST_UTILS_H
+#define TEST_UTILS_H
+
+#include <iostream>
+#include <string>
+
+// Helpers of the test executables (test_*.cpp)
+
+// Print message on failure. Return condition, to be accumulated:
+// ok &= check(condition, "what is checked");
+inline bool check(bool condition, const std::string &message) {
+    if (!condition) {
+        std::cerr << "FAILED: " << message << std::endl;
+    }
+    return condition;
+}
+
+// Print the result of all tests. Return the exit code of the test
+inline int reportTestResult(bool ok) {
+    std::cout << (ok ? "All tests passed" : "Some tests failed") << std::endl;
+    return ok ? 0 : 1;
+}
+
+#endif
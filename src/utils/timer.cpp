@@ -1,14 +1,45 @@
 #include "timer.h"
 #include <iostream> 
 
+std::atomic<bool> Timer::virtual_clock_enabled = {false};
+std::atomic<Timer::time_point_t::rep> Timer::virtual_time = {0};
+
 Timer::Timer() {
     start_time_point = getCurrentTime();
 }
 
 Timer::time_point_t Timer::getCurrentTime() {
+    if (virtual_clock_enabled) {
+        return time_point_t(time_point_t::duration(virtual_time.load()));
+    }
+    return std::chrono::system_clock::now();
+}
+
+void Timer::useVirtualClock(time_point_t start_time) {
+    setVirtualTime(start_time);
+    virtual_clock_enabled = true;
+}
+
+void Timer::setVirtualTime(time_point_t time_point) {
+    virtual_time = time_point.time_since_epoch().count();
+}
+
+void Timer::useSystemClock() {
+    virtual_clock_enabled = false;
+}
+
+bool Timer::isVirtualClock() {
+    return virtual_clock_enabled;
+}
+
+Timer::time_point_t Timer::getWallTime() {
     return std::chrono::system_clock::now();
 }
 
+Timer::time_duration_t Timer::calcWallTimePassed(time_point_t time_point) {
+    return calcDiff(time_point, getWallTime());
+}
+
 // Calculate the duration between 2 time point
 // return value as time_duration_t (miliseconds)
 Timer::time_duration_t Timer::calcDiff(time_point_t begin, time_point_t end) {
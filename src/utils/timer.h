@@ -1,6 +1,7 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include <atomic>
 #include <chrono>
 #include <thread>
 
@@ -16,8 +17,30 @@ class Timer {
 
     Timer();
     
+    // Current time of the clock used by time based decisions (warnings,
+    // traffic sign timing...). This is the system clock, unless a virtual
+    // clock is enabled
     static time_point_t getCurrentTime();
 
+    // Virtual clock: during replay, time is driven by frame timestamps
+    // instead of the system clock, so that warnings don't depend on the
+    // replay speed. setVirtualTime() is called before publishing each frame.
+    // The clock is process-global: it is the time of the newest published
+    // frame. It is exact for every consumer in lockstep replay only. When
+    // frames are read faster than they are processed, a consumer may still
+    // work on an older frame: decisions about the content of a frame
+    // (lane departure, traffic signs, turning signal window) use
+    // Frame::capture_time instead
+    static void useVirtualClock(time_point_t start_time);
+    static void setVirtualTime(time_point_t time_point);
+    static void useSystemClock();
+    static bool isVirtualClock();
+
+    // Always the system clock. Use for measuring processing time,
+    // frame rates and pacing
+    static time_point_t getWallTime();
+    static time_duration_t calcWallTimePassed(time_point_t time_point);
+
     // Calculate the duration between 2 time point
     // return value as time_duration_t (miliseconds)
     static time_duration_t calcDiff(time_point_t begin, time_point_t end);
@@ -28,6 +51,10 @@ class Timer {
     // Delay a duration
     static void delay(time_duration_t duration);
 
+    private:
+    static std::atomic<bool> virtual_clock_enabled;
+    static std::atomic<time_point_t::rep> virtual_time;
+
 
 };
 
@@ -0,0 +1,106 @@
+"""Export the models used by the CPU inference backend (OpenCV DNN).
+
+ctdet: CenterNet (PyTorch .pth) to ONNX, with outputs named hm, reg, wh,
+       in the order of SMARTCAM_OBJECT_DETECTION_CPU_OUTPUTS. Run it from
+       the root of the CenterNet source code (src/lib in the python path).
+       OpenCV DNN can not run the DCNv2 layers of the TensorRT model: use a
+       model trained without them (e.g. --arch res_18).
+keras: Keras model (.h5) of the lane line segmentation or the traffic sign
+       classification to a frozen TensorFlow graph (.pb). The output node
+       must match LANE_DETECTION_OUTPUT_NODE or
+       SIGN_CLASSIFICATION_OUTPUT_NODE.
+
+Examples:
+    python export_cpu_models.py ctdet --arch res_18 --num_classes 10 \\
+        --checkpoint model_best.pth \\
+        --output models/object_detection/ctdet_bdd_resnet18_384_cpu.onnx
+    python export_cpu_models.py keras --model lane_segmentation_384x384.h5 \\
+        --output models/lane_detection/lane_segmentation_384x384.pb
+    python export_cpu_models.py keras --model traffic_sign_classification_resnet18_64.h5 \\
+        --output models/traffic_sign/traffic_sign_classification_resnet18_64.pb
+"""
+from __future__ import print_function
+import argparse
+import os
+
+CTDET_OUTPUTS = ['hm', 'reg', 'wh']
+
+
+def export_ctdet(args):
+    from collections import OrderedDict
+    import torch
+    from models.model import create_model, load_model
+
+    if 'dcn' in args.arch:
+        raise SystemExit('DCNv2 is not supported by OpenCV DNN: ' + args.arch)
+
+    heads = OrderedDict([('hm', args.num_classes), ('reg', 2), ('wh', 2)])
+    head_conv = 256 if 'dla' in args.arch else 64
+    model = load_model(create_model(args.arch, heads, head_conv), args.checkpoint)
+    model.eval()
+
+    class Heads(torch.nn.Module):
+        # ONNX does not support dict outputs: heads of the last stack, in
+        # the order of CTDET_OUTPUTS
+        def __init__(self, model):
+            super(Heads, self).__init__()
+            self.model = model
+
+        def forward(self, x):
+            output = self.model(x)[-1]
+            return tuple(output[name] for name in CTDET_OUTPUTS)
+
+    dummy_input = torch.zeros([1, 3, args.input_size, args.input_size])
+    torch.onnx.export(Heads(model), dummy_input, args.output, opset_version=11,
+                      input_names=['input'], output_names=CTDET_OUTPUTS)
+
+
+def export_keras(args):
+    import tensorflow as tf
+    tf.compat.v1.disable_eager_execution()
+    tf.keras.backend.set_learning_phase(0)
+    model = tf.keras.models.load_model(args.model, compile=False)
+    session = tf.compat.v1.keras.backend.get_session()
+    output_names = [output.op.name for output in model.outputs]
+    graph_def = tf.compat.v1.graph_util.convert_variables_to_constants(
+        session, session.graph.as_graph_def(), output_names)
+    graph_def = tf.compat.v1.graph_util.remove_training_nodes(graph_def)
+    tf.io.write_graph(graph_def, os.path.dirname(os.path.abspath(args.output)),
+                      os.path.basename(args.output), as_text=False)
+    print('Outputs:', ', '.join(output_names))
+
+
+def check(args):
+    # Load the exported model as OpenCVDnnBackend does
+    import cv2
+    import numpy as np
+    net = cv2.dnn.readNet(args.output)
+    names = CTDET_OUTPUTS if args.command == 'ctdet' else net.getUnconnectedOutLayersNames()
+    size = args.input_size
+    net.setInput(np.zeros([1, 3, size, size], dtype=np.float32))
+    for name, output in zip(names, net.forward(names)):
+        print(name, output.shape)
+
+
+parser = argparse.ArgumentParser(description='Export models for the CPU inference backend')
+subparsers = parser.add_subparsers(dest='command')
+ctdet_parser = subparsers.add_parser('ctdet', help='CenterNet (.pth) to ONNX')
+ctdet_parser.add_argument('--arch', default='res_18', help='CenterNet architecture, without DCN')
+ctdet_parser.add_argument('--checkpoint', required=True, help='Path to .pth model')
+ctdet_parser.add_argument('--num_classes', type=int, default=10)
+ctdet_parser.add_argument('--input_size', type=int, default=384)
+ctdet_parser.add_argument('--output', required=True, help='Path to .onnx model')
+keras_parser = subparsers.add_parser('keras', help='Keras (.h5) to frozen TensorFlow graph')
+keras_parser.add_argument('--model', required=True, help='Path to .h5 model')
+keras_parser.add_argument('--input_size', type=int, default=384, help='Input size to check the export with')
+keras_parser.add_argument('--output', required=True, help='Path to .pb model')
+args = parser.parse_args()
+
+if args.command == 'ctdet':
+    export_ctdet(args)
+elif args.command == 'keras':
+    export_keras(args)
+else:
+    parser.print_help()
+    raise SystemExit(1)
+check(args)